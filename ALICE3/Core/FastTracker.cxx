@@ -18,6 +18,7 @@
 #include "TMatrixDSymEigen.h"
 #include "TRandom.h"
 
+#include <cmath>
 #include <string>
 #include <vector>
 
@@ -282,6 +283,38 @@ float FastTracker::ProbGoodChiSqHit(float radius, float searchRadiusRPhi, float
   return goodHit;
 }
 
+void FastTracker::UpdateLayerMaterial()
+{
+  layerMaterial.resize(layers.size());
+  for (size_t il = 0; il < layers.size(); il++) {
+    layerMaterial[il] = layers[il].getDensity() / mNElossStepsFastPath;
+  }
+}
+
+bool FastTracker::Cholesky5(const double cov[5][5], double lower[5][5])
+{
+  for (int i = 0; i < 5; i++) {
+    for (int j = 0; j <= i; j++) {
+      double sum = cov[i][j];
+      for (int k = 0; k < j; k++) {
+        sum -= lower[i][k] * lower[j][k];
+      }
+      if (i == j) {
+        if (sum < 0.) {
+          return false; // not positive semi-definite
+        }
+        lower[i][i] = std::sqrt(sum);
+      } else {
+        lower[i][j] = lower[j][j] > 0. ? sum / lower[j][j] : 0.;
+      }
+    }
+    for (int j = i + 1; j < 5; j++) {
+      lower[i][j] = 0.;
+    }
+  }
+  return true;
+}
+
 // function to provide a reconstructed track from a perfect input track
 // returns number of intercepts (generic for now)
 int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackParCov& outputTrack, const float nch)
@@ -313,6 +346,11 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
   }
   const int xrhosteps = 100;
   const bool applyAngularCorrection = true;
+  if (mFastPath && layerMaterial.size() != layers.size()) {
+    UpdateLayerMaterial();
+  }
+  const int elossSteps = mFastPath ? mNElossStepsFastPath : xrhosteps;
+  auto elossStepXrho = [&](int il) { return mFastPath ? layerMaterial[il] : layers[il].getDensity() / xrhosteps; };
 
   goodHitProbability.clear();
   for (int i = 0; i < kMaxNumberOfDetectors; ++i) {
@@ -344,8 +382,8 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
       ok = inputTrack.correctForMaterial(layers[il].getRadiationLength(), 0, applyAngularCorrection);
     }
     if (ok && mApplyElossCorrection && layers[il].getDensity() > 0) { // correct in small steps
-      for (int ise = xrhosteps; ise--;) {
-        ok = inputTrack.correctForMaterial(0, -layers[il].getDensity() / xrhosteps, applyAngularCorrection);
+      for (int ise = elossSteps; ise--;) {
+        ok = inputTrack.correctForMaterial(0, -elossStepXrho(il), applyAngularCorrection);
         if (!ok)
           break;
       }
@@ -453,11 +491,11 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
       }
     }
     if (mApplyElossCorrection && layers[il].getDensity() > 0) {
-      for (int ise = xrhosteps; ise--;) { // correct in small steps
-        if (!inputTrack.correctForMaterial(0, layers[il].getDensity() / xrhosteps, applyAngularCorrection)) {
+      for (int ise = elossSteps; ise--;) { // correct in small steps
+        if (!inputTrack.correctForMaterial(0, elossStepXrho(il), applyAngularCorrection)) {
           return -7;
         }
-        if (!inwardTrack.correctForMaterial(0, layers[il].getDensity() / xrhosteps, applyAngularCorrection)) {
+        if (!inwardTrack.correctForMaterial(0, elossStepXrho(il), applyAngularCorrection)) {
           return -7;
         }
       }
@@ -504,7 +542,7 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
     eff *= iGoodHit;
   }
   if (mApplyEffCorrection) {
-    if (gRandom->Uniform() > eff)
+    if ((mFastPath ? mRandom.Uniform() : gRandom->Uniform()) > eff)
       return -8;
   }
 
@@ -515,7 +553,6 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
   std::array<float, o2::track::kCovMatSize> covMat = {0.};
   for (int ii = 0; ii < o2::track::kCovMatSize; ii++)
     covMat[ii] = outputTrack.getCov()[ii];
-  TMatrixDSym m(5);
   double fcovm[5][5]; // double precision is needed for regularisation
 
   for (int ii = 0, k = 0; ii < 5; ++ii) {
@@ -541,49 +578,76 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
     }
   }
 
-  // Should have a valid cov matrix now
-  m.SetMatrixArray(reinterpret_cast<double*>(fcovm));
-  TMatrixDSymEigen eigen(m);
-  TMatrixD eigVec = eigen.GetEigenVectors();
-  TVectorD eigVal = eigen.GetEigenValues();
-  bool negEigVal = false;
-  for (int ii = 0; ii < 5; ii++) {
-    if (eigVal[ii] < 0.0f)
-      negEigVal = true;
-  }
+  if (mFastPath) {
+    // smear as params + L * g, with L the Cholesky factor of the covariance matrix and g standard normal:
+    // same distribution as the smearing in the eigenbasis, without the eigen decomposition
+    double lower[5][5];
+    if (!Cholesky5(fcovm, lower)) {
+      if (mVerboseLevel > 0) {
+        LOG(info) << "WARNING: the covariance matrix (at pt = " << inputTrack.getPt() << ") is not positive semi-definite, Kalman updates: " << nIntercepts;
+      }
+      covMatNotOK++;
+      nIntercepts = -1; // mark as problematic so that it isn't used
+      return -1;
+    }
+    covMatOK++;
+    double gaus[5];
+    for (int ii = 0; ii < 5; ++ii) {
+      gaus[ii] = mRandom.Gaus();
+    }
+    for (int ii = 0; ii < 5; ++ii) {
+      double val = outputTrack.getParam(ii);
+      for (int j = 0; j <= ii; ++j) {
+        val += lower[ii][j] * gaus[j];
+      }
+      outputTrack.setParam(val, ii);
+    }
+  } else {
+    // Should have a valid cov matrix now
+    TMatrixDSym m(5);
+    m.SetMatrixArray(reinterpret_cast<double*>(fcovm));
+    TMatrixDSymEigen eigen(m);
+    TMatrixD eigVec = eigen.GetEigenVectors();
+    TVectorD eigVal = eigen.GetEigenValues();
+    bool negEigVal = false;
+    for (int ii = 0; ii < 5; ii++) {
+      if (eigVal[ii] < 0.0f)
+        negEigVal = true;
+    }
 
-  if (negEigVal && rubenConditional && makePositiveDefinite) {
-    if (mVerboseLevel > 0) {
-      LOG(info) << "WARNING: this diagonalization (at pt = " << inputTrack.getPt() << ") has negative eigenvalues despite Ruben's fix! Please be careful!";
-      LOG(info) << "Printing info:";
-      LOG(info) << "Kalman updates: " << nIntercepts;
-      LOG(info) << "Cov matrix: ";
-      m.Print();
+    if (negEigVal && rubenConditional && makePositiveDefinite) {
+      if (mVerboseLevel > 0) {
+        LOG(info) << "WARNING: this diagonalization (at pt = " << inputTrack.getPt() << ") has negative eigenvalues despite Ruben's fix! Please be careful!";
+        LOG(info) << "Printing info:";
+        LOG(info) << "Kalman updates: " << nIntercepts;
+        LOG(info) << "Cov matrix: ";
+        m.Print();
+      }
+      covMatNotOK++;
+      nIntercepts = -1; // mark as problematic so that it isn't used
+      return -1;
+    }
+    covMatOK++;
+
+    // transform parameter vector and smear
+    float params_[5];
+    for (int ii = 0; ii < 5; ++ii) {
+      float val = 0.;
+      for (int j = 0; j < 5; ++j)
+        val += eigVec[j][ii] * outputTrack.getParam(j);
+      // smear parameters according to eigenvalues
+      params_[ii] = gRandom->Gaus(val, sqrt(eigVal[ii]));
     }
-    covMatNotOK++;
-    nIntercepts = -1; // mark as problematic so that it isn't used
-    return -1;
-  }
-  covMatOK++;
-
-  // transform parameter vector and smear
-  float params_[5];
-  for (int ii = 0; ii < 5; ++ii) {
-    float val = 0.;
-    for (int j = 0; j < 5; ++j)
-      val += eigVec[j][ii] * outputTrack.getParam(j);
-    // smear parameters according to eigenvalues
-    params_[ii] = gRandom->Gaus(val, sqrt(eigVal[ii]));
-  }
 
-  // invert eigenvector matrix
-  eigVec.Invert();
-  // transform back params vector
-  for (int ii = 0; ii < 5; ++ii) {
-    float val = 0.;
-    for (int j = 0; j < 5; ++j)
-      val += eigVec[j][ii] * params_[j];
-    outputTrack.setParam(val, ii);
+    // invert eigenvector matrix
+    eigVec.Invert();
+    // transform back params vector
+    for (int ii = 0; ii < 5; ++ii) {
+      float val = 0.;
+      for (int j = 0; j < 5; ++j)
+        val += eigVec[j][ii] * params_[j];
+      outputTrack.setParam(val, ii);
+    }
   }
   // should make a sanity check that par[2] sin(phi) is in [-1, 1]
   if (fabs(outputTrack.getParam(2)) > 1.) {
@@ -18,6 +18,8 @@
 
 #include <fairlogger/Logger.h> // not a system header but megalinter thinks so
 
+#include <TRandom3.h>
+
 #include <string>
 #include <vector>
 
@@ -96,6 +98,15 @@ class FastTracker
   void SetApplyElossCorrection(bool b) { mApplyElossCorrection = b; }
   void SetApplyEffCorrection(bool b) { mApplyEffCorrection = b; }
 
+  // Fast path: cached per-layer material, Cholesky-based smearing and own random generator
+  void SetFastPath(bool b) { mFastPath = b; }
+  void SetNElossStepsFastPath(int n)
+  {
+    mNElossStepsFastPath = n;
+    layerMaterial.clear();
+  }
+  void SetSeed(UInt_t seed) { mRandom.SetSeed(seed); }
+
   // Getters for the last track
   int GetNIntercepts() const { return nIntercepts; }
   int GetNSiliconPoints() const { return nSiliconPoints; }
@@ -112,6 +123,11 @@ class FastTracker
   uint64_t GetCovMatNotOK() const { return covMatNotOK; }
 
  private:
+  void UpdateLayerMaterial();
+
+  /// Cholesky decomposition of a symmetric 5x5 matrix, returns false if it is not positive semi-definite
+  static bool Cholesky5(const double cov[5][5], double lower[5][5]);
+
   // Definition of detector layers
   std::vector<DetLayer> layers;
   std::vector<std::vector<float>> hits; // bookkeep last added hits
@@ -121,6 +137,8 @@ class FastTracker
   bool mApplyMSCorrection = true;       /// Apply correction for multiple scattering
   bool mApplyElossCorrection = true;    /// Apply correction for eloss (requires MS correction)
   bool mApplyEffCorrection = true;      /// Apply correction for hit efficiency
+  bool mFastPath = false;               /// Use the fast path (cached layer material, Cholesky smearing, own random generator)
+  int mNElossStepsFastPath = 10;        /// Number of energy loss steps per layer in the fast path
   int mVerboseLevel = 0;                /// 0: not verbose, >0 more verbose
   const float mCrossSectionMinB = 8;    /// Minimum bias Cross section for event under study (PbPb MinBias ~ 8 Barns)
   int dNdEtaCent = 2200;                /// dN/deta e.g. at centrality 0-5% (for 5 TeV PbPb)
@@ -147,7 +165,11 @@ class FastTracker
   int nGasPoints = 0;     /// tpc-based space points added to track
   std::vector<float> goodHitProbability;
 
-  ClassDef(FastTracker, 1);
+  /// fast path caches
+  std::vector<float> layerMaterial; //! x*rho of one energy loss step per layer, rebuilt when the layers change
+  TRandom3 mRandom;                 //! random generator of this tracker, used in the fast path
+
+  ClassDef(FastTracker, 2);
 };
 
 // +-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+
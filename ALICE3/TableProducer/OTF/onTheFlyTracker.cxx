@@ -143,6 +143,8 @@ struct OnTheFlyTracker {
     Configurable<bool> applyMSCorrection{"applyMSCorrection", true, "apply ms corrections for secondaries or not"};
     Configurable<bool> applyElossCorrection{"applyElossCorrection", true, "apply eloss corrections for secondaries or not"};
     Configurable<bool> applyEffCorrection{"applyEffCorrection", true, "apply efficiency correction or not"};
+    Configurable<bool> useFastPath{"useFastPath", false, "use the fast path: cached layer material, Cholesky smearing and own random generator (seeded with seed)"};
+    Configurable<int> nElossStepsFastPath{"nElossStepsFastPath", 10, "number of energy loss steps per layer in the fast path"};
     Configurable<std::vector<float>> pixelRes{"pixelRes", {0.00025, 0.00025, 0.001, 0.001}, "RPhiIT, ZIT, RPhiOT, ZOT"};
   } fastTrackerSettings; // allows for gap between peak and bg in case someone wants to
 
@@ -421,6 +423,9 @@ struct OnTheFlyTracker {
     fastTracker.SetApplyZacceptance(fastTrackerSettings.applyZacceptance);
     fastTracker.SetApplyMSCorrection(fastTrackerSettings.applyMSCorrection);
     fastTracker.SetApplyElossCorrection(fastTrackerSettings.applyElossCorrection);
+    fastTracker.SetFastPath(fastTrackerSettings.useFastPath);
+    fastTracker.SetNElossStepsFastPath(fastTrackerSettings.nElossStepsFastPath);
+    fastTracker.SetSeed(seed);
 
     if (fastTrackerSettings.alice3detector == 0) {
       fastTracker.AddSiliconALICE3v2(fastTrackerSettings.pixelRes);
@@ -0,0 +1,195 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file BcTimeline.h
+/// \brief Sorted flat per-DataFrame index of global BCs with detector activity
+///
+/// The timeline stores, for each slot (all BCs, or a selection of BCs defined by the consumer, e.g. TVX-fired BCs
+/// or BCs with an FV0 signal), the global BCs of the DataFrame and an associated row index (e.g. the BC or the FV0 row)
+/// in sorted flat arrays.
+/// It replaces the std::map<globalBC, index> bookkeeping of event selection and UD skimming with
+/// binary searches (lower/upper bound, exact and closest match, windows).
+///
+/// Usage: clear(), add() the entries in any order, build(), then query. Memory is kept between DataFrames.
+
+#ifndef COMMON_CORE_BCTIMELINE_H_
+#define COMMON_CORE_BCTIMELINE_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+class BcTimeline
+{
+ public:
+  /// Predefined slots; the consumers define their selections (detector signals, triggers) in the slots from NPredefinedSlots to MaxSlots - 1
+  enum Slot : int {
+    Any = 0, ///< any BC of the BC table
+    NPredefinedSlots
+  };
+  static constexpr int MaxSlots = 16;
+  static constexpr int64_t NotFound = -1;
+
+  /// Removes all entries, keeping the allocated memory
+  void clear()
+  {
+    for (int slot = 0; slot < MaxSlots; ++slot) {
+      mBCs[slot].clear();
+      mIndices[slot].clear();
+    }
+  }
+
+  /// Adds an entry; if the same BC is added more than once to a slot, the last entry is kept (as for std::map::operator[])
+  /// \param slot  slot of the entry
+  /// \param globalBC  global BC
+  /// \param index  row index associated to the BC in this slot
+  void add(int slot, uint64_t globalBC, int32_t index)
+  {
+    mBCs[slot].push_back(globalBC);
+    mIndices[slot].push_back(index);
+  }
+
+  /// Adds all BCs of a BC table to the Any slot, with the BC row index
+  template <typename TBCs>
+  void addBCs(TBCs const& bcs)
+  {
+    mBCs[Any].reserve(mBCs[Any].size() + bcs.size());
+    mIndices[Any].reserve(mIndices[Any].size() + bcs.size());
+    for (const auto& bc : bcs) {
+      add(Any, bc.globalBC(), bc.globalIndex());
+    }
+  }
+
+  /// Sorts the slots. Must be called after the last add() and before any query.
+  void build()
+  {
+    for (int slot = 0; slot < MaxSlots; ++slot) {
+      sortSlot(slot);
+    }
+  }
+
+  /// Number of entries in a slot
+  std::size_t size(int slot) const { return mBCs[slot].size(); }
+
+  /// Whether a slot has no entries
+  bool empty(int slot) const { return mBCs[slot].empty(); }
+
+  /// Global BC of the entry at a position of a slot
+  uint64_t globalBC(int slot, std::size_t pos) const { return mBCs[slot][pos]; }
+
+  /// Row index of the entry at a position of a slot
+  int32_t index(int slot, std::size_t pos) const { return mIndices[slot][pos]; }
+
+  /// Position of the first entry of a slot with BC >= globalBC (size(slot) if none)
+  std::size_t lowerBound(int slot, uint64_t globalBC) const
+  {
+    return std::lower_bound(mBCs[slot].begin(), mBCs[slot].end(), globalBC) - mBCs[slot].begin();
+  }
+
+  /// Position of the first entry of a slot with BC > globalBC (size(slot) if none)
+  std::size_t upperBound(int slot, uint64_t globalBC) const
+  {
+    return std::upper_bound(mBCs[slot].begin(), mBCs[slot].end(), globalBC) - mBCs[slot].begin();
+  }
+
+  /// Position of the entry of a slot with exactly this BC, NotFound otherwise
+  int64_t find(int slot, uint64_t globalBC) const
+  {
+    auto pos = lowerBound(slot, globalBC);
+    return (pos < size(slot) && mBCs[slot][pos] == globalBC) ? static_cast<int64_t>(pos) : NotFound;
+  }
+
+  /// Position of the entry of a slot closest in BC, NotFound if the slot is empty
+  /// \note In case of a tie, the later BC is returned.
+  int64_t findClosest(int slot, uint64_t globalBC) const
+  {
+    if (empty(slot)) {
+      return NotFound;
+    }
+    auto pos = lowerBound(slot, globalBC);
+    if (pos == size(slot)) {
+      return static_cast<int64_t>(pos - 1);
+    }
+    if (pos == 0) {
+      return 0;
+    }
+    return (mBCs[slot][pos] - globalBC <= globalBC - mBCs[slot][pos - 1]) ? static_cast<int64_t>(pos) : static_cast<int64_t>(pos - 1);
+  }
+
+  /// Range [first, last) of positions of a slot with BC in [minBC, maxBC]
+  std::pair<std::size_t, std::size_t> window(int slot, uint64_t minBC, uint64_t maxBC) const
+  {
+    if (maxBC < minBC) {
+      return {0, 0};
+    }
+    return {lowerBound(slot, minBC), upperBound(slot, maxBC)};
+  }
+
+  /// Calls func(pos, globalBC, index) for all entries of a slot with BC in [minBC, maxBC]
+  template <typename F>
+  void forEachInWindow(int slot, uint64_t minBC, uint64_t maxBC, F&& func) const
+  {
+    auto [first, last] = window(slot, minBC, maxBC);
+    for (auto pos = first; pos < last; ++pos) {
+      func(pos, mBCs[slot][pos], mIndices[slot][pos]);
+    }
+  }
+
+ private:
+  /// Sorts a slot by BC and removes duplicate BCs, keeping the last added entry
+  void sortSlot(int slot)
+  {
+    auto& bcs = mBCs[slot];
+    auto& indices = mIndices[slot];
+    if (bcs.empty()) {
+      return;
+    }
+    if (!std::is_sorted(bcs.begin(), bcs.end())) {
+      mOrder.resize(bcs.size());
+      std::iota(mOrder.begin(), mOrder.end(), 0);
+      std::stable_sort(mOrder.begin(), mOrder.end(), [&bcs](std::size_t a, std::size_t b) { return bcs[a] < bcs[b]; });
+      mSortedBCs.resize(bcs.size());
+      mSortedIndices.resize(bcs.size());
+      for (std::size_t i = 0; i < mOrder.size(); ++i) {
+        mSortedBCs[i] = bcs[mOrder[i]];
+        mSortedIndices[i] = indices[mOrder[i]];
+      }
+      bcs.swap(mSortedBCs);
+      indices.swap(mSortedIndices);
+    }
+    // keep the last of equal BCs
+    std::size_t nUnique = 0;
+    for (std::size_t i = 0; i < bcs.size(); ++i) {
+      if (i + 1 < bcs.size() && bcs[i + 1] == bcs[i]) {
+        continue;
+      }
+      bcs[nUnique] = bcs[i];
+      indices[nUnique] = indices[i];
+      ++nUnique;
+    }
+    bcs.resize(nUnique);
+    indices.resize(nUnique);
+  }
+
+  std::array<std::vector<uint64_t>, MaxSlots> mBCs;    ///< sorted global BCs per slot
+  std::array<std::vector<int32_t>, MaxSlots> mIndices; ///< row indices per slot, parallel to mBCs
+
+  // scratch buffers for build()
+  std::vector<std::size_t> mOrder;
+  std::vector<uint64_t> mSortedBCs;
+  std::vector<int32_t> mSortedIndices;
+};
+
+#endif // COMMON_CORE_BCTIMELINE_H_
@@ -0,0 +1,161 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CalibrationLUT.h
+/// \brief Flat lookup table of the contents of a calibration histogram
+///
+/// The bin contents of a TH1, TH2 or TH3 (including under- and overflows, in the global bin order of ROOT)
+/// and its axes are copied once, e.g. when the calibration of a new run is fetched from the CCDB.
+/// The per-event lookups are then a direct index for fixed-width axes or a binary search on the bin edges
+/// for variable-width axes, without virtual calls, and give the same results as
+/// TH1::GetBinContent(TH1::FindFixBin(x)). A linear interpolation between the bin centres, as in
+/// TH1::Interpolate, is provided for one-dimensional tables.
+
+#ifndef COMMON_CORE_CALIBRATIONLUT_H_
+#define COMMON_CORE_CALIBRATIONLUT_H_
+
+#include <TAxis.h>
+#include <TH1.h>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace o2::common::core
+{
+
+class CalibrationLUT
+{
+ public:
+  /// Axis of the table, with the binning of a TAxis
+  struct Axis {
+    int nBins = 1;
+    double min = 0.;
+    double max = 1.;
+    std::vector<double> edges; ///< bin edges of variable-width axes, empty for fixed-width axes
+
+    void set(const TAxis* axis)
+    {
+      nBins = axis->GetNbins();
+      min = axis->GetXmin();
+      max = axis->GetXmax();
+      edges.clear();
+      if (axis->GetXbins()->GetSize() > 0) {
+        edges.assign(axis->GetXbins()->GetArray(), axis->GetXbins()->GetArray() + axis->GetXbins()->GetSize());
+      }
+    }
+
+    /// Bin of a value, 0 for underflow and nBins + 1 for overflow, as TAxis::FindFixBin
+    int findBin(double x) const
+    {
+      if (x < min) {
+        return 0;
+      }
+      if (!(x < max)) {
+        return nBins + 1;
+      }
+      if (edges.empty()) {
+        return 1 + static_cast<int>(nBins * (x - min) / (max - min));
+      }
+      return std::upper_bound(edges.begin(), edges.end(), x) - edges.begin();
+    }
+
+    /// Centre of a bin, as TAxis::GetBinCenter
+    double getBinCenter(int bin) const
+    {
+      if (edges.empty()) {
+        const double width = (max - min) / nBins;
+        return min + (bin - 1) * width + 0.5 * width;
+      }
+      return 0.5 * (edges[bin - 1] + edges[bin]);
+    }
+  };
+
+  /// Copies the contents and the axes of a histogram, the table is invalid if the histogram is null
+  /// \return whether the table is valid
+  bool set(const TH1* histogram)
+  {
+    mContents.clear();
+    if (!histogram) {
+      return false;
+    }
+    mDimension = histogram->GetDimension();
+    mAxes[0].set(histogram->GetXaxis());
+    mAxes[1].set(histogram->GetYaxis());
+    mAxes[2].set(histogram->GetZaxis());
+    mStrideY = mAxes[0].nBins + 2;
+    mStrideZ = mStrideY * (mAxes[1].nBins + 2);
+    const int nCells = histogram->GetNcells();
+    mContents.resize(nCells);
+    for (int bin = 0; bin < nCells; bin++) {
+      mContents[bin] = histogram->GetBinContent(bin);
+    }
+    return true;
+  }
+
+  void clear() { mContents.clear(); }
+
+  bool isValid() const { return !mContents.empty(); }
+
+  int getDimension() const { return mDimension; }
+
+  Axis const& getAxis(int axis) const { return mAxes[axis]; }
+
+  /// Content of a bin, as TH1::GetBinContent(binX, binY, binZ): bins out of range are set to the under- or overflow.
+  /// The table must be valid.
+  double getBinContent(int binX, int binY = 0, int binZ = 0) const
+  {
+    binX = std::clamp(binX, 0, mAxes[0].nBins + 1);
+    binY = mDimension > 1 ? std::clamp(binY, 0, mAxes[1].nBins + 1) : 0;
+    binZ = mDimension > 2 ? std::clamp(binZ, 0, mAxes[2].nBins + 1) : 0;
+    return mContents[binX + mStrideY * binY + mStrideZ * binZ];
+  }
+
+  /// Content of the bin of a value, as TH1::GetBinContent(TH1::FindFixBin(x, y, z))
+  double getValue(double x, double y = 0., double z = 0.) const
+  {
+    const int binY = mDimension > 1 ? mAxes[1].findBin(y) : 0;
+    const int binZ = mDimension > 2 ? mAxes[2].findBin(z) : 0;
+    return getBinContent(mAxes[0].findBin(x), binY, binZ);
+  }
+
+  /// Linear interpolation between the bin centres of a one-dimensional table, as TH1::Interpolate(x)
+  double interpolate(double x) const
+  {
+    const auto& axis = mAxes[0];
+    if (x <= axis.getBinCenter(1)) {
+      return getBinContent(1);
+    }
+    if (x >= axis.getBinCenter(axis.nBins)) {
+      return getBinContent(axis.nBins);
+    }
+    int bin = axis.findBin(x);
+    if (x <= axis.getBinCenter(bin)) {
+      bin--;
+    }
+    const double x0 = axis.getBinCenter(bin);
+    const double x1 = axis.getBinCenter(bin + 1);
+    const double y0 = getBinContent(bin);
+    const double y1 = getBinContent(bin + 1);
+    return y0 + (x - x0) * ((y1 - y0) / (x1 - x0));
+  }
+
+ private:
+  int mDimension = 1;
+  std::array<Axis, 3> mAxes;
+  int mStrideY = 0;              ///< global-bin stride of the y axis
+  int mStrideZ = 0;              ///< global-bin stride of the z axis
+  std::vector<double> mContents; ///< bin contents in global bin order
+};
+
+} // namespace o2::common::core
+
+#endif // COMMON_CORE_CALIBRATIONLUT_H_
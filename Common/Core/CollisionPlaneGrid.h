@@ -0,0 +1,159 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CollisionPlaneGrid.h
+/// \brief Per-DataFrame grid of track positions on a plane, bucketed by collision
+///
+/// The tracks are added once per DataFrame with their collision and their (x, y) position on a plane, e.g. the
+/// matching plane of forward tracks, and sorted into the cells of a grid per collision. A box query for any
+/// collision (same event or mixed event) then visits only the cells overlapping the box. Positions outside the
+/// grid range are kept in the edge cells, and the candidates are returned in insertion order, so the result is
+/// a superset of the tracks in the box independent of the cell size, to which the caller applies its exact selection.
+///
+/// Usage: clear(), add() the tracks, build(), then query any number of boxes. Memory is kept between DataFrames.
+
+#ifndef COMMON_CORE_COLLISIONPLANEGRID_H_
+#define COMMON_CORE_COLLISIONPLANEGRID_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+namespace o2::common::core
+{
+
+class CollisionPlaneGrid
+{
+ public:
+  /// Removes all tracks, keeping the allocated memory
+  void clear()
+  {
+    mCollision.clear();
+    mX.clear();
+    mY.clear();
+    mPayload.clear();
+    mCollisionSlot.clear();
+  }
+
+  /// \param collisionId collision of the track
+  /// \param x, y position of the track on the plane
+  /// \param payload user index, typically the track global index
+  void add(int collisionId, float x, float y, int64_t payload)
+  {
+    mCollision.push_back(collisionId);
+    mX.push_back(x);
+    mY.push_back(y);
+    mPayload.push_back(payload);
+  }
+
+  /// Sorts the tracks into the cells. Must be called after the last add() and before any query.
+  /// \param cellSize target size of the cells, typically of the order of the query box
+  /// \param maxCellsPerAxis maximum number of cells per axis, bounding the memory per collision
+  void build(float cellSize, int maxCellsPerAxis = 32)
+  {
+    const auto nTracks = mX.size();
+    mCollisionSlot.clear();
+    for (const auto& collisionId : mCollision) {
+      mCollisionSlot.emplace(collisionId, mCollisionSlot.size());
+    }
+    if (nTracks) {
+      const auto [xMin, xMax] = std::minmax_element(mX.begin(), mX.end());
+      const auto [yMin, yMax] = std::minmax_element(mY.begin(), mY.end());
+      setAxis(*xMin, *xMax, cellSize, maxCellsPerAxis, mXMin, mXCellSize, mNXCells);
+      setAxis(*yMin, *yMax, cellSize, maxCellsPerAxis, mYMin, mYCellSize, mNYCells);
+    }
+    const std::size_t nCellsPerCollision = mNXCells * mNYCells;
+    mCell.resize(nTracks);
+    mCellStart.assign(mCollisionSlot.size() * nCellsPerCollision + 1, 0);
+    for (std::size_t i = 0; i < nTracks; i++) {
+      mCell[i] = mCollisionSlot[mCollision[i]] * nCellsPerCollision + xCell(mX[i]) * mNYCells + yCell(mY[i]);
+      mCellStart[mCell[i] + 1]++;
+    }
+    std::partial_sum(mCellStart.begin(), mCellStart.end(), mCellStart.begin());
+    mCellEntries.resize(nTracks);
+    mFill.assign(mCellStart.begin(), mCellStart.end() - 1);
+    for (std::size_t i = 0; i < nTracks; i++) { // keeps the tracks of each cell in insertion order
+      mCellEntries[mFill[mCell[i]]++] = i;
+    }
+  }
+
+  std::size_t size() const { return mX.size(); }
+  bool hasCollision(int collisionId) const { return mCollisionSlot.count(collisionId) > 0; }
+  int collisionId(int position) const { return mCollision[position]; }
+  float x(int position) const { return mX[position]; }
+  float y(int position) const { return mY[position]; }
+  int64_t payload(int position) const { return mPayload[position]; }
+
+  /// Fills the positions (in insertion order) of the tracks of a collision in the cells overlapping the box
+  /// [xMin, xMax] x [yMin, yMax]. The result is a superset of the tracks in the box.
+  void boxCandidates(int collisionId, float xMin, float xMax, float yMin, float yMax, std::vector<int>& candidates) const
+  {
+    candidates.clear();
+    const auto slot = mCollisionSlot.find(collisionId);
+    if (slot == mCollisionSlot.end()) {
+      return;
+    }
+    const std::size_t collisionOffset = slot->second * mNXCells * mNYCells;
+    const int yCellFirst = yCell(yMin);
+    const int yCellLast = yCell(yMax);
+    for (int iX = xCell(xMin); iX <= xCell(xMax); iX++) { // the y cells of an x column are contiguous
+      const std::size_t first = collisionOffset + iX * mNYCells + yCellFirst;
+      const std::size_t last = collisionOffset + iX * mNYCells + yCellLast;
+      candidates.insert(candidates.end(), mCellEntries.begin() + mCellStart[first], mCellEntries.begin() + mCellStart[last + 1]);
+    }
+    std::sort(candidates.begin(), candidates.end());
+  }
+
+ private:
+  static void setAxis(float min, float max, float cellSize, int maxCells, float& axisMin, float& axisCellSize, int& nCells)
+  {
+    axisMin = min;
+    nCells = std::clamp(static_cast<int>(std::ceil((max - min) / cellSize)), 1, maxCells);
+    axisCellSize = max > min ? (max - min) / nCells : cellSize;
+  }
+
+  static int cell(float value, float min, float cellSize, int nCells)
+  {
+    const float position = (value - min) / cellSize;
+    if (!(position > 0.f)) { // also catches NaN
+      return 0;
+    }
+    return position < nCells ? static_cast<int>(position) : nCells - 1;
+  }
+
+  int xCell(float x) const { return cell(x, mXMin, mXCellSize, mNXCells); }
+  int yCell(float y) const { return cell(y, mYMin, mYCellSize, mNYCells); }
+
+  float mXMin = 0.f;
+  float mXCellSize = 1.f;
+  int mNXCells = 1;
+  float mYMin = 0.f;
+  float mYCellSize = 1.f;
+  int mNYCells = 1;
+
+  std::vector<int> mCollision;
+  std::vector<float> mX;
+  std::vector<float> mY;
+  std::vector<int64_t> mPayload;
+  std::unordered_map<int, std::size_t> mCollisionSlot; ///< dense index of each collision with tracks
+  std::vector<std::size_t> mCell;                      ///< cell of each track
+  std::vector<int> mCellStart;                         ///< first entry of each cell in mCellEntries, with a final end marker
+  std::vector<int> mCellEntries;                       ///< track positions sorted by cell
+  std::vector<int> mFill;                              ///< scratch fill pointers for build()
+};
+
+} // namespace o2::common::core
+
+#endif // COMMON_CORE_COLLISIONPLANEGRID_H_
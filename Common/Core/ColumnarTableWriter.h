@@ -0,0 +1,258 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ColumnarTableWriter.h
+/// \brief Writer of selected columns of AO2D tables into compressed columnar files for ML training
+///
+/// The columns are streamed, DataFrame by DataFrame, into an Arrow IPC file (Feather v2) with compressed record
+/// batches of a fixed number of rows. The files are read without ROOT and without conversion, e.g. with
+/// pyarrow.feather.read_table, pandas.read_feather or polars.read_ipc.
+/// Only the persistent columns of a table exist in its Arrow representation, dynamic columns cannot be exported.
+///
+/// Usage: configure(), then write() the tables in the process function and close() at the end of the processing
+/// (e.g. in a CallbackService::Id::Stop callback). The file is opened at the first write().
+/// ColumnarTableExportTask is a ready-made task exporting a whole table, to be added to a workflow with
+/// adaptAnalysisTask<ColumnarTableExportTask<Table, defaultFileName>>(cfgc, TaskName{"..."}).
+
+#ifndef COMMON_CORE_COLUMNARTABLEWRITER_H_
+#define COMMON_CORE_COLUMNARTABLEWRITER_H_
+
+#include <Framework/AnalysisTask.h>
+#include <Framework/CallbackService.h>
+#include <Framework/Configurable.h>
+#include <Framework/InitContext.h>
+#include <Framework/Logger.h>
+
+#include <arrow/api.h>
+#include <arrow/compute/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
+#include <arrow/util/compression.h>
+
+#include <cctype>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace o2::common::core
+{
+
+/// Configurables of a ColumnarTableWriter, to be added to a task
+struct ColumnarTableWriterConfigurables : o2::framework::ConfigurableGroup {
+  std::string prefix = "columnarExport"; // JSON group name
+  o2::framework::Configurable<std::string> fileName{"fileName", "", "output file name (Arrow IPC / Feather v2), empty for the default name of the task"};
+  o2::framework::Configurable<std::vector<std::string>> columns{"columns", std::vector<std::string>{}, "names of the columns to export (e.g. fPt or pt), empty for all columns"};
+  o2::framework::Configurable<float> keepFraction{"keepFraction", 1.f, "fraction of the rows randomly kept (down-sampling)"};
+  o2::framework::Configurable<int64_t> rowGroupSize{"rowGroupSize", 100000, "number of rows per record batch"};
+  o2::framework::Configurable<std::string> compression{"compression", "zstd", "compression codec: zstd, lz4 or uncompressed"};
+  o2::framework::Configurable<uint64_t> seed{"seed", 0, "seed of the down-sampling, 0 for a random seed"};
+};
+
+class ColumnarTableWriter
+{
+ public:
+  ColumnarTableWriter() = default;
+  ColumnarTableWriter(const ColumnarTableWriter&) = delete;
+  ColumnarTableWriter& operator=(const ColumnarTableWriter&) = delete;
+  ~ColumnarTableWriter() { close(); }
+
+  /// \param fileName  output file name
+  /// \param columns  names of the exported columns, all columns if empty
+  /// \param keepFraction  fraction of the rows randomly kept
+  /// \param rowGroupSize  number of rows per record batch
+  /// \param compression  compression codec name (zstd, lz4, uncompressed)
+  /// \param seed  seed of the down-sampling, 0 for a random seed
+  void configure(std::string fileName, std::vector<std::string> columns, float keepFraction = 1.f, int64_t rowGroupSize = 100000, std::string compression = "zstd", uint64_t seed = 0)
+  {
+    mFileName = std::move(fileName);
+    mColumnNames = std::move(columns);
+    mKeepFraction = keepFraction;
+    mRowGroupSize = rowGroupSize > 0 ? rowGroupSize : 1;
+    mCompression = std::move(compression);
+    mRandom.seed(seed != 0 ? seed : std::random_device{}());
+  }
+
+  /// Configures the writer from the task configurables, with a default file name
+  void configure(ColumnarTableWriterConfigurables const& config, std::string const& defaultFileName)
+  {
+    configure(config.fileName.value.empty() ? defaultFileName : config.fileName.value, config.columns.value, config.keepFraction, config.rowGroupSize, config.compression.value, config.seed);
+  }
+
+  /// Appends the selected columns of the (down-sampled) rows of a table
+  template <typename TTable>
+  void write(TTable const& table)
+  {
+    writeArrowTable(table.asArrowTable());
+  }
+
+  void writeArrowTable(std::shared_ptr<arrow::Table> const& table)
+  {
+    if (!table || table->num_rows() == 0) {
+      return;
+    }
+    if (!mWriter) {
+      open(*table->schema());
+    }
+    auto selected = valueOrFatal(table->SelectColumns(mColumnIndices), "selecting the columns");
+    if (mKeepFraction < 1.f) {
+      selected = downsample(selected);
+    }
+    mNPendingRows += selected->num_rows();
+    mPending.push_back(std::move(selected));
+    if (mNPendingRows >= mRowGroupSize) {
+      flush(false);
+    }
+  }
+
+  /// Writes the remaining rows and the file footer
+  void close()
+  {
+    if (!mWriter) {
+      return;
+    }
+    flush(true);
+    checkOrFatal(mWriter->Close(), "closing the writer");
+    checkOrFatal(mOutput->Close(), "closing the file");
+    LOG(info) << "ColumnarTableWriter: " << mNWrittenRows << " rows written to " << mFileName;
+    mWriter.reset();
+    mOutput.reset();
+  }
+
+  int64_t getNWrittenRows() const { return mNWrittenRows; }
+
+ private:
+  static void checkOrFatal(arrow::Status const& status, const char* what)
+  {
+    if (!status.ok()) {
+      LOG(fatal) << "ColumnarTableWriter: error " << what << ": " << status.ToString();
+    }
+  }
+
+  template <typename T>
+  static T valueOrFatal(arrow::Result<T> result, const char* what)
+  {
+    checkOrFatal(result.status(), what);
+    return result.MoveValueUnsafe();
+  }
+
+  /// Opens the file and resolves the column names against the schema of the first table
+  void open(arrow::Schema const& schema)
+  {
+    mColumnIndices.clear();
+    if (mColumnNames.empty()) {
+      for (int i = 0; i < schema.num_fields(); i++) {
+        mColumnIndices.push_back(i);
+      }
+    }
+    for (const auto& name : mColumnNames) {
+      int index = schema.GetFieldIndex(name);
+      if (index < 0 && !name.empty()) { // getter-style name, e.g. pt for fPt
+        std::string columnName = "f" + name;
+        columnName[1] = std::toupper(columnName[1]);
+        index = schema.GetFieldIndex(columnName);
+      }
+      if (index < 0) {
+        LOG(fatal) << "ColumnarTableWriter: column " << name << " not found in the table";
+      }
+      mColumnIndices.push_back(index);
+    }
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    for (const auto& index : mColumnIndices) {
+      fields.push_back(schema.field(index));
+    }
+    auto options = arrow::ipc::IpcWriteOptions::Defaults();
+    auto compressionType = valueOrFatal(arrow::util::Codec::GetCompressionType(mCompression), "parsing the compression codec");
+    if (compressionType != arrow::Compression::UNCOMPRESSED) {
+      options.codec = valueOrFatal(arrow::util::Codec::Create(compressionType), "creating the compression codec");
+    }
+    mOutput = valueOrFatal(arrow::io::FileOutputStream::Open(mFileName), "opening the file");
+    mWriter = valueOrFatal(arrow::ipc::MakeFileWriter(mOutput, arrow::schema(fields), options), "creating the writer");
+    mNWrittenRows = 0;
+  }
+
+  /// Keeps each row with probability mKeepFraction
+  std::shared_ptr<arrow::Table> downsample(std::shared_ptr<arrow::Table> const& table)
+  {
+    std::uniform_real_distribution<float> uniform(0.f, 1.f);
+    arrow::Int64Builder rows;
+    for (int64_t row = 0; row < table->num_rows(); row++) {
+      if (uniform(mRandom) < mKeepFraction) {
+        checkOrFatal(rows.Append(row), "down-sampling");
+      }
+    }
+    auto indices = valueOrFatal(rows.Finish(), "down-sampling");
+    auto taken = valueOrFatal(arrow::compute::Take(table, indices), "down-sampling");
+    return taken.table();
+  }
+
+  /// Writes the pending rows in full record batches, and the last partial batch if all is set
+  void flush(bool all)
+  {
+    if (mNPendingRows == 0) {
+      return;
+    }
+    auto pending = valueOrFatal(arrow::ConcatenateTables(mPending), "concatenating the tables");
+    pending = valueOrFatal(pending->CombineChunks(), "combining the chunks");
+    const int64_t nRowsToWrite = all ? mNPendingRows : (mNPendingRows / mRowGroupSize) * mRowGroupSize;
+    checkOrFatal(mWriter->WriteTable(*pending->Slice(0, nRowsToWrite), mRowGroupSize), "writing the table");
+    mNWrittenRows += nRowsToWrite;
+    mPending.clear();
+    mNPendingRows -= nRowsToWrite;
+    if (mNPendingRows > 0) {
+      mPending.push_back(pending->Slice(nRowsToWrite));
+    }
+  }
+
+  std::string mFileName;
+  std::vector<std::string> mColumnNames;
+  float mKeepFraction = 1.f;
+  int64_t mRowGroupSize = 100000;
+  std::string mCompression = "zstd";
+  std::mt19937_64 mRandom;
+
+  std::vector<int> mColumnIndices;                        ///< indices of the exported columns in the table schema
+  std::shared_ptr<arrow::io::FileOutputStream> mOutput;   ///< output file
+  std::shared_ptr<arrow::ipc::RecordBatchWriter> mWriter; ///< IPC file writer
+  std::vector<std::shared_ptr<arrow::Table>> mPending;    ///< rows not written yet
+  int64_t mNPendingRows = 0;                              ///< number of rows not written yet
+  int64_t mNWrittenRows = 0;                              ///< number of rows written
+};
+
+/// Task writing selected columns of a table into a columnar file, enabled with its processExport switch
+/// \tparam TTable  exported table
+/// \tparam defaultFileName  output file name if the fileName configurable is empty
+template <typename TTable, const char* defaultFileName>
+struct ColumnarTableExportTask {
+  ColumnarTableWriterConfigurables config;
+  ColumnarTableWriter writer;
+
+  void init(o2::framework::InitContext& initContext)
+  {
+    if (!doprocessExport) {
+      return;
+    }
+    writer.configure(config, defaultFileName);
+    initContext.services().get<o2::framework::CallbackService>().set<o2::framework::CallbackService::Id::Stop>([this]() { writer.close(); });
+  }
+
+  void processExport(TTable const& table)
+  {
+    writer.write(table);
+  }
+  PROCESS_SWITCH(ColumnarTableExportTask, processExport, "Export the table into a columnar (Arrow IPC) file", false);
+};
+
+} // namespace o2::common::core
+
+#endif // COMMON_CORE_COLUMNARTABLEWRITER_H_
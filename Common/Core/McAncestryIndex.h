@@ -0,0 +1,392 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file McAncestryIndex.h
+/// \brief Flat per-DataFrame index of the MC particle genealogy for fast MC matching
+///
+/// The index is built once per DataFrame from the McParticles table and answers the mother/daughter
+/// queries of RecoDecay (getMother, getDaughters, getMatchedMCRec, getCharmHadronOrigin) on contiguous
+/// arrays instead of walking the table iterators. Results of mother and origin searches are cached,
+/// so that repeated lookups for the same particle (e.g. a track used in many candidates) are O(1).
+/// Pass a pointer to a built index as the last argument of the RecoDecay functions to use it.
+
+#ifndef COMMON_CORE_MCANCESTRYINDEX_H_
+#define COMMON_CORE_MCANCESTRYINDEX_H_
+
+#include <TMCProcess.h> // for VMC Particle Production Process
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class McAncestryIndex
+{
+ public:
+  /// Origin codes, identical to RecoDecay::OriginType
+  static constexpr int OriginNone = 0;
+  static constexpr int OriginPrompt = 1;
+  static constexpr int OriginNonPrompt = 2;
+
+  /// Fills the index from the MC particle table of the current DataFrame
+  /// \param particlesMC  unfiltered table with MC particles
+  /// \note Allocated memory is kept and reused for the next DataFrames.
+  template <typename T>
+  void build(const T& particlesMC)
+  {
+    const auto nParticles = static_cast<std::size_t>(particlesMC.size());
+    mOffset = particlesMC.offset();
+    mPdg.resize(nParticles);
+    mProcess.resize(nParticles);
+    mMotherFirst.resize(nParticles);
+    mMotherLast.resize(nParticles);
+    mDaughterFirst.resize(nParticles);
+    mDaughterLast.resize(nParticles);
+    for (const auto& particle : particlesMC) {
+      const auto iLocal = static_cast<std::size_t>(particle.globalIndex() - mOffset);
+      mPdg[iLocal] = particle.pdgCode();
+      mProcess[iLocal] = static_cast<int>(particle.getProcess());
+      mMotherFirst[iLocal] = -1;
+      mMotherLast[iLocal] = -1;
+      if (particle.has_mothers()) {
+        const auto& mothersIds = particle.mothersIds();
+        mMotherFirst[iLocal] = mothersIds.front();
+        mMotherLast[iLocal] = mothersIds.back();
+      }
+      mDaughterFirst[iLocal] = -1;
+      mDaughterLast[iLocal] = -1;
+      if (particle.has_daughters()) {
+        const auto& daughtersIds = particle.daughtersIds();
+        mDaughterFirst[iLocal] = daughtersIds.front();
+        mDaughterLast[iLocal] = daughtersIds.back();
+      }
+    }
+    mOriginCache.assign(nParticles, {-1, -1});
+    mOriginQuarkCache.assign(nParticles, -1);
+    mNearestCharmHadron.assign(nParticles, Uncomputed);
+    mNearestBeautyHadron.assign(nParticles, Uncomputed);
+    mMotherCache.clear();
+  }
+
+  /// \return number of indexed particles
+  std::size_t size() const { return mPdg.size(); }
+
+  /// \return PDG code of the particle with the given global index
+  int pdg(int64_t index) const { return mPdg[local(index)]; }
+
+  /// \return true if the particle has mothers
+  bool hasMothers(int64_t index) const { return mMotherFirst[local(index)] > -1; }
+
+  /// \return global index of the first mother, -1 if none
+  int firstMother(int64_t index) const { return mMotherFirst[local(index)]; }
+
+  /// \return true if the particle has daughters
+  bool hasDaughters(int64_t index) const { return mDaughterFirst[local(index)] > -1; }
+
+  /// \return global indices of the first and last daughters, {-1, -1} if none
+  std::pair<int, int> daughters(int64_t index) const { return {mDaughterFirst[local(index)], mDaughterLast[local(index)]}; }
+
+  /// \return number of direct daughters
+  int nDaughters(int64_t index) const { return hasDaughters(index) ? mDaughterLast[local(index)] - mDaughterFirst[local(index)] + 1 : 0; }
+
+  /// \return global index of the closest charm-hadron ancestor, -1 if none
+  int getNearestCharmHadronAncestor(int64_t index) const
+  {
+    auto& cached = mNearestCharmHadron[local(index)];
+    if (cached == Uncomputed) {
+      cached = findAncestor(index, [](int pdgCode) { return isCharmHadron(std::abs(pdgCode)); });
+    }
+    return cached;
+  }
+
+  /// \return global index of the closest beauty-hadron ancestor, -1 if none
+  int getNearestBeautyHadronAncestor(int64_t index) const
+  {
+    auto& cached = mNearestBeautyHadron[local(index)];
+    if (cached == Uncomputed) {
+      cached = findAncestor(index, [](int pdgCode) { return isBeautyHadron(std::abs(pdgCode)); });
+    }
+    return cached;
+  }
+
+  /// Finds the mother of an MC particle by looking for the expected PDG code in the mother chain.
+  /// Same search as RecoDecay::getMother, with results cached per (particle, PDG, depth) query.
+  /// \param index  global index of the MC particle
+  /// \param pdgMother  expected mother PDG code
+  /// \param acceptAntiParticles  switch to accept the antiparticle of the expected mother
+  /// \param sign  antiparticle indicator of the found mother w.r.t. pdgMother; 1 if particle, -1 if antiparticle, 0 if mother not found
+  /// \param depthMax  maximum decay tree level to check. If -1, all levels are considered.
+  /// \return global index of the mother particle if found, -1 otherwise
+  int getMother(int64_t index, int pdgMother, bool acceptAntiParticles = false, int8_t* sign = nullptr, int8_t depthMax = -1) const
+  {
+    const MotherKey key{static_cast<int32_t>(local(index)), pdgMother, depthMax, acceptAntiParticles};
+    auto it = mMotherCache.find(key);
+    if (it == mMotherCache.end()) {
+      int8_t sgn = 0;
+      const int indexMother = searchMother(index, pdgMother, acceptAntiParticles, sgn, depthMax);
+      it = mMotherCache.emplace(key, std::make_pair(indexMother, sgn)).first;
+    }
+    if (sign) {
+      *sign = it->second.second;
+    }
+    return it->second.first;
+  }
+
+  /// Gets the complete list of indices of final-state daughters of an MC particle.
+  /// Same as RecoDecay::getDaughters, on the flat arrays.
+  /// \param index  global index of the MC particle
+  /// \param list  vector where the indices of final-state daughters will be added
+  /// \param arrPdgFinal  array of PDG codes of particles to be considered final if found
+  /// \param depthMax  maximum decay tree level; Daughters at this level (or beyond) will be considered final. If -1, all levels are considered.
+  /// \param stage  decay tree level; If different from 0, the particle itself will be added in the list in case it has no daughters.
+  template <bool checkProcess = false, std::size_t N>
+  void getDaughters(int64_t index, std::vector<int>* list, const std::array<int, N>& arrPdgFinal, int8_t depthMax = -1, int8_t stage = 0) const
+  {
+    if (!list) {
+      return;
+    }
+    const auto iLocal = local(index);
+    if constexpr (checkProcess) {
+      if (stage != 0 && mProcess[iLocal] != TMCProcess::kPDecay && mProcess[iLocal] != TMCProcess::kPPrimary) {
+        return;
+      }
+    }
+    bool isFinal = depthMax > -1 && stage >= depthMax;
+    if (!isFinal && mDaughterFirst[iLocal] < 0) {
+      if (stage == 0) {
+        return;
+      }
+      isFinal = true;
+    }
+    if (!isFinal && stage > 0) {
+      const auto pdgParticle = std::abs(mPdg[iLocal]);
+      for (const auto pdgFinal : arrPdgFinal) {
+        if (pdgParticle == std::abs(pdgFinal)) {
+          isFinal = true;
+          break;
+        }
+      }
+    }
+    if (isFinal) {
+      list->push_back(static_cast<int>(index));
+      return;
+    }
+    stage++;
+    for (auto iDaughter = mDaughterFirst[iLocal]; iDaughter <= mDaughterLast[iLocal]; ++iDaughter) {
+      getDaughters<checkProcess>(iDaughter, list, arrPdgFinal, depthMax, stage);
+    }
+  }
+
+  /// Finds the origin (from charm hadronisation or beauty-hadron decay) of charm hadrons.
+  /// Same as RecoDecay::getCharmHadronOrigin, with results cached per particle.
+  /// \param index  global index of the MC particle
+  /// \param searchUpToQuark if true tag origin based on charm/beauty quark otherwise on the presence of a b-hadron or c-hadron
+  /// \param idxBhadMothers optional vector of b-hadron indices
+  /// \return origin code (OriginNone, OriginPrompt, OriginNonPrompt)
+  int getCharmHadronOrigin(int64_t index, bool searchUpToQuark = false, std::vector<int>* idxBhadMothers = nullptr) const
+  {
+    const auto iLocal = local(index);
+    if (!searchUpToQuark) {
+      // at most one b-hadron is collected in this mode, so it is cached together with the origin
+      auto& cached = mOriginCache[iLocal];
+      if (cached.first < 0) {
+        std::vector<int> idxBhad{};
+        cached.first = static_cast<int8_t>(searchCharmHadronOrigin(index, false, &idxBhad));
+        cached.second = idxBhad.empty() ? -1 : idxBhad.front();
+      }
+      if (idxBhadMothers && cached.second > -1) {
+        idxBhadMothers->push_back(cached.second);
+      }
+      return cached.first;
+    }
+    if (idxBhadMothers) {
+      return searchCharmHadronOrigin(index, true, idxBhadMothers);
+    }
+    auto& cached = mOriginQuarkCache[iLocal];
+    if (cached < 0) {
+      cached = static_cast<int8_t>(searchCharmHadronOrigin(index, true, nullptr));
+    }
+    return cached;
+  }
+
+ private:
+  static constexpr int Uncomputed = -2;
+  static constexpr int PdgCharm = 4;
+  static constexpr int PdgBottom = 5;
+
+  struct MotherKey {
+    int32_t index;
+    int32_t pdg;
+    int8_t depthMax;
+    bool acceptAntiParticles;
+    bool operator==(const MotherKey& other) const
+    {
+      return index == other.index && pdg == other.pdg && depthMax == other.depthMax && acceptAntiParticles == other.acceptAntiParticles;
+    }
+  };
+
+  struct MotherKeyHash {
+    std::size_t operator()(const MotherKey& key) const
+    {
+      uint64_t word = (static_cast<uint64_t>(static_cast<uint32_t>(key.index)) << 32) | static_cast<uint32_t>(key.pdg);
+      word ^= (static_cast<uint64_t>(static_cast<uint8_t>(key.depthMax)) << 1 | static_cast<uint64_t>(key.acceptAntiParticles)) * 0x9E3779B97F4A7C15ull;
+      return std::hash<uint64_t>{}(word);
+    }
+  };
+
+  static bool isCharmHadron(int pdgAbs) { return pdgAbs / 100 == PdgCharm || pdgAbs / 1000 == PdgCharm; }
+  static bool isBeautyHadron(int pdgAbs) { return pdgAbs / 100 == PdgBottom || pdgAbs / 1000 == PdgBottom; }
+
+  std::size_t local(int64_t index) const { return static_cast<std::size_t>(index - mOffset); }
+
+  /// Breadth-first search of the first ancestor satisfying the predicate on its PDG code
+  template <typename Pred>
+  int findAncestor(int64_t index, Pred pred) const
+  {
+    mStage.assign(1, index);
+    while (!mStage.empty()) {
+      mNextStage.clear();
+      for (const auto iPart : mStage) {
+        const auto iLocal = local(iPart);
+        if (mMotherFirst[iLocal] < 0) {
+          continue;
+        }
+        for (auto iMother = mMotherFirst[iLocal]; iMother <= mMotherLast[iLocal]; ++iMother) {
+          if (std::find(mNextStage.begin(), mNextStage.end(), iMother) != mNextStage.end()) {
+            continue;
+          }
+          if (pred(mPdg[local(iMother)])) {
+            return iMother;
+          }
+          mNextStage.push_back(iMother);
+        }
+      }
+      std::swap(mStage, mNextStage);
+    }
+    return -1;
+  }
+
+  /// Mother search with the stage-by-stage logic of RecoDecay::getMother
+  int searchMother(int64_t index, int pdgMother, bool acceptAntiParticles, int8_t& sgn, int8_t depthMax) const
+  {
+    int indexMother = -1;
+    bool motherFound = false;
+    int depth = 0;
+    mStage.assign(1, index);
+    while (!motherFound && !mStage.empty() && (depthMax < 0 || depth < depthMax)) {
+      mNextStage.clear();
+      for (const auto iPart : mStage) {
+        const auto iLocal = local(iPart);
+        if (mMotherFirst[iLocal] < 0) {
+          continue;
+        }
+        for (auto iMother = mMotherFirst[iLocal]; iMother <= mMotherLast[iLocal]; ++iMother) {
+          if (std::find(mNextStage.begin(), mNextStage.end(), iMother) != mNextStage.end()) {
+            continue;
+          }
+          const auto pdgMotherI = mPdg[local(iMother)];
+          if (pdgMotherI == pdgMother) {
+            sgn = 1;
+            indexMother = iMother;
+            motherFound = true;
+            break;
+          } else if (acceptAntiParticles && pdgMotherI == -pdgMother) {
+            sgn = -1;
+            indexMother = iMother;
+            motherFound = true;
+            break;
+          }
+          mNextStage.push_back(iMother);
+        }
+      }
+      std::swap(mStage, mNextStage);
+      depth++;
+    }
+    return indexMother;
+  }
+
+  /// Origin search with the stage-by-stage logic of RecoDecay::getCharmHadronOrigin
+  int searchCharmHadronOrigin(int64_t index, bool searchUpToQuark, std::vector<int>* idxBhadMothers) const
+  {
+    bool couldBePrompt = isCharmHadron(std::abs(mPdg[local(index)]));
+    mStage.assign(1, index);
+    while (!mStage.empty()) {
+      mNextStage.clear();
+      for (const auto iPart : mStage) {
+        const auto iLocal = local(iPart);
+        if (mMotherFirst[iLocal] < 0) {
+          continue;
+        }
+        // we exit immediately if searchUpToQuark is false and the first mother is a parton
+        if (!searchUpToQuark) {
+          const auto pdgFirstMother = std::abs(mPdg[local(mMotherFirst[iLocal])]);
+          if (pdgFirstMother < 9 || (pdgFirstMother > 20 && pdgFirstMother < 38)) {
+            return OriginPrompt;
+          }
+        }
+        for (auto iMother = mMotherFirst[iLocal]; iMother <= mMotherLast[iLocal]; ++iMother) {
+          if (std::find(mNextStage.begin(), mNextStage.end(), iMother) != mNextStage.end()) {
+            continue;
+          }
+          const auto pdgMotherI = std::abs(mPdg[local(iMother)]);
+          if (searchUpToQuark) {
+            if (idxBhadMothers && isBeautyHadron(pdgMotherI)) {
+              idxBhadMothers->push_back(iMother);
+            }
+            if (pdgMotherI == PdgBottom) {
+              return OriginNonPrompt;
+            }
+            if (pdgMotherI == PdgCharm) {
+              return OriginPrompt;
+            }
+          } else {
+            if (isBeautyHadron(pdgMotherI)) {
+              if (idxBhadMothers) {
+                idxBhadMothers->push_back(iMother);
+              }
+              return OriginNonPrompt;
+            }
+            if (isCharmHadron(pdgMotherI)) {
+              couldBePrompt = true;
+            }
+          }
+          mNextStage.push_back(iMother);
+        }
+      }
+      std::swap(mStage, mNextStage);
+    }
+    if (!searchUpToQuark && couldBePrompt) {
+      return OriginPrompt;
+    }
+    return OriginNone;
+  }
+
+  int64_t mOffset{0};                ///< global index of the first particle of the DataFrame
+  std::vector<int> mPdg{};           ///< PDG codes
+  std::vector<int> mProcess{};       ///< production processes
+  std::vector<int> mMotherFirst{};   ///< global index of the first mother, -1 if none
+  std::vector<int> mMotherLast{};    ///< global index of the last mother, -1 if none
+  std::vector<int> mDaughterFirst{}; ///< global index of the first daughter, -1 if none
+  std::vector<int> mDaughterLast{};  ///< global index of the last daughter, -1 if none
+
+  mutable std::vector<std::pair<int8_t, int>> mOriginCache{};                                  ///< cached origin and b-hadron ancestor (searchUpToQuark = false)
+  mutable std::vector<int8_t> mOriginQuarkCache{};                                             ///< cached origin (searchUpToQuark = true)
+  mutable std::vector<int> mNearestCharmHadron{};                                              ///< cached closest charm-hadron ancestor
+  mutable std::vector<int> mNearestBeautyHadron{};                                             ///< cached closest beauty-hadron ancestor
+  mutable std::unordered_map<MotherKey, std::pair<int, int8_t>, MotherKeyHash> mMotherCache{}; ///< cached mother searches
+  mutable std::vector<int64_t> mStage{};                                                       ///< scratch: particles of the current tree level
+  mutable std::vector<int64_t> mNextStage{};                                                   ///< scratch: particles of the next tree level
+};
+
+#endif // COMMON_CORE_MCANCESTRYINDEX_H_
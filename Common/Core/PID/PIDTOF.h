@@ -19,8 +19,11 @@
 #ifndef COMMON_CORE_PID_PIDTOF_H_
 #define COMMON_CORE_PID_PIDTOF_H_
 
+#include <array>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 // ROOT includes
@@ -558,6 +561,76 @@ class ExpTimes
   }
 };
 
+/// \brief Class to compute the TOF expected resolution and separation of all mass hypotheses of a track in one pass
+/// The species-independent terms (corrected expected momentum, time shift, length, event time) are evaluated once per track,
+/// the results are identical to the ones of ExpTimes
+template <typename TrackType>
+class ExpTimesAllSpecies
+{
+ public:
+  ExpTimesAllSpecies() = default;
+  ~ExpTimesAllSpecies() = default;
+
+  /// Mask of all mass hypotheses
+  static constexpr uint32_t AllSpecies = (1u << o2::track::PID::NIDs) - 1;
+
+  /// Gets the expected resolution and the number of sigmas for the mass hypotheses of the mask, the others are left untouched
+  /// \param parameters Detector response parameters
+  /// \param track Track of interest
+  /// \param speciesMask Mask of the mass hypotheses to compute (bit i for PID index i)
+  /// \param expSigma Expected resolution of the t-texp-t0 per mass hypothesis
+  /// \param separation Number of sigmas per mass hypothesis
+  template <typename ParamType>
+  static void GetExpectedSigmaAndSeparation(const ParamType& parameters, const TrackType& track, const uint32_t speciesMask, std::array<float, o2::track::PID::NIDs>& expSigma, std::array<float, o2::track::PID::NIDs>& separation)
+  {
+    TrackTerms terms;
+    terms.hasTOF = track.hasTOF();
+    terms.length = track.length();
+    terms.tofSignal = track.tofSignal();
+    terms.evTime = track.tofEvTime();
+    terms.evTimeErr = track.tofEvTimeErr();
+    if (terms.hasTOF) {
+      if (track.trackType() == o2::aod::track::Run2Track) {
+        terms.expMom = track.tofExpMom() * o2::constants::physics::invLightSpeedCm2PS / (1.f + track.sign() * parameters.getMomentumChargeShift(track.eta()));
+      } else {
+        terms.expMom = track.tofExpMom() / (1.f + track.sign() * parameters.getMomentumChargeShift(track.eta()));
+        terms.timeShift = parameters.getTimeShift(track.eta(), track.sign());
+      }
+    }
+    fill(parameters, track, terms, speciesMask, expSigma, separation, std::make_index_sequence<o2::track::PID::NIDs>{});
+  }
+
+ private:
+  struct TrackTerms {
+    bool hasTOF = false;
+    float length = 0.f;
+    float tofSignal = 0.f;
+    float evTime = 0.f;
+    float evTimeErr = 0.f;
+    float expMom = 0.f;
+    float timeShift = 0.f;
+  };
+
+  template <o2::track::PID::ID id, typename ParamType>
+  static void fillSpecies(const ParamType& parameters, const TrackType& track, const TrackTerms& terms, std::array<float, o2::track::PID::NIDs>& expSigma, std::array<float, o2::track::PID::NIDs>& separation)
+  {
+    using Response = ExpTimes<TrackType, id>;
+    expSigma[id] = Response::GetExpectedSigma(parameters, track, terms.tofSignal, terms.evTimeErr);
+    if (!terms.hasTOF) {
+      separation[id] = defaultReturnValue;
+      return;
+    }
+    const float expTime = Response::ComputeExpectedTime(terms.expMom, terms.length) + terms.timeShift;
+    separation[id] = (terms.tofSignal - terms.evTime - expTime) / expSigma[id];
+  }
+
+  template <typename ParamType, std::size_t... ids>
+  static void fill(const ParamType& parameters, const TrackType& track, const TrackTerms& terms, const uint32_t speciesMask, std::array<float, o2::track::PID::NIDs>& expSigma, std::array<float, o2::track::PID::NIDs>& separation, std::index_sequence<ids...>)
+  {
+    ((speciesMask & (1u << ids) ? fillSpecies<static_cast<o2::track::PID::ID>(ids)>(parameters, track, terms, expSigma, separation) : void()), ...);
+  }
+};
+
 /// \brief Class to convert the trackTime to the tofSignal used for PID
 template <typename TrackType>
 class TOFSignal
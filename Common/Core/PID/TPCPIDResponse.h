@@ -18,6 +18,7 @@
 #define COMMON_CORE_PID_TPCPIDRESPONSE_H_
 
 #include <array>
+#include <cstdint>
 #include <vector>
 #include <cmath>
 #include "Framework/Logger.h"
@@ -85,10 +86,33 @@ class Response
   float GetSignalDelta(const TrackType& trk, const o2::track::PID::ID id) const;
   /// Gets relative dEdx resolution contribution due to relative pt resolution
   float GetRelativeResolutiondEdx(const float p, const float mass, const float charge, const float resol) const;
+  /// Mask of all mass hypotheses for the all-species getters
+  static constexpr uint32_t AllSpecies = (1u << o2::track::PID::NIDs) - 1;
+  /// Gets the expected signal and resolution for all mass hypotheses of the mask in one pass
+  template <typename CollisionType, typename TrackType>
+  void GetExpectedSignalAndSigmaAllSpecies(const CollisionType& collision, const TrackType& trk, std::array<float, o2::track::PID::NIDs>& expSignal, std::array<float, o2::track::PID::NIDs>& expSigma, const uint32_t speciesMask = AllSpecies) const;
+  /// Gets the number of sigmas for all mass hypotheses from the expected signals and resolutions
+  static void GetNumberOfSigmaAllSpecies(const float tpcSignal, const std::array<float, o2::track::PID::NIDs>& expSignal, const std::array<float, o2::track::PID::NIDs>& expSigma, std::array<float, o2::track::PID::NIDs>& nSigma);
 
   void PrintAll() const;
 
  private:
+  /// Track-dependent terms of the response, shared by all mass hypotheses
+  struct TrackTerms {
+    float p = 0.f;                /// TPC inner momentum
+    float chargeFactorZ2 = 1.f;   /// charge factor for |z| = 2
+    double nclFactorDefault = 1.; /// cluster term of the default resolution
+    double sqrtNcl = 0.;          /// sqrt(nClNorm / ncl)
+    double sqrtOnePlusTgl2 = 1.;  /// sqrt(1 + tgl^2)
+    double signed1Pt = 0.;        /// q/pt
+    double mult = 0.;             /// normalised TPC multiplicity
+  };
+  template <typename CollisionType, typename TrackType>
+  TrackTerms GetTrackTerms(const CollisionType& collision, const TrackType& trk) const;
+  /// Expected signal and resolution of one mass hypothesis from the precomputed track terms
+  void GetExpectedSignalAndSigma(const TrackTerms& terms, const o2::track::PID::ID id, float& expSignal, float& expSigma) const;
+  float GetRelativeResolutiondEdx(const float p, const float mass, const float dEdx, const float chargeFactor, const float resol) const;
+
   std::array<float, 5> mBetheBlochParams = {0.03209809958934784, 19.9768009185791, 2.5266601063857674e-16, 2.7212300300598145, 6.080920219421387};
   std::array<float, 2> mResolutionParamsDefault = {0.07, 0.0};
   std::vector<double> mResolutionParams = {5.43799e-7, 0.053044, 0.667584, 0.0142667, 0.00235175, 1.22482, 2.3501e-7, 0.031585};
@@ -113,63 +137,107 @@ inline float Response::GetExpectedSignal(const TrackType& track, const o2::track
   return bethe >= 0.f ? bethe : -999.f;
 }
 
-/// Gets the expected resolution of the measurement
+/// Computes the terms of the response that do not depend on the mass hypothesis
 template <typename CollisionType, typename TrackType>
-inline float Response::GetExpectedSigma(const CollisionType& collision, const TrackType& track, const o2::track::PID::ID id) const
+inline Response::TrackTerms Response::GetTrackTerms(const CollisionType& collision, const TrackType& track) const
 {
-  if (!track.hasTPC()) {
-    return -999.f;
-  }
-  float resolution = 0.;
+  TrackTerms terms;
+  terms.p = track.tpcInnerParam();
+  terms.chargeFactorZ2 = std::pow(2.f, mChargeFactor);
   if (mUseDefaultResolutionParam) {
-    const float reso = GetExpectedSignal(track, id) * mResolutionParamsDefault[0] * (static_cast<float>(track.tpcNClsFound()) > 0 ? std::sqrt(1. + mResolutionParamsDefault[1] / static_cast<float>(track.tpcNClsFound())) : 1.f);
-    reso >= 0.f ? resolution = reso : resolution = -999.f;
+    terms.nclFactorDefault = static_cast<float>(track.tpcNClsFound()) > 0 ? std::sqrt(1. + mResolutionParamsDefault[1] / static_cast<float>(track.tpcNClsFound())) : 1.f;
   } else {
+    const double ncl = nClNorm / track.tpcNClsFound();
+    const double tgl = track.tgl();
+    terms.sqrtNcl = std::sqrt(ncl);
+    terms.sqrtOnePlusTgl2 = std::sqrt(1 + tgl * tgl);
+    terms.signed1Pt = track.signed1Pt();
+    terms.mult = collision.multTPC() / mMultNormalization;
+  }
+  return terms;
+}
 
-    const double ncl = nClNorm / track.tpcNClsFound(); //
-    const double p = track.tpcInnerParam();
-    const double mass = o2::track::pid_constants::sMasses[id];
-    const double bg = p / mass;
-    const double dEdx = o2::tpc::BetheBlochAleph(static_cast<float>(bg), mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * std::pow(static_cast<float>(o2::track::pid_constants::sCharges[id]), mChargeFactor);
-    const double relReso = GetRelativeResolutiondEdx(p, mass, o2::track::pid_constants::sCharges[id], mResolutionParams[3]);
+/// Gets the expected signal and resolution of one mass hypothesis, the Bethe-Bloch is evaluated once for both
+inline void Response::GetExpectedSignalAndSigma(const TrackTerms& terms, const o2::track::PID::ID id, float& expSignal, float& expSigma) const
+{
+  const int charge = o2::track::pid_constants::sCharges[id];
+  const float chargeFactor = charge == 1 ? 1.f : (charge == 2 ? terms.chargeFactorZ2 : std::pow(static_cast<float>(charge), mChargeFactor));
+  const float mass = o2::track::pid_constants::sMasses[id];
+  const float bethe = o2::tpc::BetheBlochAleph(terms.p / mass, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]);
+  const float signal = mMIP * bethe * chargeFactor;
+  expSignal = signal >= 0.f ? signal : -999.f;
 
-    const std::vector<double> values{1.f / dEdx, track.tgl(), std::sqrt(ncl), relReso, track.signed1Pt(), collision.multTPC() / mMultNormalization};
+  float reso = 0.f;
+  if (mUseDefaultResolutionParam) {
+    reso = expSignal * mResolutionParamsDefault[0] * terms.nclFactorDefault;
+  } else {
+    const double dEdx = bethe * chargeFactor;
+    const double relReso = GetRelativeResolutiondEdx(terms.p, mass, bethe * chargeFactor, chargeFactor, mResolutionParams[3]);
+    const double invdEdx = 1. / dEdx;
+    const double invdEdxTgl = invdEdx / terms.sqrtOnePlusTgl2;
+    const auto& par = mResolutionParams;
+    reso = std::sqrt(std::pow(par[0], 2) * invdEdx + std::pow(par[1], 2) * (terms.sqrtNcl * par[5]) * std::pow(invdEdxTgl, par[2]) + terms.sqrtNcl * std::pow(relReso, 2) + std::pow(par[4] * terms.signed1Pt, 2) + std::pow(terms.mult * par[6], 2) + std::pow(terms.mult * invdEdxTgl * par[7], 2)) * dEdx * mMIP;
+  }
+  expSigma = reso >= 0.f ? reso : -999.f;
+}
 
-    const float reso = sqrt(pow(mResolutionParams[0], 2) * values[0] + pow(mResolutionParams[1], 2) * (values[2] * mResolutionParams[5]) * pow(values[0] / sqrt(1 + pow(values[1], 2)), mResolutionParams[2]) + values[2] * pow(values[3], 2) + pow(mResolutionParams[4] * values[4], 2) + pow(values[5] * mResolutionParams[6], 2) + pow(values[5] * (values[0] / sqrt(1 + pow(values[1], 2))) * mResolutionParams[7], 2)) * dEdx * mMIP;
-    reso >= 0.f ? resolution = reso : resolution = -999.f;
+/// Gets the expected resolution of the measurement
+template <typename CollisionType, typename TrackType>
+inline float Response::GetExpectedSigma(const CollisionType& collision, const TrackType& track, const o2::track::PID::ID id) const
+{
+  if (!track.hasTPC()) {
+    return -999.f;
   }
-  return resolution;
+  float expSignal = 0.f, expSigma = 0.f;
+  GetExpectedSignalAndSigma(GetTrackTerms(collision, track), id, expSignal, expSigma);
+  return expSigma;
 }
 
 /// Gets the number of sigma between the actual signal and the expected signal
 template <typename CollisionType, typename TrackType>
 inline float Response::GetNumberOfSigma(const CollisionType& collision, const TrackType& trk, const o2::track::PID::ID id) const
 {
-  if (GetExpectedSigma(collision, trk, id) < 0.) {
-    return -999.f;
-  }
-  if (GetExpectedSignal(trk, id) < 0.) {
-    return -999.f;
-  }
-  if (!trk.hasTPC()) {
-    return -999.f;
-  }
-  return ((trk.tpcSignal() - GetExpectedSignal(trk, id)) / GetExpectedSigma(collision, trk, id));
+  return GetNumberOfSigmaMCTuned(collision, trk, id, trk.tpcSignal());
 }
 
 template <typename CollisionType, typename TrackType>
 inline float Response::GetNumberOfSigmaMCTuned(const CollisionType& collision, const TrackType& trk, const o2::track::PID::ID id, float mcTunedTPCSignal) const
 {
-  if (GetExpectedSigma(collision, trk, id) < 0.) {
+  if (!trk.hasTPC()) {
     return -999.f;
   }
-  if (GetExpectedSignal(trk, id) < 0.) {
+  float expSignal = 0.f, expSigma = 0.f;
+  GetExpectedSignalAndSigma(GetTrackTerms(collision, trk), id, expSignal, expSigma);
+  if (expSigma < 0. || expSignal < 0.) {
     return -999.f;
   }
+  return ((mcTunedTPCSignal - expSignal) / expSigma);
+}
+
+/// Gets the expected signal and resolution for all mass hypotheses of the mask, hypotheses not in the mask are set to -999.
+/// The track-dependent terms are computed once and shared by the hypotheses, results are identical to the single-species getters.
+template <typename CollisionType, typename TrackType>
+inline void Response::GetExpectedSignalAndSigmaAllSpecies(const CollisionType& collision, const TrackType& trk, std::array<float, o2::track::PID::NIDs>& expSignal, std::array<float, o2::track::PID::NIDs>& expSigma, const uint32_t speciesMask) const
+{
+  expSignal.fill(-999.f);
+  expSigma.fill(-999.f);
   if (!trk.hasTPC()) {
-    return -999.f;
+    return;
+  }
+  const TrackTerms terms = GetTrackTerms(collision, trk);
+  for (int id = 0; id < o2::track::PID::NIDs; id++) {
+    if (speciesMask & (1u << id)) {
+      GetExpectedSignalAndSigma(terms, static_cast<o2::track::PID::ID>(id), expSignal[id], expSigma[id]);
+    }
+  }
+}
+
+/// Gets the number of sigmas for all mass hypotheses, -999 where the expected signal or resolution is invalid
+inline void Response::GetNumberOfSigmaAllSpecies(const float tpcSignal, const std::array<float, o2::track::PID::NIDs>& expSignal, const std::array<float, o2::track::PID::NIDs>& expSigma, std::array<float, o2::track::PID::NIDs>& nSigma)
+{
+  for (int id = 0; id < o2::track::PID::NIDs; id++) {
+    nSigma[id] = (expSigma[id] < 0.f || expSignal[id] < 0.f) ? -999.f : (tpcSignal - expSignal[id]) / expSigma[id];
   }
-  return ((mcTunedTPCSignal - GetExpectedSignal(trk, id)) / GetExpectedSigma(collision, trk, id));
 }
 
 /// Gets the deviation between the actual signal and the expected signal
@@ -189,10 +257,17 @@ inline float Response::GetSignalDelta(const TrackType& trk, const o2::track::PID
 inline float Response::GetRelativeResolutiondEdx(const float p, const float mass, const float charge, const float resol) const
 {
   const float bg = p / mass;
-  const float dEdx = o2::tpc::BetheBlochAleph(bg, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * std::pow(charge, mChargeFactor);
+  const float chargeFactor = std::pow(charge, mChargeFactor);
+  const float dEdx = o2::tpc::BetheBlochAleph(bg, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * chargeFactor;
+  return GetRelativeResolutiondEdx(p, mass, dEdx, chargeFactor, resol);
+}
+
+//// Same as above, with the expected dEdx (in MIP units) and charge factor of the hypothesis already computed
+inline float Response::GetRelativeResolutiondEdx(const float p, const float mass, const float dEdx, const float chargeFactor, const float resol) const
+{
   const float deltaP = resol * std::sqrt(dEdx);
   const float bgDelta = p * (1 + deltaP) / mass;
-  const float dEdx2 = o2::tpc::BetheBlochAleph(bgDelta, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * std::pow(charge, mChargeFactor);
+  const float dEdx2 = o2::tpc::BetheBlochAleph(bgDelta, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * chargeFactor;
   const float deltaRel = std::abs(dEdx2 - dEdx) / dEdx;
   return deltaRel;
 }
@@ -0,0 +1,213 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ProcessProfiler.h
+/// \brief Opt-in instrumentation of the process functions (or any other code section) of a task
+///
+/// For each instrumented section, the profiler records the number of calls, the wall time, the number of rows
+/// read and written and the change of the heap memory in use (glibc only). The sums are stored in the summary
+/// histogram ProcessProfiler/hSummary (sections vs quantities) of the task registry, the distribution of the wall
+/// time per call in ProcessProfiler/hWallTime, and a summary table is printed at the end of the processing.
+/// A section can be a process function, a Partition evaluation, a sliceBy call or a block of histogram fills.
+///
+/// Usage:
+///   init(config, registry, {"sectionA", "sectionB"}, initContext) in the task init,
+///   auto profile = profiler.measure(0, table.size()); at the beginning of the section,
+///   profile.addRowsOut(n); for the written rows. The section ends with the destruction of the scope object.
+/// When the profiler is disabled, measure() does nothing.
+
+#ifndef COMMON_CORE_PROCESSPROFILER_H_
+#define COMMON_CORE_PROCESSPROFILER_H_
+
+#include <Framework/CallbackService.h>
+#include <Framework/Configurable.h>
+#include <Framework/HistogramRegistry.h>
+#include <Framework/HistogramSpec.h>
+#include <Framework/InitContext.h>
+#include <Framework/Logger.h>
+
+#include <TH2.h>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define O2PHYSICS_PROCESSPROFILER_HEAP
+#endif
+
+namespace o2::common::core
+{
+
+/// Configurables of a ProcessProfiler, to be added to a task
+struct ProcessProfilerConfigurables : o2::framework::ConfigurableGroup {
+  std::string prefix = "processProfiler"; // JSON group name
+  o2::framework::Configurable<bool> enable{"enable", false, "record calls, wall time, rows and heap usage of the instrumented sections"};
+  o2::framework::Configurable<bool> recordHeap{"recordHeap", true, "record the change of the heap memory in use (glibc only, adds about a microsecond per call)"};
+};
+
+class ProcessProfiler
+{
+ public:
+  /// Quantities summed per section in the summary histogram
+  enum Quantity : int {
+    Calls = 0,   ///< number of calls
+    WallTime,    ///< wall time (ms)
+    RowsIn,      ///< rows read
+    RowsOut,     ///< rows written
+    HeapGrowth,  ///< increase of the heap memory in use (kB)
+    HeapRelease, ///< decrease of the heap memory in use (kB)
+    NQuantities
+  };
+
+  /// Measurement of one call of a section, ended by its destruction
+  class Scope
+  {
+   public:
+    Scope(ProcessProfiler* profiler, int section, int64_t rowsIn) : mProfiler(profiler), mSection(section), mRowsIn(rowsIn)
+    {
+      if (mProfiler) {
+        mHeapStart = mProfiler->heapInUse();
+        mStart = std::chrono::steady_clock::now();
+      }
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    ~Scope()
+    {
+      if (mProfiler) {
+        const double wallTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mStart).count();
+        mProfiler->record(mSection, wallTime, mRowsIn, mRowsOut, mProfiler->heapInUse() - mHeapStart);
+      }
+    }
+
+    /// Adds rows read by the section
+    void addRowsIn(int64_t n) { mRowsIn += n; }
+
+    /// Adds rows written by the section
+    void addRowsOut(int64_t n) { mRowsOut += n; }
+
+   private:
+    ProcessProfiler* mProfiler;
+    int mSection;
+    int64_t mRowsIn;
+    int64_t mRowsOut = 0;
+    int64_t mHeapStart = 0;
+    std::chrono::steady_clock::time_point mStart;
+  };
+
+  /// \param enable  whether the sections are measured
+  /// \param recordHeap  whether the change of the heap memory in use is recorded
+  /// \param registry  registry of the task, where the histograms are added
+  /// \param sections  names of the sections, measure() takes their index
+  void init(bool enable, bool recordHeap, o2::framework::HistogramRegistry& registry, std::vector<std::string> const& sections)
+  {
+    mEnabled = enable;
+    if (!mEnabled) {
+      return;
+    }
+#ifdef O2PHYSICS_PROCESSPROFILER_HEAP
+    mRecordHeap = recordHeap;
+#else
+    if (recordHeap) {
+      LOG(warning) << "ProcessProfiler: heap recording not available on this platform";
+    }
+#endif
+    mSections = sections;
+    mSums.assign(mSections.size(), {});
+    const int nSections = mSections.size();
+    hSummary = registry.add<TH2>("ProcessProfiler/hSummary", "process profiler summary;section;quantity", {o2::framework::HistType::kTH2D, {{nSections, -0.5, nSections - 0.5}, {NQuantities, -0.5, NQuantities - 0.5}}});
+    hWallTime = registry.add<TH2>("ProcessProfiler/hWallTime", "process profiler;section;log_{10}(wall time per call / #mus)", {o2::framework::HistType::kTH2F, {{nSections, -0.5, nSections - 0.5}, {90, -1., 8.}}});
+    for (int i = 0; i < nSections; i++) {
+      hSummary->GetXaxis()->SetBinLabel(i + 1, mSections[i].c_str());
+      hWallTime->GetXaxis()->SetBinLabel(i + 1, mSections[i].c_str());
+    }
+    const std::array<const char*, NQuantities> labels{"calls", "wall time (ms)", "rows in", "rows out", "heap growth (kB)", "heap release (kB)"};
+    for (int i = 0; i < NQuantities; i++) {
+      hSummary->GetYaxis()->SetBinLabel(i + 1, labels[i]);
+    }
+  }
+
+  /// Initialises the profiler from the task configurables and prints the summary at the end of the processing
+  void init(ProcessProfilerConfigurables const& config, o2::framework::HistogramRegistry& registry, std::vector<std::string> const& sections, o2::framework::InitContext& initContext)
+  {
+    init(config.enable, config.recordHeap, registry, sections);
+    if (mEnabled) {
+      initContext.services().get<o2::framework::CallbackService>().set<o2::framework::CallbackService::Id::Stop>([this]() { print(); });
+    }
+  }
+
+  bool isEnabled() const { return mEnabled; }
+
+  /// Starts the measurement of a call of a section
+  /// \param section  index of the section
+  /// \param rowsIn  number of rows read by the call, e.g. the size of the input table
+  Scope measure(int section, int64_t rowsIn = 0)
+  {
+    return Scope(mEnabled ? this : nullptr, section, rowsIn);
+  }
+
+  /// Prints the sums per section
+  void print() const
+  {
+    if (!mEnabled) {
+      return;
+    }
+    LOG(info) << "ProcessProfiler summary: section | calls | wall time (ms) | rows in | rows out | heap growth (kB) | heap release (kB)";
+    for (std::size_t i = 0; i < mSections.size(); i++) {
+      const auto& sums = mSums[i];
+      LOGF(info, "  %s | %.0f | %.3f | %.0f | %.0f | %.1f | %.1f", mSections[i], sums[Calls], sums[WallTime], sums[RowsIn], sums[RowsOut], sums[HeapGrowth], sums[HeapRelease]);
+    }
+  }
+
+ private:
+  /// Heap memory in use in bytes, 0 if not recorded
+  int64_t heapInUse() const
+  {
+#ifdef O2PHYSICS_PROCESSPROFILER_HEAP
+    if (mRecordHeap) {
+      const auto info = mallinfo2();
+      return static_cast<int64_t>(info.uordblks + info.hblkhd);
+    }
+#endif
+    return 0;
+  }
+
+  void record(int section, double wallTime, int64_t rowsIn, int64_t rowsOut, int64_t heapChange)
+  {
+    const std::array<double, NQuantities> values{1., wallTime, static_cast<double>(rowsIn), static_cast<double>(rowsOut),
+                                                 heapChange > 0 ? heapChange / 1024. : 0., heapChange < 0 ? -heapChange / 1024. : 0.};
+    auto& sums = mSums[section];
+    for (int i = 0; i < NQuantities; i++) {
+      sums[i] += values[i];
+      if (values[i] != 0.) {
+        hSummary->Fill(section, i, values[i]);
+      }
+    }
+    hWallTime->Fill(section, std::log10(wallTime * 1.e3 + 1.e-3));
+  }
+
+  bool mEnabled = false;
+  bool mRecordHeap = false;
+  std::vector<std::string> mSections;                 ///< section names
+  std::vector<std::array<double, NQuantities>> mSums; ///< sums per section
+  std::shared_ptr<TH2> hSummary;                      ///< sums per section and quantity
+  std::shared_ptr<TH2> hWallTime;                     ///< wall time per call per section
+};
+
+} // namespace o2::common::core
+
+#endif // COMMON_CORE_PROCESSPROFILER_H_
@@ -33,6 +33,9 @@
 // O2 includes
 #include "CommonConstants/MathConstants.h"
 
+// O2Physics includes
+#include "Common/Core/McAncestryIndex.h"
+
 /// Base class for calculating properties of reconstructed decays
 ///
 /// Provides static helper functions for:
@@ -46,6 +49,7 @@ struct RecoDecay {
   enum OriginType { None = 0,
                     Prompt,
                     NonPrompt };
+  static_assert(OriginType::Prompt == McAncestryIndex::OriginPrompt && OriginType::NonPrompt == McAncestryIndex::OriginNonPrompt, "Origin codes of McAncestryIndex must match OriginType");
 
   static constexpr int8_t StatusCodeAfterFlavourOscillation = 92; // decay products after B0(s) flavour oscillation
 
@@ -541,6 +545,7 @@ struct RecoDecay {
   /// \param acceptAntiParticles  switch to accept the antiparticle of the expected mother
   /// \param sign  antiparticle indicator of the found mother w.r.t. pdgMother; 1 if particle, -1 if antiparticle, 0 if mother not found
   /// \param depthMax  maximum decay tree level to check; Mothers up to this level will be considered. If -1, all levels are considered.
+  /// \param mcIndex  optional MC ancestry index of the DataFrame; if provided, the search runs on it
   /// \return index of the mother particle if found, -1 otherwise
   template <bool acceptFlavourOscillation = false, typename T>
   static int getMother(const T& particlesMC,
@@ -548,7 +553,8 @@ struct RecoDecay {
                        int pdgMother,
                        bool acceptAntiParticles = false,
                        int8_t* sign = nullptr,
-                       int8_t depthMax = -1)
+                       int8_t depthMax = -1,
+                       const McAncestryIndex* mcIndex = nullptr)
   {
     int8_t sgn = 0;           // 1 if the expected mother is particle, -1 if antiparticle (w.r.t. pdgMother)
     int indexMother = -1;     // index of the final matched mother, if found
@@ -558,47 +564,51 @@ struct RecoDecay {
       *sign = sgn;
     }
 
-    // vector of vectors with mother indices; each line corresponds to a "stage"
-    std::vector<std::vector<int64_t>> arrayIds{};
-    std::vector<int64_t> initVec{particle.globalIndex()};
-    arrayIds.push_back(initVec); // the first vector contains the index of the original particle
-
-    while (!motherFound && arrayIds[-stage].size() > 0 && (depthMax < 0 || -stage < depthMax)) {
-      // vector of mother indices for the current stage
-      std::vector<int64_t> arrayIdsStage{};
-      for (auto iPart : arrayIds[-stage]) { // check all the particles that were the mothers at the previous stage, o2-linter: disable=const-ref-in-for-loop (int elements)
-        auto particleMother = particlesMC.rawIteratorAt(iPart - particlesMC.offset());
-        if (particleMother.has_mothers()) {
-          for (auto iMother = particleMother.mothersIds().front(); iMother <= particleMother.mothersIds().back(); ++iMother) { // loop over the mother particles of the analysed particle
-            if (std::find(arrayIdsStage.begin(), arrayIdsStage.end(), iMother) != arrayIdsStage.end()) {                       // if a mother is still present in the vector, do not check it again
-              continue;
-            }
-            auto mother = particlesMC.rawIteratorAt(iMother - particlesMC.offset());
-            // Check mother's PDG code.
-            auto pdgParticleIMother = mother.pdgCode(); // PDG code of the mother
-            // printf("getMother: ");
-            // for (int i = stage; i < 0; i++) // Indent to make the tree look nice.
-            //   printf(" ");
-            // printf("Stage %d: Mother PDG: %d, Index: %d\n", stage, pdgParticleIMother, iMother);
-            if (pdgParticleIMother == pdgMother) { // exact PDG match
-              sgn = 1;
-              indexMother = iMother;
-              motherFound = true;
-              break;
-            } else if (acceptAntiParticles && pdgParticleIMother == -pdgMother) { // antiparticle PDG match
-              sgn = -1;
-              indexMother = iMother;
-              motherFound = true;
-              break;
+    if (mcIndex) {
+      indexMother = mcIndex->getMother(particle.globalIndex(), pdgMother, acceptAntiParticles, &sgn, depthMax);
+    } else {
+      // vector of vectors with mother indices; each line corresponds to a "stage"
+      std::vector<std::vector<int64_t>> arrayIds{};
+      std::vector<int64_t> initVec{particle.globalIndex()};
+      arrayIds.push_back(initVec); // the first vector contains the index of the original particle
+
+      while (!motherFound && arrayIds[-stage].size() > 0 && (depthMax < 0 || -stage < depthMax)) {
+        // vector of mother indices for the current stage
+        std::vector<int64_t> arrayIdsStage{};
+        for (auto iPart : arrayIds[-stage]) { // check all the particles that were the mothers at the previous stage, o2-linter: disable=const-ref-in-for-loop (int elements)
+          auto particleMother = particlesMC.rawIteratorAt(iPart - particlesMC.offset());
+          if (particleMother.has_mothers()) {
+            for (auto iMother = particleMother.mothersIds().front(); iMother <= particleMother.mothersIds().back(); ++iMother) { // loop over the mother particles of the analysed particle
+              if (std::find(arrayIdsStage.begin(), arrayIdsStage.end(), iMother) != arrayIdsStage.end()) {                       // if a mother is still present in the vector, do not check it again
+                continue;
+              }
+              auto mother = particlesMC.rawIteratorAt(iMother - particlesMC.offset());
+              // Check mother's PDG code.
+              auto pdgParticleIMother = mother.pdgCode(); // PDG code of the mother
+              // printf("getMother: ");
+              // for (int i = stage; i < 0; i++) // Indent to make the tree look nice.
+              //   printf(" ");
+              // printf("Stage %d: Mother PDG: %d, Index: %d\n", stage, pdgParticleIMother, iMother);
+              if (pdgParticleIMother == pdgMother) { // exact PDG match
+                sgn = 1;
+                indexMother = iMother;
+                motherFound = true;
+                break;
+              } else if (acceptAntiParticles && pdgParticleIMother == -pdgMother) { // antiparticle PDG match
+                sgn = -1;
+                indexMother = iMother;
+                motherFound = true;
+                break;
+              }
+              // add mother index in the vector for the current stage
+              arrayIdsStage.push_back(iMother);
             }
-            // add mother index in the vector for the current stage
-            arrayIdsStage.push_back(iMother);
           }
         }
+        // add vector of mother indices for the current stage
+        arrayIds.push_back(arrayIdsStage);
+        stage--;
       }
-      // add vector of mother indices for the current stage
-      arrayIds.push_back(arrayIdsStage);
-      stage--;
     }
     if (sign) {
       if constexpr (acceptFlavourOscillation) {
@@ -701,6 +711,7 @@ struct RecoDecay {
   /// \param nPiToMu  number of pion prongs decayed to a muon
   /// \param nKaToPi  number of kaon prongs decayed to a pion
   /// \param nInteractionsWithMaterial  number of daughter particles that interacted with material
+  /// \param mcIndex  optional MC ancestry index of the DataFrame; if provided, mother and daughter searches run on it
   /// \return index of the mother particle if the mother and daughters are correct, -1 otherwise
   template <bool acceptFlavourOscillation = false, bool checkProcess = false, bool acceptIncompleteReco = false, bool acceptTrackDecay = false, bool acceptTrackIntWithMaterial = false, std::size_t N, typename T, typename U>
   static int getMatchedMCRec(const T& particlesMC,
@@ -712,7 +723,8 @@ struct RecoDecay {
                              int depthMax = 1,
                              int8_t* nPiToMu = nullptr,
                              int8_t* nKaToPi = nullptr,
-                             int8_t* nInteractionsWithMaterial = nullptr)
+                             int8_t* nInteractionsWithMaterial = nullptr,
+                             const McAncestryIndex* mcIndex = nullptr)
   {
     // Printf("MC Rec: Expected mother PDG: %d", pdgMother);
     int8_t coefFlavourOscillation = 1;         // 1 if no B0(s) flavour oscillation occured, -1 else
@@ -787,28 +799,41 @@ struct RecoDecay {
       if (iProng == 0) {
         // Get the mother index and its sign.
         // PDG code of the first daughter's mother determines whether the expected mother is a particle or antiparticle.
-        indexMother = getMother(particlesMC, particleI, pdgMother, acceptAntiParticles, &sgn, depthMax);
+        indexMother = getMother(particlesMC, particleI, pdgMother, acceptAntiParticles, &sgn, depthMax, mcIndex);
         // Check whether mother was found.
         if (indexMother <= -1) {
           // Printf("MC Rec: Rejected: bad mother index or PDG");
           return -1;
         }
         // Printf("MC Rec: Good mother: %d", indexMother);
-        auto particleMother = particlesMC.rawIteratorAt(indexMother - particlesMC.offset());
-        // Check the daughter indices.
-        if (!particleMother.has_daughters()) {
-          // Printf("MC Rec: Rejected: bad daughter index range: %d-%d", particleMother.daughtersIds().front(), particleMother.daughtersIds().back());
-          return -1;
-        }
-        // Check that the number of direct daughters is not larger than the number of expected final daughters.
-        if constexpr (!acceptIncompleteReco && !checkProcess) {
-          if (particleMother.daughtersIds().back() - particleMother.daughtersIds().front() + 1 > static_cast<int>(N)) {
-            // Printf("MC Rec: Rejected: too many direct daughters: %d (expected %ld final)", particleMother.daughtersIds().back() - particleMother.daughtersIds().front() + 1, N);
+        if (mcIndex) {
+          // Check the daughter indices and their number, then get the list of actual final daughters.
+          if (!mcIndex->hasDaughters(indexMother)) {
+            return -1;
+          }
+          if constexpr (!acceptIncompleteReco && !checkProcess) {
+            if (mcIndex->nDaughters(indexMother) > static_cast<int>(N)) {
+              return -1;
+            }
+          }
+          mcIndex->getDaughters<checkProcess>(indexMother, &arrAllDaughtersIndex, arrPdgDaughters, depthMax);
+        } else {
+          auto particleMother = particlesMC.rawIteratorAt(indexMother - particlesMC.offset());
+          // Check the daughter indices.
+          if (!particleMother.has_daughters()) {
+            // Printf("MC Rec: Rejected: bad daughter index range: %d-%d", particleMother.daughtersIds().front(), particleMother.daughtersIds().back());
             return -1;
           }
+          // Check that the number of direct daughters is not larger than the number of expected final daughters.
+          if constexpr (!acceptIncompleteReco && !checkProcess) {
+            if (particleMother.daughtersIds().back() - particleMother.daughtersIds().front() + 1 > static_cast<int>(N)) {
+              // Printf("MC Rec: Rejected: too many direct daughters: %d (expected %ld final)", particleMother.daughtersIds().back() - particleMother.daughtersIds().front() + 1, N);
+              return -1;
+            }
+          }
+          // Get the list of actual final daughters.
+          getDaughters<checkProcess>(particleMother, &arrAllDaughtersIndex, arrPdgDaughters, depthMax);
         }
-        // Get the list of actual final daughters.
-        getDaughters<checkProcess>(particleMother, &arrAllDaughtersIndex, arrPdgDaughters, depthMax);
         // printf("MC Rec: Mother %d has %d final daughters:", indexMother, arrAllDaughtersIndex.size());
         // for (auto i : arrAllDaughtersIndex) {
         //   printf(" %d", i);
@@ -999,13 +1024,19 @@ struct RecoDecay {
   /// \param particle  MC particle
   /// \param searchUpToQuark if true tag origin based on charm/beauty quark otherwise on the presence of a b-hadron or c-hadron, with c-hadrons themselves marked as prompt
   /// \param idxBhadMothers optional vector of b-hadron indices (might be more than one in case of searchUpToQuark in case of beauty resonances)
+  /// \param mcIndex  optional MC ancestry index of the DataFrame; if provided, the (cached) search runs on it
   /// \return an integer corresponding to the origin (0: none, 1: prompt, 2: nonprompt) as in OriginType
   template <typename T>
   static int getCharmHadronOrigin(const T& particlesMC,
                                   const typename T::iterator& particle,
                                   const bool searchUpToQuark = false,
-                                  std::vector<int>* idxBhadMothers = nullptr)
+                                  std::vector<int>* idxBhadMothers = nullptr,
+                                  const McAncestryIndex* mcIndex = nullptr)
   {
+    if (mcIndex) {
+      return mcIndex->getCharmHadronOrigin(particle.globalIndex(), searchUpToQuark, idxBhadMothers);
+    }
+
     int stage = 0; // mother tree level (just for debugging)
 
     // vector of vectors with mother indices; each line corresponds to a "stage"
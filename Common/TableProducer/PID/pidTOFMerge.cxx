@@ -897,8 +897,11 @@ struct tofPidMerge {
   HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
 
   // Running variables
-  std::vector<int> mEnabledParticles;     // Vector of enabled PID hypotheses to loop on when making tables
-  std::vector<int> mEnabledParticlesFull; // Vector of enabled PID hypotheses to loop on when making full tables
+  std::vector<int> mEnabledParticles;                // Vector of enabled PID hypotheses to loop on when making tables
+  std::vector<int> mEnabledParticlesFull;            // Vector of enabled PID hypotheses to loop on when making full tables
+  uint32_t mEnabledSpeciesMask = 0;                  // Mask of the PID hypotheses enabled in tiny or full tables
+  std::array<float, o2::track::PID::NIDs> mExpSigma; // Per-track expected resolution of the enabled hypotheses
+  std::array<float, o2::track::PID::NIDs> mNSigma;   // Per-track nsigma of the enabled hypotheses
   void init(o2::framework::InitContext& initContext)
   {
     mTOFCalibConfig.inheritFromBaseTask(initContext);
@@ -909,6 +912,7 @@ struct tofPidMerge {
       enableFlagIfTableRequired(initContext, "pidTOF" + particleNames[i], f);
       if (f == 1) {
         mEnabledParticles.push_back(i);
+        mEnabledSpeciesMask |= (1u << i);
       }
 
       // Then checking full tables
@@ -916,6 +920,7 @@ struct tofPidMerge {
       enableFlagIfTableRequired(initContext, "pidTOFFull" + particleNames[i], f);
       if (f == 1) {
         mEnabledParticlesFull.push_back(i);
+        mEnabledSpeciesMask |= (1u << i);
       }
     }
     if (mEnabledParticlesFull.size() == 0 && mEnabledParticles.size() == 0) {
@@ -1150,21 +1155,11 @@ struct tofPidMerge {
 
   void process(aod::BCs const&) {}
 
-  template <o2::track::PID::ID pid>
-  using ResponseImplementation = o2::pid::tof::ExpTimes<Run3TrksWtofWevTime::iterator, pid>;
   void processRun3(Run3TrksWtofWevTime const& tracks,
                    Run3Cols const&,
                    aod::BCsWithTimestamps const& bcs)
   {
-    constexpr auto responseEl = ResponseImplementation<PID::Electron>();
-    constexpr auto responseMu = ResponseImplementation<PID::Muon>();
-    constexpr auto responsePi = ResponseImplementation<PID::Pion>();
-    constexpr auto responseKa = ResponseImplementation<PID::Kaon>();
-    constexpr auto responsePr = ResponseImplementation<PID::Proton>();
-    constexpr auto responseDe = ResponseImplementation<PID::Deuteron>();
-    constexpr auto responseTr = ResponseImplementation<PID::Triton>();
-    constexpr auto responseHe = ResponseImplementation<PID::Helium3>();
-    constexpr auto responseAl = ResponseImplementation<PID::Alpha>();
+    using ResponseAllSpecies = o2::pid::tof::ExpTimesAllSpecies<Run3TrksWtofWevTime::iterator>;
 
     mTOFCalibConfig.processSetup(mRespParamsV3, ccdb, bcs.iteratorAt(0)); // Update the calibration parameters
 
@@ -1189,50 +1184,45 @@ struct tofPidMerge {
         continue;
       }
 
+      // Resolution and nsigma of all enabled hypotheses, the species-independent terms are computed once per track
+      ResponseAllSpecies::GetExpectedSigmaAndSeparation(mRespParamsV3, trk, mEnabledSpeciesMask, mExpSigma, mNSigma);
+
       for (auto const& pidId : mEnabledParticles) { // Loop on enabled particle hypotheses
+        nsigma = mNSigma[pidId];
         switch (pidId) {
           case kIdxEl: {
-            nsigma = responseEl.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDEl);
             break;
           }
           case kIdxMu: {
-            nsigma = responseMu.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDMu);
             break;
           }
           case kIdxPi: {
-            nsigma = responsePi.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDPi);
             break;
           }
           case kIdxKa: {
-            nsigma = responseKa.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDKa);
             break;
           }
           case kIdxPr: {
-            nsigma = responsePr.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDPr);
             break;
           }
           case kIdxDe: {
-            nsigma = responseDe.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDDe);
             break;
           }
           case kIdxTr: {
-            nsigma = responseTr.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDTr);
             break;
           }
           case kIdxHe: {
-            nsigma = responseHe.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDHe);
             break;
           }
           case kIdxAl: {
-            nsigma = responseAl.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDAl);
             break;
           }
@@ -1245,58 +1235,42 @@ struct tofPidMerge {
         }
       }
       for (auto const& pidId : mEnabledParticlesFull) { // Loop on enabled particle hypotheses with full tables
+        resolution = mExpSigma[pidId];
+        nsigma = mNSigma[pidId];
         switch (pidId) {
           case kIdxEl: {
-            resolution = responseEl.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responseEl.GetSeparation(mRespParamsV3, trk, resolution);
             tablePIDFullEl(resolution, nsigma);
             break;
           }
           case kIdxMu: {
-            resolution = responseMu.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responseMu.GetSeparation(mRespParamsV3, trk, resolution);
             tablePIDFullMu(resolution, nsigma);
             break;
           }
           case kIdxPi: {
-            resolution = responsePi.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responsePi.GetSeparation(mRespParamsV3, trk);
             tablePIDFullPi(resolution, nsigma);
             break;
           }
           case kIdxKa: {
-            resolution = responseKa.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responseKa.GetSeparation(mRespParamsV3, trk, resolution);
             tablePIDFullKa(resolution, nsigma);
             break;
           }
           case kIdxPr: {
-            resolution = responsePr.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responsePr.GetSeparation(mRespParamsV3, trk, resolution);
             tablePIDFullPr(resolution, nsigma);
             break;
           }
           case kIdxDe: {
-            resolution = responseDe.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responseDe.GetSeparation(mRespParamsV3, trk, resolution);
             tablePIDFullDe(resolution, nsigma);
             break;
           }
           case kIdxTr: {
-            resolution = responseTr.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responseTr.GetSeparation(mRespParamsV3, trk, resolution);
             tablePIDFullTr(resolution, nsigma);
             break;
           }
           case kIdxHe: {
-            resolution = responseHe.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responseHe.GetSeparation(mRespParamsV3, trk, resolution);
             tablePIDFullHe(resolution, nsigma);
             break;
           }
           case kIdxAl: {
-            resolution = responseAl.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responseAl.GetSeparation(mRespParamsV3, trk, resolution);
             tablePIDFullAl(resolution, nsigma);
             break;
           }
@@ -1312,21 +1286,11 @@ struct tofPidMerge {
   }
   PROCESS_SWITCH(tofPidMerge, processRun3, "Produce Run 3 Nsigma table. Set to off if the tables are not required, or autoset is on", false);
 
-  template <o2::track::PID::ID pid>
-  using ResponseImplementationRun2 = o2::pid::tof::ExpTimes<Run2TrksWtofWevTime::iterator, pid>;
   void processRun2(Run2TrksWtofWevTime const& tracks,
                    Run3Cols const&,
                    aod::BCsWithTimestamps const& bcs)
   {
-    constexpr auto responseEl = ResponseImplementationRun2<PID::Electron>();
-    constexpr auto responseMu = ResponseImplementationRun2<PID::Muon>();
-    constexpr auto responsePi = ResponseImplementationRun2<PID::Pion>();
-    constexpr auto responseKa = ResponseImplementationRun2<PID::Kaon>();
-    constexpr auto responsePr = ResponseImplementationRun2<PID::Proton>();
-    constexpr auto responseDe = ResponseImplementationRun2<PID::Deuteron>();
-    constexpr auto responseTr = ResponseImplementationRun2<PID::Triton>();
-    constexpr auto responseHe = ResponseImplementationRun2<PID::Helium3>();
-    constexpr auto responseAl = ResponseImplementationRun2<PID::Alpha>();
+    using ResponseAllSpecies = o2::pid::tof::ExpTimesAllSpecies<Run2TrksWtofWevTime::iterator>;
 
     mTOFCalibConfig.processSetup(mRespParamsV3, ccdb, bcs.iteratorAt(0)); // Update the calibration parameters
 
@@ -1351,50 +1315,45 @@ struct tofPidMerge {
         continue;
       }
 
+      // Resolution and nsigma of all enabled hypotheses, the species-independent terms are computed once per track
+      ResponseAllSpecies::GetExpectedSigmaAndSeparation(mRespParamsV3, trk, mEnabledSpeciesMask, mExpSigma, mNSigma);
+
       for (auto const& pidId : mEnabledParticles) { // Loop on enabled particle hypotheses
+        nsigma = mNSigma[pidId];
         switch (pidId) {
           case kIdxEl: {
-            nsigma = responseEl.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDEl);
             break;
           }
           case kIdxMu: {
-            nsigma = responseMu.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDMu);
             break;
           }
           case kIdxPi: {
-            nsigma = responsePi.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDPi);
             break;
           }
           case kIdxKa: {
-            nsigma = responseKa.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDKa);
             break;
           }
           case kIdxPr: {
-            nsigma = responsePr.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDPr);
             break;
           }
           case kIdxDe: {
-            nsigma = responseDe.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDDe);
             break;
           }
           case kIdxTr: {
-            nsigma = responseTr.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDTr);
             break;
           }
           case kIdxHe: {
-            nsigma = responseHe.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDHe);
             break;
           }
           case kIdxAl: {
-            nsigma = responseAl.GetSeparation(mRespParamsV3, trk);
             aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDAl);
             break;
           }
@@ -1407,58 +1366,42 @@ struct tofPidMerge {
         }
       }
       for (auto const& pidId : mEnabledParticlesFull) { // Loop on enabled particle hypotheses with full tables
+        resolution = mExpSigma[pidId];
+        nsigma = mNSigma[pidId];
         switch (pidId) {
           case kIdxEl: {
-            resolution = responseEl.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responseEl.GetSeparation(mRespParamsV3, trk, resolution);
             tablePIDFullEl(resolution, nsigma);
             break;
           }
           case kIdxMu: {
-            resolution = responseMu.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responseMu.GetSeparation(mRespParamsV3, trk, resolution);
             tablePIDFullMu(resolution, nsigma);
             break;
           }
           case kIdxPi: {
-            resolution = responsePi.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responsePi.GetSeparation(mRespParamsV3, trk);
             tablePIDFullPi(resolution, nsigma);
             break;
           }
           case kIdxKa: {
-            resolution = responseKa.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responseKa.GetSeparation(mRespParamsV3, trk, resolution);
             tablePIDFullKa(resolution, nsigma);
             break;
           }
           case kIdxPr: {
-            resolution = responsePr.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responsePr.GetSeparation(mRespParamsV3, trk, resolution);
             tablePIDFullPr(resolution, nsigma);
             break;
           }
           case kIdxDe: {
-            resolution = responseDe.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responseDe.GetSeparation(mRespParamsV3, trk, resolution);
             tablePIDFullDe(resolution, nsigma);
             break;
           }
           case kIdxTr: {
-            resolution = responseTr.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responseTr.GetSeparation(mRespParamsV3, trk, resolution);
             tablePIDFullTr(resolution, nsigma);
             break;
           }
           case kIdxHe: {
-            resolution = responseHe.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responseHe.GetSeparation(mRespParamsV3, trk, resolution);
             tablePIDFullHe(resolution, nsigma);
             break;
           }
           case kIdxAl: {
-            resolution = responseAl.GetExpectedSigma(mRespParamsV3, trk);
-            nsigma = responseAl.GetSeparation(mRespParamsV3, trk, resolution);
             tablePIDFullAl(resolution, nsigma);
             break;
           }
@@ -18,6 +18,7 @@
 /// \brief  Task to produce PID tables for TPC split for each particle.
 ///         Only the tables for the mass hypotheses requested are filled, and only for the requested table size ("Full" or "Tiny"). The others are sent empty.
 ///
+#include <array>
 #include <utility>
 #include <map>
 #include <memory>
@@ -93,6 +94,10 @@ struct tpcPid {
 
   // TPC PID Response
   o2::pid::tpc::Response* response;
+  // Per-track expected signals, resolutions and number of sigmas of all mass hypotheses
+  std::array<float, o2::track::PID::NIDs> expSignals;
+  std::array<float, o2::track::PID::NIDs> expSigmas;
+  std::array<float, o2::track::PID::NIDs> nSigmas;
 
   // Network correction for TPC PID response
   OnnxModel network;
@@ -398,8 +403,29 @@ struct tpcPid {
     return network_prediction;
   }
 
-  template <typename C, typename T, typename NSF, typename NST>
-  void makePidTables(const int flagFull, NSF& tableFull, const int flagTiny, NST& tableTiny, const o2::track::PID::ID pid, const float tpcSignal, const T& trk, const C& collisions, const std::vector<float>& network_prediction, const int& count_tracks, const int& tracksForNet_size)
+  /// Mask of the mass hypotheses for which at least one table is produced
+  uint32_t enabledSpeciesMask() const
+  {
+    const std::array<bool, o2::track::PID::NIDs> enabled{pidFullEl == 1 || pidTinyEl == 1,
+                                                         pidFullMu == 1 || pidTinyMu == 1,
+                                                         pidFullPi == 1 || pidTinyPi == 1,
+                                                         pidFullKa == 1 || pidTinyKa == 1,
+                                                         pidFullPr == 1 || pidTinyPr == 1,
+                                                         pidFullDe == 1 || pidTinyDe == 1,
+                                                         pidFullTr == 1 || pidTinyTr == 1,
+                                                         pidFullHe == 1 || pidTinyHe == 1,
+                                                         pidFullAl == 1 || pidTinyAl == 1};
+    uint32_t mask = 0;
+    for (int id = 0; id < o2::track::PID::NIDs; id++) {
+      if (enabled[id]) {
+        mask |= (1u << id);
+      }
+    }
+    return mask;
+  }
+
+  template <typename T, typename NSF, typename NST>
+  void makePidTables(const int flagFull, NSF& tableFull, const int flagTiny, NST& tableTiny, const o2::track::PID::ID pid, const float tpcSignal, const T& trk, const std::vector<float>& network_prediction, const int& count_tracks, const int& tracksForNet_size)
   {
     if (flagFull != 1 && flagTiny != 1) {
       return;
@@ -420,9 +446,9 @@ struct tpcPid {
         return;
       }
     }
-    auto expSignal = response->GetExpectedSignal(trk, pid);
-    auto expSigma = trk.has_collision() ? response->GetExpectedSigma(collisions.iteratorAt(trk.collisionId()), trk, pid) : 0.07 * expSignal; // use default sigma value of 7% if no collision information to estimate resolution
-    if (expSignal < 0. || expSigma < 0.) {                                                                                                   // skip if expected signal invalid
+    auto expSignal = expSignals[pid];
+    auto expSigma = trk.has_collision() ? expSigmas[pid] : 0.07 * expSignal; // use default sigma value of 7% if no collision information to estimate resolution
+    if (expSignal < 0. || expSigma < 0.) {                                   // skip if expected signal invalid
       if (flagFull)
         tableFull(-999.f, -999.f);
       if (flagTiny)
@@ -453,7 +479,7 @@ struct tpcPid {
         LOGF(fatal, "Network output-dimensions incompatible!");
       }
     } else {
-      nSigma = response->GetNumberOfSigmaMCTuned(collisions.iteratorAt(trk.collisionId()), trk, pid, tpcSignal);
+      nSigma = nSigmas[pid];
     }
     if (flagFull)
       tableFull(expSigma, nSigma);
@@ -502,6 +528,7 @@ struct tpcPid {
     }
 
     uint64_t count_tracks = 0;
+    const uint32_t speciesMask = enabledSpeciesMask();
 
     for (auto const& trk : tracks) {
       // Loop on Tracks
@@ -527,8 +554,14 @@ struct tpcPid {
         response->PrintAll();
       }
 
-      auto makePidTablesDefault = [&trk, &collisions, &network_prediction, &count_tracks, &tracksForNet_size, this](const int flagFull, auto& tableFull, const int flagTiny, auto& tableTiny, const o2::track::PID::ID pid) {
-        makePidTables(flagFull, tableFull, flagTiny, tableTiny, pid, trk.tpcSignal(), trk, collisions, network_prediction, count_tracks, tracksForNet_size);
+      // Expected signals, resolutions and number of sigmas of the enabled mass hypotheses, computed in one pass
+      if (trk.hasTPC() && trk.tpcSignal() >= 0.f && (!skipTPCOnly || trk.hasITS() || trk.hasTRD() || trk.hasTOF())) {
+        response->GetExpectedSignalAndSigmaAllSpecies(collisions.iteratorAt(trk.collisionId()), trk, expSignals, expSigmas, speciesMask);
+        o2::pid::tpc::Response::GetNumberOfSigmaAllSpecies(trk.tpcSignal(), expSignals, expSigmas, nSigmas);
+      }
+
+      auto makePidTablesDefault = [&trk, &network_prediction, &count_tracks, &tracksForNet_size, this](const int flagFull, auto& tableFull, const int flagTiny, auto& tableTiny, const o2::track::PID::ID pid) {
+        makePidTables(flagFull, tableFull, flagTiny, tableTiny, pid, trk.tpcSignal(), trk, network_prediction, count_tracks, tracksForNet_size);
       };
 
       makePidTablesDefault(pidFullEl, tablePIDFullEl, pidTinyEl, tablePIDTinyEl, o2::track::PID::Electron);
@@ -595,6 +628,7 @@ struct tpcPid {
     }
 
     uint64_t count_tracks = 0;
+    const uint32_t speciesMask = enabledSpeciesMask();
 
     for (auto const& trk : tracksMc) {
       // Loop on Tracks
@@ -628,8 +662,10 @@ struct tpcPid {
         }
         int pid = getPIDIndex(trk.mcParticle().pdgCode());
 
-        auto expSignal = response->GetExpectedSignal(trk, pid);
-        auto expSigma = response->GetExpectedSigma(collisionsMc.iteratorAt(trk.collisionId()), trk, pid);
+        // Expected values of the enabled hypotheses and of the true species, reused for the nsigma tables
+        response->GetExpectedSignalAndSigmaAllSpecies(collisionsMc.iteratorAt(trk.collisionId()), trk, expSignals, expSigmas, speciesMask | (1u << pid));
+        auto expSignal = expSignals[pid];
+        auto expSigma = expSigmas[pid];
         if (expSignal < 0. || expSigma < 0.) { // if expectation invalid then give undefined signal
           mcTunedTPCSignal = -999.f;
         }
@@ -652,8 +688,12 @@ struct tpcPid {
 
       // Check and fill enabled nsigma tables
 
-      auto makePidTablesMCTune = [&trk, &collisionsMc, &network_prediction, &count_tracks, &tracksForNet_size, &mcTunedTPCSignal, this](const int flagFull, auto& tableFull, const int flagTiny, auto& tableTiny, const o2::track::PID::ID pid) {
-        makePidTables(flagFull, tableFull, flagTiny, tableTiny, pid, mcTunedTPCSignal, trk, collisionsMc, network_prediction, count_tracks, tracksForNet_size);
+      if (trk.hasTPC() && mcTunedTPCSignal >= 0.f && (!skipTPCOnly || trk.hasITS() || trk.hasTRD() || trk.hasTOF())) {
+        o2::pid::tpc::Response::GetNumberOfSigmaAllSpecies(mcTunedTPCSignal, expSignals, expSigmas, nSigmas);
+      }
+
+      auto makePidTablesMCTune = [&trk, &network_prediction, &count_tracks, &tracksForNet_size, &mcTunedTPCSignal, this](const int flagFull, auto& tableFull, const int flagTiny, auto& tableTiny, const o2::track::PID::ID pid) {
+        makePidTables(flagFull, tableFull, flagTiny, tableTiny, pid, mcTunedTPCSignal, trk, network_prediction, count_tracks, tracksForNet_size);
       };
 
       makePidTablesMCTune(pidFullEl, tablePIDFullEl, pidTinyEl, tablePIDTinyEl, o2::track::PID::Electron);
@@ -8,13 +8,17 @@
 // In applying this license CERN does not waive the privileges and immunities
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
+#include <algorithm>
+#include <cmath>
 #include <map>
+#include <optional>
 #include <string>
 #include <unordered_set>
 #include <unordered_map>
 #include <vector>
 
 #include "CCDB/BasicCCDBManager.h"
+#include "Common/Core/CollisionPlaneGrid.h"
 #include "Common/DataModel/MatchMFTFT0.h"
 #include "Common/DataModel/MatchMFTMuonData.h"
 #include "DataFormatsGlobalTracking/RecoContainer.h"
@@ -100,6 +104,8 @@ struct match_mft_mch_data_mc {
   ///    Variables to add preselection for the matching table
   Configurable<float> fPreselectMatchingX{"cfgPreselectMatchingX", 15.f, ""};
   Configurable<float> fPreselectMatchingY{"cfgPreselectMatchingY", 15.f, ""};
+  Configurable<float> fCandidateSearchMargin{"cfgCandidateSearchMargin", -1.f, "margin (cm) added to the preselection window for the grid search of the MFT candidates of a muon, approximate and can lose pairs close to the window edges; negative to pair each muon with all MFT tracks"};
+  Configurable<float> fCandidateGridCellSize{"cfgCandidateGridCellSize", 10.f, "cell size (cm) of the grid of the MFT tracks at the matching plane"};
 
   ///    Variables to event mixing criteria
   Configurable<float> fSaveMixedMatchingParamsRate{"cfgSaveMixedMatchingParamsRate", 0.002f, ""};
@@ -250,36 +256,33 @@ struct match_mft_mch_data_mc {
 
     inline o2::track::TrackParCovFwd propagateMFTtoMatchingPlane()
     {
-      double covArr[15]{0.0};
-      SMatrix55 tmftcovs(covArr, covArr + 15);
-
-      SMatrix5 tmftpars(mfttrack.x(), mfttrack.y(), mfttrack.phi(), mfttrack.tgl(), mfttrack.signed1Pt());
-      o2::track::TrackParCovFwd extrap_mfttrack{mfttrack.z(), tmftpars, tmftcovs, mfttrack.chi2()};
-
-      double propVec[3] = {0.};
-      float zPlane = 0.f;
       if (mMatchingType == MCH_FIRST_CLUSTER) {
-        propVec[0] = muontrack.x() - mfttrack.x();
-        propVec[1] = muontrack.y() - mfttrack.y();
-        propVec[2] = muontrack.z() - mfttrack.z();
-        zPlane = muontrack.z();
+        return propagateMFTtoPoint(mfttrack, muontrack.x(), muontrack.y(), muontrack.z(), fieldB);
       } else if (mMatchingType == END_OF_ABSORBER || mMatchingType == BEGINING_OF_ABSORBER) {
         auto extrap_muontrack = propagateMUONtoMatchingPlane();
-        propVec[0] = extrap_muontrack.getX() - mfttrack.x();
-        propVec[1] = extrap_muontrack.getY() - mfttrack.y();
-        propVec[2] = extrap_muontrack.getZ() - mfttrack.z();
-        zPlane = (mMatchingType == END_OF_ABSORBER) ? -505.f : -90.f;
-      } else {
-        zPlane = mfttrack.z();
+        return propagateMFTtoPoint(mfttrack, extrap_muontrack.getX(), extrap_muontrack.getY(), extrap_muontrack.getZ(), fieldB);
       }
-
-      double centerZ[3] = {mfttrack.x() + propVec[0] / 2., mfttrack.y() + propVec[1] / 2., mfttrack.z() + propVec[2] / 2.};
-      float Bz = fieldB->getBz(centerZ);
-      extrap_mfttrack.propagateToZ(zPlane, Bz); // z in cm
-      return extrap_mfttrack;
+      return propagateMFTtoPoint(mfttrack, mfttrack.x(), mfttrack.y(), mfttrack.z(), fieldB);
     }
 
     inline o2::dataformats::GlobalFwdTrack propagateMUONtoMatchingPlane()
+    {
+      if (mMatchingType == MFT_LAST_CLUSTR) {
+        return propagateMUONtoZ(muontrack, mfttrack.z());
+      } else if (mMatchingType == END_OF_ABSORBER) {
+        return propagateMUONtoZ(muontrack, -505.);
+      } else if (mMatchingType == BEGINING_OF_ABSORBER) {
+        return propagateMUONtoZ(muontrack, -90.);
+      }
+      return propagateMUONtoZ(muontrack, std::nullopt);
+    }
+
+    inline o2::track::TrackParCovFwd propagateMFTtoDCA()
+    {
+      return propagateMFTtoPoint(mfttrack, collision.posX(), collision.posY(), collision.posZ(), fieldB);
+    }
+
+    inline o2::dataformats::GlobalFwdTrack propagateMUONtoPV()
     {
       float cov[15] = {
         muontrack.cXX(), muontrack.cXY(), muontrack.cYY(),
@@ -300,25 +303,25 @@ struct match_mft_mch_data_mc {
       gtrack.setCovariances(tcovs);
 
       auto mchtrack = mMatching.FwdtoMCH(gtrack);
-
-      if (mMatchingType == MFT_LAST_CLUSTR) {
-        o2::mch::TrackExtrap::extrapToVertexWithoutBranson(mchtrack, mfttrack.z());
-      } else if (mMatchingType == END_OF_ABSORBER) {
-        o2::mch::TrackExtrap::extrapToVertexWithoutBranson(mchtrack, -505.);
-      } else if (mMatchingType == BEGINING_OF_ABSORBER) {
-        o2::mch::TrackExtrap::extrapToVertexWithoutBranson(mchtrack, -90.);
-      }
+      o2::mch::TrackExtrap::extrapToVertex(mchtrack, collision.posX(), collision.posY(), collision.posZ(), collision.covXX(), collision.covYY());
 
       auto fwdtrack = mMatching.MCHtoFwd(mchtrack);
-
       o2::dataformats::GlobalFwdTrack extrap_muontrack;
       extrap_muontrack.setParameters(fwdtrack.getParameters());
       extrap_muontrack.setZ(fwdtrack.getZ());
       extrap_muontrack.setCovariances(fwdtrack.getCovariances());
+
       return extrap_muontrack;
     }
 
-    inline o2::track::TrackParCovFwd propagateMFTtoDCA()
+   public:
+    enum MATCHING_TYPE { MCH_FIRST_CLUSTER,
+                         MFT_LAST_CLUSTR,
+                         END_OF_ABSORBER,
+                         BEGINING_OF_ABSORBER };
+
+    // MFT track propagated to the z of the point (x, y, z), with the field at the middle of the segment to the point
+    static o2::track::TrackParCovFwd propagateMFTtoPoint(MFT const& mfttrack, double x, double y, double z, o2::field::MagneticField* field)
     {
       double covArr[15]{0.0};
       SMatrix55 tmftcovs(covArr, covArr + 15);
@@ -326,18 +329,15 @@ struct match_mft_mch_data_mc {
       SMatrix5 tmftpars(mfttrack.x(), mfttrack.y(), mfttrack.phi(), mfttrack.tgl(), mfttrack.signed1Pt());
       o2::track::TrackParCovFwd extrap_mfttrack{mfttrack.z(), tmftpars, tmftcovs, mfttrack.chi2()};
 
-      double propVec[3] = {};
-      propVec[0] = collision.posX() - mfttrack.x();
-      propVec[1] = collision.posY() - mfttrack.y();
-      propVec[2] = collision.posZ() - mfttrack.z();
-
+      double propVec[3] = {x - mfttrack.x(), y - mfttrack.y(), z - mfttrack.z()};
       double centerZ[3] = {mfttrack.x() + propVec[0] / 2., mfttrack.y() + propVec[1] / 2., mfttrack.z() + propVec[2] / 2.};
-      float Bz = fieldB->getBz(centerZ);
-      extrap_mfttrack.propagateToZ(collision.posZ(), Bz); // z in cm
+      float Bz = field->getBz(centerZ);
+      extrap_mfttrack.propagateToZ(z, Bz); // z in cm
       return extrap_mfttrack;
     }
 
-    inline o2::dataformats::GlobalFwdTrack propagateMUONtoPV()
+    // muon track extrapolated to z without Branson correction, or left at its first MCH cluster without z
+    static o2::dataformats::GlobalFwdTrack propagateMUONtoZ(MUON const& muontrack, std::optional<double> z)
     {
       float cov[15] = {
         muontrack.cXX(), muontrack.cXY(), muontrack.cYY(),
@@ -357,24 +357,22 @@ struct match_mft_mch_data_mc {
       gtrack.setZ(parcovmuontrack.getZ());
       gtrack.setCovariances(tcovs);
 
+      o2::globaltracking::MatchGlobalFwd mMatching;
       auto mchtrack = mMatching.FwdtoMCH(gtrack);
-      o2::mch::TrackExtrap::extrapToVertex(mchtrack, collision.posX(), collision.posY(), collision.posZ(), collision.covXX(), collision.covYY());
+
+      if (z) {
+        o2::mch::TrackExtrap::extrapToVertexWithoutBranson(mchtrack, *z);
+      }
 
       auto fwdtrack = mMatching.MCHtoFwd(mchtrack);
+
       o2::dataformats::GlobalFwdTrack extrap_muontrack;
       extrap_muontrack.setParameters(fwdtrack.getParameters());
       extrap_muontrack.setZ(fwdtrack.getZ());
       extrap_muontrack.setCovariances(fwdtrack.getCovariances());
-
       return extrap_muontrack;
     }
 
-   public:
-    enum MATCHING_TYPE { MCH_FIRST_CLUSTER,
-                         MFT_LAST_CLUSTR,
-                         END_OF_ABSORBER,
-                         BEGINING_OF_ABSORBER };
-
     MatchingParamsML(MUON const& muon, MFT const& mft, Collision const& coll, int MType, o2::field::MagneticField* field) : muontrack(muon), mfttrack(mft), collision(coll), mDX(0.f), mDY(0.f), mDPt(0.f), mDPhi(0.f), mDEta(0.f), mGlobalMuonPtAtDCA(0.f), mGlobalMuonEtaAtDCA(0.f), mGlobalMuonPhiAtDCA(0.f), mGlobalMuonDCAx(0.f), mGlobalMuonDCAy(0.f), mGlobalMuonQ(0.f), mMatchingType(MType), fieldB(field) {}
     void calcMatchingParams()
     {
@@ -606,6 +604,116 @@ struct match_mft_mch_data_mc {
     }
   }
 
+  using MatchingParams = MatchingParamsML<MyMUON, MyMFT, MyCollision>;
+
+  // Box of the MFT candidates of a muon in the grid of the MFT tracks at the reference plane
+  struct GridQuery {
+    float x;
+    float y;
+    float halfWidthX;
+    float halfWidthY;
+  };
+
+  o2::common::core::CollisionPlaneGrid mftPlaneGrid; // selected MFT tracks at the reference plane, per collision
+  float mftGridZ = 0.f;                              // z of the reference plane
+  float mftGridMaxSlope = 0.f;                       // maximum |dx/dz| and |dy/dz| of the MFT tracks at the reference plane
+  float mftGridMaxDz = 0.f;                          // maximum distance in z between the MFT tracks and the reference plane
+  unordered_map<int64_t, GridQuery> map_muonGridQuery;
+  vector<int> gridPositions;
+
+  inline bool useCandidateGrid() const
+  {
+    return fCandidateSearchMargin >= 0.f && fMatchingMethod >= MatchingParams::MCH_FIRST_CLUSTER && fMatchingMethod <= MatchingParams::BEGINING_OF_ABSORBER;
+  }
+
+  // Fills the grid of the selected MFT tracks at the reference plane of the matching method, and the box of the MFT candidates of each selected muon.
+  // The box is the preselection window, widened by the search margin and by the distance between the reference plane and the matching plane of the pair.
+  template <typename MUONs, typename MFTs>
+  void setCandidateGrid(MUONs const& muontracks, MFTs const& mfttracks, o2::field::MagneticField* field)
+  {
+    mftPlaneGrid.clear();
+    map_muonGridQuery.clear();
+    if (!useCandidateGrid())
+      return;
+
+    auto averageZ = [](auto const& map_tracks, auto const& tracks) {
+      double sumZ = 0.;
+      int nTracks = 0;
+      for (auto const& map_track : map_tracks) {
+        for (auto const& itrack : map_track.second) {
+          sumZ += tracks.rawIteratorAt(itrack).z();
+          ++nTracks;
+        }
+      }
+      return nTracks ? static_cast<float>(sumZ / nTracks) : 0.f;
+    };
+    if (fMatchingMethod == MatchingParams::MCH_FIRST_CLUSTER) {
+      mftGridZ = averageZ(map_muontracks, muontracks);
+    } else if (fMatchingMethod == MatchingParams::MFT_LAST_CLUSTR) {
+      mftGridZ = averageZ(map_mfttracks, mfttracks);
+    } else {
+      mftGridZ = (fMatchingMethod == MatchingParams::END_OF_ABSORBER) ? -505.f : -90.f;
+    }
+
+    mftGridMaxSlope = 0.f;
+    mftGridMaxDz = 0.f;
+    for (auto const& map_mfttrack : map_mfttracks) {
+      for (auto const& imfttrack : map_mfttrack.second) {
+        auto const& mfttrack = mfttracks.rawIteratorAt(imfttrack);
+        // field at the middle of the straight line to the plane, close to the middle of the MFT-muon segment used in the matching
+        double dz = mftGridZ - mfttrack.z();
+        auto mfttrack_at_plane = MatchingParams::propagateMFTtoPoint(mfttrack, mfttrack.x() + std::cos(mfttrack.phi()) / mfttrack.tgl() * dz,
+                                                                     mfttrack.y() + std::sin(mfttrack.phi()) / mfttrack.tgl() * dz, mftGridZ, field);
+        mftPlaneGrid.add(map_mfttrack.first, mfttrack_at_plane.getX(), mfttrack_at_plane.getY(), imfttrack);
+        float tanl = std::abs(mfttrack_at_plane.getTanl());
+        mftGridMaxSlope = std::max({mftGridMaxSlope, std::abs(std::cos(mfttrack_at_plane.getPhi())) / tanl, std::abs(std::sin(mfttrack_at_plane.getPhi())) / tanl});
+        mftGridMaxDz = std::max(mftGridMaxDz, std::abs(mfttrack.z() - mftGridZ));
+      }
+    }
+    mftPlaneGrid.build(fCandidateGridCellSize);
+
+    for (auto const& map_muontrack : map_muontracks) {
+      for (auto const& imuontrack : map_muontrack.second) {
+        auto const& muontrack = muontracks.rawIteratorAt(imuontrack);
+        GridQuery query{muontrack.x(), muontrack.y(), 0.f, 0.f};
+        float extraWidth = 0.f;
+        if (fMatchingMethod == MatchingParams::MCH_FIRST_CLUSTER) {
+          // pairs compared at the muon z
+          extraWidth = mftGridMaxSlope * std::abs(muontrack.z() - mftGridZ);
+        } else {
+          auto muontrack_at_plane = MatchingParams::propagateMUONtoZ(muontrack, mftGridZ);
+          query.x = muontrack_at_plane.getX();
+          query.y = muontrack_at_plane.getY();
+          if (fMatchingMethod == MatchingParams::MFT_LAST_CLUSTR) {
+            // pairs compared at the MFT track z
+            float tanl = std::abs(muontrack_at_plane.getTanl());
+            float muonSlope = std::max(std::abs(std::cos(muontrack_at_plane.getPhi())), std::abs(std::sin(muontrack_at_plane.getPhi()))) / tanl;
+            extraWidth = (mftGridMaxSlope + muonSlope) * mftGridMaxDz;
+          }
+        }
+        query.halfWidthX = fPreselectMatchingX + fCandidateSearchMargin + extraWidth;
+        query.halfWidthY = fPreselectMatchingY + fCandidateSearchMargin + extraWidth;
+        map_muonGridQuery[imuontrack] = query;
+      }
+    }
+  }
+
+  // MFT tracks of a collision to be paired with a muon, in the order of map_mfttracks:
+  // the grid candidates in the box of the muon, or all MFT tracks of the collision without grid search
+  const vector<int64_t>& getMFTCandidates(int collisionId, int64_t imuontrack, vector<int64_t>& candidates)
+  {
+    auto query = map_muonGridQuery.find(imuontrack);
+    if (query == map_muonGridQuery.end())
+      return map_mfttracks[collisionId];
+    auto const& box = query->second;
+    mftPlaneGrid.boxCandidates(collisionId, box.x - box.halfWidthX, box.x + box.halfWidthX, box.y - box.halfWidthY, box.y + box.halfWidthY, gridPositions);
+    candidates.clear();
+    for (auto const& position : gridPositions) {
+      candidates.push_back(mftPlaneGrid.payload(position));
+    }
+    return candidates;
+  }
+
   Produces<o2::aod::MatchParams> tableMatchingParams;
   Produces<o2::aod::TagMatchParams> tableTagMatchingParams;
   Produces<o2::aod::ProbeMatchParams> tableProbeMatchingParams;
@@ -657,10 +765,16 @@ struct match_mft_mch_data_mc {
     map_collisions.clear();
     map_has_muontracks_collisions.clear();
     map_has_mfttracks_collisions.clear();
+    map_vtxz.clear();
+    map_nmfttrack.clear();
 
     initCCDB(bcs.begin());
     setMUONs(muontracks, collisions);
     setMFTs(mfttracks, collisions, fieldB);
+    setCandidateGrid(muontracks, mfttracks, fieldB);
+
+    vector<int64_t> mftCandidates;
+    vector<int64_t> mixedMftCandidates;
 
     for (auto map_has_muontracks_collision : map_has_muontracks_collisions) {
       auto idmuontrack_collisions = map_has_muontracks_collision.first;
@@ -678,7 +792,7 @@ struct match_mft_mch_data_mc {
       for (auto const& imuontrack1 : map_muontracks[map_collision.first]) {
         auto const& muontrack1 = muontracks.rawIteratorAt(imuontrack1);
 
-        for (auto const& imfttrack1 : map_mfttracks[map_collision.first]) {
+        for (auto const& imfttrack1 : getMFTCandidates(map_collision.first, imuontrack1, mftCandidates)) {
           auto const& mfttrack1 = mfttracks.rawIteratorAt(imfttrack1);
 
           MatchingParamsML<MyMUON, MyMFT, MyCollision> matching(muontrack1, mfttrack1, collision, fMatchingMethod, fieldB);
@@ -710,7 +824,7 @@ struct match_mft_mch_data_mc {
           if (fabs(map_nmfttrack[map_mfttrack.first] - map_nmfttrack[map_collision.first]) > fEventMaxDeltaNMFT)
             continue;
 
-          for (auto const& imfttrack1 : map_mfttrack.second) {
+          for (auto const& imfttrack1 : getMFTCandidates(map_mfttrack.first, imuontrack1, mixedMftCandidates)) {
             auto const& mfttrack1 = mfttracks.rawIteratorAt(imfttrack1);
             MatchingParamsML<MyMUON, MyMFT, MyCollision> matching(muontrack1, mfttrack1, collision, fMatchingMethod, fieldB);
             matching.calcMatchingParams();
@@ -748,10 +862,14 @@ struct match_mft_mch_data_mc {
 
           auto tagmuontrack = muontrack1;
           auto probemuontrack = muontrack2;
+          int64_t itagmuontrack = imuontrack1;
+          int64_t iprobemuontrack = imuontrack2;
 
           if (tagdimuon.getTagMuonIndex() == 1) {
             tagmuontrack = muontrack2;
             probemuontrack = muontrack1;
+            itagmuontrack = imuontrack2;
+            iprobemuontrack = imuontrack1;
           }
 
           int nTagMFTCand = 0;
@@ -767,7 +885,7 @@ struct match_mft_mch_data_mc {
           unordered_map<int, vector<float>> map_tagMatchingParams;
           unordered_map<int, vector<float>> map_probeMatchingParams;
 
-          for (auto const& imfttrack1 : map_mfttracks[map_collision.first]) {
+          for (auto const& imfttrack1 : getMFTCandidates(map_collision.first, itagmuontrack, mftCandidates)) {
             auto const& mfttrack1 = mfttracks.rawIteratorAt(imfttrack1);
             MatchingParamsML<MyMUON, MyMFT, MyCollision> matchingTag(tagmuontrack, mfttrack1, collision, fMatchingMethod, fieldB);
             matchingTag.calcMatchingParams();
@@ -793,7 +911,7 @@ struct match_mft_mch_data_mc {
 
           if (nTagMFTCand != 1)
             continue;
-          for (auto const& imfttrack1 : map_mfttracks[map_collision.first]) {
+          for (auto const& imfttrack1 : getMFTCandidates(map_collision.first, iprobemuontrack, mftCandidates)) {
             auto const& mfttrack1 = mfttracks.rawIteratorAt(imfttrack1);
             if (mfttrack1.globalIndex() == IndexTagMFTCand)
               continue;
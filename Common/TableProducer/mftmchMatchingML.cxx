@@ -11,8 +11,10 @@
 
 #include <math.h>
 #include <onnxruntime_cxx_api.h>
+#include <algorithm>
 #include <string>
 #include <regex>
+#include <vector>
 #include <TLorentzVector.h>
 #include "Common/DataModel/MftmchMatchingML.h"
 #include "Framework/AnalysisDataModel.h"
@@ -76,127 +78,116 @@ struct mftmchMatchingML {
   std::shared_ptr<Ort::Session> onnx_session = nullptr;
   OnnxModel model;
 
-  template <typename F, typename M>
-  std::vector<float> getVariables(F const& fwdtrack, M const& mfttrack)
-  {
+  static constexpr int NVariables = 17; // number of input variables of the model per MFT-MCH pair
 
-    static constexpr Double_t MatchingPlaneZ = -77.5;
+  // track parameters at the matching plane
+  struct TrackAtMatchingPlane {
+    float x;
+    float y;
+    float phi;
+    float tanl;
+  };
 
-    // propagate muontrack to matching position
-    double muonchi2 = fwdtrack.chi2();
-    SMatrix5 muonpars(fwdtrack.x(), fwdtrack.y(), fwdtrack.phi(), fwdtrack.tgl(), fwdtrack.signed1Pt());
-    std::vector<double> muonv1;
-    SMatrix55 muoncovs(muonv1.begin(), muonv1.end());
-    o2::track::TrackParCovFwd muonpars1{fwdtrack.z(), muonpars, muoncovs, muonchi2};
-    muonpars1.propagateToZlinear(MatchingPlaneZ);
-
-    // propagate mfttrack to matching position
-    double mftchi2 = mfttrack.chi2();
-    SMatrix5 mftpars(mfttrack.x(), mfttrack.y(), mfttrack.phi(), mfttrack.tgl(), mfttrack.signed1Pt());
-    std::vector<double> mftv1;
-    SMatrix55 mftcovs(mftv1.begin(), mftv1.end());
-    o2::track::TrackParCovFwd mftpars1{mfttrack.z(), mftpars, mftcovs, mftchi2};
-    mftpars1.propagateToZlinear(MatchingPlaneZ);
-
-    Float_t MFT_X = mftpars1.getX();
-    Float_t MFT_Y = mftpars1.getY();
-    Float_t MFT_Phi = mftpars1.getPhi();
-    Float_t MFT_Tanl = mftpars1.getTanl();
-
-    Float_t MCH_X = muonpars1.getX();
-    Float_t MCH_Y = muonpars1.getY();
-    Float_t MCH_Phi = muonpars1.getPhi();
-    Float_t MCH_Tanl = muonpars1.getTanl();
-
-    Float_t Ratio_X = MFT_X / MCH_X;
-    Float_t Ratio_Y = MFT_Y / MCH_Y;
-    Float_t Ratio_Phi = MFT_Phi / MCH_Phi;
-    Float_t Ratio_Tanl = MFT_Tanl / MCH_Tanl;
-
-    Float_t Delta_X = MFT_X - MCH_X;
-    Float_t Delta_Y = MFT_Y - MCH_Y;
-    Float_t Delta_Phi = MFT_Phi - MCH_Phi;
-    Float_t Delta_Tanl = MFT_Tanl - MCH_Tanl;
+  // MFT track propagated to the matching plane, candidate for the matching
+  struct MftCandidate {
+    int collisionId;
+    TrackAtMatchingPlane pars;
+    int64_t globalIndex;
+  };
 
-    Float_t Delta_XY = sqrt(Delta_X * Delta_X + Delta_Y * Delta_Y);
+  std::vector<std::string> inputNames;
+  std::vector<std::string> outputNames;
+  std::vector<int64_t> inputShape;
+  bool isBatchDynamic = false; // the model accepts any number of pairs in one inference call
 
-    std::vector<float> input_tensor_values{
-      MFT_X,
-      MFT_Y,
-      MFT_Phi,
-      MFT_Tanl,
-      MCH_X,
-      MCH_Y,
-      MCH_Phi,
-      MCH_Tanl,
-      Delta_XY,
-      Delta_X,
-      Delta_Y,
-      Delta_Phi,
-      Delta_Tanl,
-      Ratio_X,
-      Ratio_Y,
-      Ratio_Phi,
-      Ratio_Tanl,
-    };
-    return input_tensor_values;
-  }
+  std::vector<MftCandidate> mftCandidates; // MFT tracks of the DataFrame, sorted by collision and x at the matching plane
+  std::vector<int> pairCandidates;         // MFT candidates of the pairs of the current muon
+  std::vector<float> inputTensorValues;    // input variables of the pairs of the current muon
+  std::vector<float> scores;               // matching scores of the pairs of the current muon
 
-  template <typename F, typename M>
-  double matchONNX(F const& fwdtrack, M const& mfttrack)
+  template <typename T>
+  TrackAtMatchingPlane propagateToMatchingPlane(T const& track)
   {
-    std::vector<std::string> input_names;
-    std::vector<std::vector<int64_t>> input_shapes;
-    std::vector<std::string> output_names;
-    std::vector<std::vector<int64_t>> output_shapes;
-
-    Ort::AllocatorWithDefaultOptions tmpAllocator;
-    for (size_t i = 0; i < onnx_session->GetInputCount(); ++i) {
-      input_names.push_back(onnx_session->GetInputNameAllocated(i, tmpAllocator).get());
-    }
-    for (size_t i = 0; i < onnx_session->GetInputCount(); ++i) {
-      input_shapes.emplace_back(onnx_session->GetInputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape());
-    }
-    for (size_t i = 0; i < onnx_session->GetOutputCount(); ++i) {
-      output_names.push_back(onnx_session->GetOutputNameAllocated(i, tmpAllocator).get());
-    }
-    for (size_t i = 0; i < onnx_session->GetOutputCount(); ++i) {
-      output_shapes.emplace_back(onnx_session->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape());
-    }
+    static constexpr Double_t MatchingPlaneZ = -77.5;
 
-    auto input_shape = input_shapes[0];
-    input_shape[0] = 1;
+    double chi2 = track.chi2();
+    SMatrix5 pars(track.x(), track.y(), track.phi(), track.tgl(), track.signed1Pt());
+    std::vector<double> v1;
+    SMatrix55 covs(v1.begin(), v1.end());
+    o2::track::TrackParCovFwd pars1{track.z(), pars, covs, chi2};
+    pars1.propagateToZlinear(MatchingPlaneZ);
+    return {static_cast<float>(pars1.getX()), static_cast<float>(pars1.getY()), static_cast<float>(pars1.getPhi()), static_cast<float>(pars1.getTanl())};
+  }
 
-    std::vector<float> input_tensor_values;
-    input_tensor_values = getVariables(fwdtrack, mfttrack);
+  // appends the input variables of an MFT-MCH pair
+  void fillVariables(TrackAtMatchingPlane const& mft, TrackAtMatchingPlane const& mch, std::vector<float>& values)
+  {
+    Float_t Ratio_X = mft.x / mch.x;
+    Float_t Ratio_Y = mft.y / mch.y;
+    Float_t Ratio_Phi = mft.phi / mch.phi;
+    Float_t Ratio_Tanl = mft.tanl / mch.tanl;
 
-    if (input_tensor_values[8] < cfgXYWindow) {
-      std::vector<Ort::Value> input_tensors;
-      Ort::MemoryInfo mem_info =
-        Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
-      input_tensors.push_back(Ort::Value::CreateTensor<float>(mem_info, input_tensor_values.data(), input_tensor_values.size(), input_shape.data(), input_shape.size()));
+    Float_t Delta_X = mft.x - mch.x;
+    Float_t Delta_Y = mft.y - mch.y;
+    Float_t Delta_Phi = mft.phi - mch.phi;
+    Float_t Delta_Tanl = mft.tanl - mch.tanl;
+
+    Float_t Delta_XY = sqrt(Delta_X * Delta_X + Delta_Y * Delta_Y);
 
-      Ort::RunOptions runOptions;
-      std::vector<const char*> inputNamesChar(input_names.size(), nullptr);
-      std::transform(std::begin(input_names), std::end(input_names), std::begin(inputNamesChar),
-                     [&](const std::string& str) { return str.c_str(); });
+    values.insert(values.end(), {mft.x,
+                                 mft.y,
+                                 mft.phi,
+                                 mft.tanl,
+                                 mch.x,
+                                 mch.y,
+                                 mch.phi,
+                                 mch.tanl,
+                                 Delta_XY,
+                                 Delta_X,
+                                 Delta_Y,
+                                 Delta_Phi,
+                                 Delta_Tanl,
+                                 Ratio_X,
+                                 Ratio_Y,
+                                 Ratio_Phi,
+                                 Ratio_Tanl});
+  }
 
-      std::vector<const char*> outputNamesChar(output_names.size(), nullptr);
-      std::transform(std::begin(output_names), std::end(output_names), std::begin(outputNamesChar),
-                     [&](const std::string& str) { return str.c_str(); });
+  // scores of nPairs pairs, with one inference call if the model has a dynamic batch size, one call per pair otherwise
+  void matchONNX(std::vector<float>& values, std::size_t nPairs, std::vector<float>& pairScores)
+  {
+    pairScores.clear();
+    if (nPairs == 0) {
+      return;
+    }
+    std::vector<const char*> inputNamesChar(inputNames.size(), nullptr);
+    std::transform(std::begin(inputNames), std::end(inputNames), std::begin(inputNamesChar),
+                   [&](const std::string& str) { return str.c_str(); });
+    std::vector<const char*> outputNamesChar(outputNames.size(), nullptr);
+    std::transform(std::begin(outputNames), std::end(outputNames), std::begin(outputNamesChar),
+                   [&](const std::string& str) { return str.c_str(); });
+    Ort::MemoryInfo mem_info =
+      Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
+    Ort::RunOptions runOptions;
+
+    const std::size_t batchSize = isBatchDynamic ? nPairs : 1;
+    auto shape = inputShape;
+    for (std::size_t first = 0; first < nPairs; first += batchSize) {
+      const std::size_t n = std::min(batchSize, nPairs - first);
+      shape[0] = n;
+      std::vector<Ort::Value> input_tensors;
+      input_tensors.push_back(Ort::Value::CreateTensor<float>(mem_info, values.data() + first * NVariables, n * NVariables, shape.data(), shape.size()));
 
       std::vector<Ort::Value> output_tensors = onnx_session->Run(runOptions, inputNamesChar.data(), input_tensors.data(), input_tensors.size(), outputNamesChar.data(), outputNamesChar.size());
 
+      // first output value of each pair
       const float* output_value = output_tensors[0].GetTensorData<float>();
-
-      auto score = output_value[0];
-
-      return score;
-    } else {
-      auto score = 0;
-      return score;
+      const std::size_t stride = output_tensors[0].GetTensorTypeAndShapeInfo().GetElementCount() / n;
+      for (std::size_t i = 0; i < n; i++) {
+        pairScores.push_back(output_value[i * stride]);
+      }
     }
-  };
+  }
 
   void init(o2::framework::InitContext&)
   {
@@ -216,6 +207,17 @@ struct mftmchMatchingML {
                 << "/" << cfgModelName.value;
       model.initModel(cfgModelName, false, 1, strtoul(headers["Valid-From"].c_str(), NULL, 0), strtoul(headers["Valid-Until"].c_str(), NULL, 0));
       onnx_session = model.getSession();
+
+      Ort::AllocatorWithDefaultOptions tmpAllocator;
+      for (size_t i = 0; i < onnx_session->GetInputCount(); ++i) {
+        inputNames.push_back(onnx_session->GetInputNameAllocated(i, tmpAllocator).get());
+      }
+      for (size_t i = 0; i < onnx_session->GetOutputCount(); ++i) {
+        outputNames.push_back(onnx_session->GetOutputNameAllocated(i, tmpAllocator).get());
+      }
+      inputShape = onnx_session->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+      isBatchDynamic = inputShape[0] < 0;
+      LOG(info) << "Model batch size: " << (isBatchDynamic ? "dynamic, one inference call per muon" : "fixed, one inference call per MFT-MCH pair");
     } else {
       LOG(info) << "Failed to retrieve Network file";
     }
@@ -223,41 +225,72 @@ struct mftmchMatchingML {
 
   void process(aod::Collisions const&, soa::Filtered<aod::FwdTracks> const& fwdtracks, aod::MFTTracks const& mfttracks)
   {
-    for (auto& fwdtrack : fwdtracks) {
-      if (fwdtrack.trackType() == aod::fwdtrack::ForwardTrackTypeEnum::MuonStandaloneTrack) {
-        double bestscore = 0;
-        int bestmfttrackid = -1;
-        for (auto& mfttrack : mfttracks) {
-          if (fwdtrack.has_collision() && mfttrack.has_collision()) {
-            if (0 <= fwdtrack.collisionId() - mfttrack.collisionId() && fwdtrack.collisionId() - mfttrack.collisionId() < cfgColWindow) {
-              double result = matchONNX(fwdtrack, mfttrack);
-              if (result > cfgThrScore) {
-                bestscore = result;
-                bestmfttrackid = mfttrack.globalIndex();
-              }
-            }
+    // MFT tracks propagated once per DataFrame to the matching plane, sorted by collision and x
+    mftCandidates.clear();
+    mftCandidates.reserve(mfttracks.size());
+    for (const auto& mfttrack : mfttracks) {
+      if (mfttrack.has_collision()) {
+        mftCandidates.push_back({mfttrack.collisionId(), propagateToMatchingPlane(mfttrack), mfttrack.globalIndex()});
+      }
+    }
+    auto byCollisionAndX = [](MftCandidate const& a, MftCandidate const& b) {
+      return a.collisionId < b.collisionId || (a.collisionId == b.collisionId && a.pars.x < b.pars.x);
+    };
+    std::sort(mftCandidates.begin(), mftCandidates.end(), byCollisionAndX);
+
+    for (const auto& fwdtrack : fwdtracks) {
+      if (fwdtrack.trackType() != aod::fwdtrack::ForwardTrackTypeEnum::MuonStandaloneTrack || !fwdtrack.has_collision()) {
+        continue;
+      }
+      const auto mchPars = propagateToMatchingPlane(fwdtrack);
+
+      // pairs with the MFT tracks of the collisions in the window and within the XY window at the matching plane
+      pairCandidates.clear();
+      inputTensorValues.clear();
+      for (int collisionId = fwdtrack.collisionId() - cfgColWindow + 1; collisionId <= fwdtrack.collisionId(); collisionId++) {
+        MftCandidate windowStart{collisionId, {mchPars.x - cfgXYWindow, 0.f, 0.f, 0.f}, -1};
+        for (auto candidate = std::lower_bound(mftCandidates.begin(), mftCandidates.end(), windowStart, byCollisionAndX);
+             candidate != mftCandidates.end() && candidate->collisionId == collisionId && candidate->pars.x < mchPars.x + cfgXYWindow; ++candidate) {
+          if (std::abs(candidate->pars.y - mchPars.y) >= cfgXYWindow) {
+            continue;
           }
-        }
-        if (bestmfttrackid != -1) {
-          for (auto& mfttrack : mfttracks) {
-            if (mfttrack.globalIndex() == bestmfttrackid) {
-              double mftchi2 = mfttrack.chi2();
-              SMatrix5 mftpars(mfttrack.x(), mfttrack.y(), mfttrack.phi(), mfttrack.tgl(), mfttrack.signed1Pt());
-              std::vector<double> mftv1;
-              SMatrix55 mftcovs(mftv1.begin(), mftv1.end());
-              o2::track::TrackParCovFwd mftpars1{mfttrack.z(), mftpars, mftcovs, mftchi2};
-              mftpars1.propagateToZlinear(mfttrack.collision().posZ());
-
-              float dcaX = (mftpars1.getX() - mfttrack.collision().posX());
-              float dcaY = (mftpars1.getY() - mfttrack.collision().posY());
-              double px = fwdtrack.p() * sin(M_PI / 2 - atan(mfttrack.tgl())) * cos(mfttrack.phi());
-              double py = fwdtrack.p() * sin(M_PI / 2 - atan(mfttrack.tgl())) * sin(mfttrack.phi());
-              double pz = fwdtrack.p() * cos(M_PI / 2 - atan(mfttrack.tgl()));
-              fwdtrackml(fwdtrack.collisionId(), 0, mfttrack.x(), mfttrack.y(), mfttrack.z(), mfttrack.phi(), mfttrack.tgl(), fwdtrack.sign() / std::sqrt(std::pow(px, 2) + std::pow(py, 2)), fwdtrack.nClusters(), fwdtrack.pDca(), fwdtrack.rAtAbsorberEnd(), 0, 0, 0, bestscore, mfttrack.globalIndex(), fwdtrack.globalIndex(), fwdtrack.mchBitMap(), fwdtrack.midBitMap(), fwdtrack.midBoards(), mfttrack.trackTime(), mfttrack.trackTimeRes(), mfttrack.eta(), std::sqrt(std::pow(px, 2) + std::pow(py, 2)), std::sqrt(std::pow(px, 2) + std::pow(py, 2) + std::pow(pz, 2)), dcaX, dcaY);
-            }
+          fillVariables(candidate->pars, mchPars, inputTensorValues);
+          if (inputTensorValues[inputTensorValues.size() - NVariables + 8] < cfgXYWindow) { // Delta_XY
+            pairCandidates.push_back(candidate - mftCandidates.begin());
+          } else {
+            inputTensorValues.resize(inputTensorValues.size() - NVariables);
           }
         }
       }
+
+      // all pairs of the muon scored at once, keeping the best one above threshold
+      matchONNX(inputTensorValues, pairCandidates.size(), scores);
+      double bestscore = 0;
+      int64_t bestmfttrackid = -1;
+      for (std::size_t iPair = 0; iPair < pairCandidates.size(); iPair++) {
+        if (scores[iPair] > cfgThrScore && (bestmfttrackid == -1 || scores[iPair] > bestscore)) {
+          bestscore = scores[iPair];
+          bestmfttrackid = mftCandidates[pairCandidates[iPair]].globalIndex;
+        }
+      }
+      if (bestmfttrackid == -1) {
+        continue;
+      }
+
+      auto mfttrack = mfttracks.iteratorAt(bestmfttrackid);
+      double mftchi2 = mfttrack.chi2();
+      SMatrix5 mftpars(mfttrack.x(), mfttrack.y(), mfttrack.phi(), mfttrack.tgl(), mfttrack.signed1Pt());
+      std::vector<double> mftv1;
+      SMatrix55 mftcovs(mftv1.begin(), mftv1.end());
+      o2::track::TrackParCovFwd mftpars1{mfttrack.z(), mftpars, mftcovs, mftchi2};
+      mftpars1.propagateToZlinear(mfttrack.collision().posZ());
+
+      float dcaX = (mftpars1.getX() - mfttrack.collision().posX());
+      float dcaY = (mftpars1.getY() - mfttrack.collision().posY());
+      double px = fwdtrack.p() * sin(M_PI / 2 - atan(mfttrack.tgl())) * cos(mfttrack.phi());
+      double py = fwdtrack.p() * sin(M_PI / 2 - atan(mfttrack.tgl())) * sin(mfttrack.phi());
+      double pz = fwdtrack.p() * cos(M_PI / 2 - atan(mfttrack.tgl()));
+      fwdtrackml(fwdtrack.collisionId(), 0, mfttrack.x(), mfttrack.y(), mfttrack.z(), mfttrack.phi(), mfttrack.tgl(), fwdtrack.sign() / std::sqrt(std::pow(px, 2) + std::pow(py, 2)), fwdtrack.nClusters(), fwdtrack.pDca(), fwdtrack.rAtAbsorberEnd(), 0, 0, 0, bestscore, mfttrack.globalIndex(), fwdtrack.globalIndex(), fwdtrack.mchBitMap(), fwdtrack.midBitMap(), fwdtrack.midBoards(), mfttrack.trackTime(), mfttrack.trackTimeRes(), mfttrack.eta(), std::sqrt(std::pow(px, 2) + std::pow(py, 2)), std::sqrt(std::pow(px, 2) + std::pow(py, 2) + std::pow(pz, 2)), dcaX, dcaY);
     }
   }
 };
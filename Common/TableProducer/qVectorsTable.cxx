@@ -31,6 +31,7 @@
 #include "Framework/runDataProcessing.h"
 #include "Framework/RunningWorkflowInfo.h"
 
+#include "Common/Core/CalibrationLUT.h"
 #include "Common/Core/EventPlaneHelper.h"
 #include "Common/DataModel/EventSelection.h"
 #include "Common/DataModel/FT0Corrected.h"
@@ -133,7 +134,7 @@ struct qVectorsTable {
   int runNumber{-1};
   float cent;
 
-  std::vector<TH3F*> objQvec{};
+  std::vector<o2::common::core::CalibrationLUT> lutQvec{}; // Q-vector corrections (centrality, correction, detector) per harmonic
 
   // Deprecated, will be removed in future after transition time //
   Configurable<bool> cfgUseBPos{"cfgUseBPos", false, "Initial value for using BPos. By default obtained from DataModel."};
@@ -239,7 +240,7 @@ struct qVectorsTable {
       LOGF(fatal, "Could not get the alignment parameters for FV0.");
     }
 
-    objQvec.clear();
+    lutQvec.clear();
     for (std::size_t i = 0; i < cfgnMods->size(); i++) {
       int ind = cfgnMods->at(i);
       fullPath = cfgQvecCalibPath;
@@ -251,7 +252,9 @@ struct qVectorsTable {
         fullPath += "/v2";
         objqvec = getForTsOrRun<TH3F>(fullPath, timestamp, runnumber);
       }
-      objQvec.push_back(objqvec);
+      if (!lutQvec.emplace_back().set(objqvec)) {
+        LOGF(fatal, "Could not get the Q-vector calibration for harmonic %d.", ind);
+      }
     }
     fullPath = cfgGainEqPath;
     fullPath += "/FT0";
@@ -565,21 +568,25 @@ struct qVectorsTable {
       int ind = cfgnMods->at(id);
       CalQvec(ind, coll, tracks, qvecRe, qvecIm, qvecAmp, TrkTPCposLabel, TrkTPCnegLabel, TrkTPCallLabel);
       if (cent < cfgMaxCentrality) {
+        const auto& lut = lutQvec.at(id);
+        const int centBin = static_cast<int>(cent) + 1;
         for (auto i{0u}; i < kTPCall + 1; i++) {
-          helperEP.DoRecenter(qvecRe[(kTPCall + 1) * 4 * id + i * 4 + 1], qvecIm[(kTPCall + 1) * 4 * id + i * 4 + 1],
-                              objQvec.at(id)->GetBinContent(static_cast<int>(cent) + 1, 1, i + 1), objQvec.at(id)->GetBinContent(static_cast<int>(cent) + 1, 2, i + 1));
-
-          helperEP.DoRecenter(qvecRe[(kTPCall + 1) * 4 * id + i * 4 + 2], qvecIm[(kTPCall + 1) * 4 * id + i * 4 + 2],
-                              objQvec.at(id)->GetBinContent(static_cast<int>(cent) + 1, 1, i + 1), objQvec.at(id)->GetBinContent(static_cast<int>(cent) + 1, 2, i + 1));
-          helperEP.DoTwist(qvecRe[(kTPCall + 1) * 4 * id + i * 4 + 2], qvecIm[(kTPCall + 1) * 4 * id + i * 4 + 2],
-                           objQvec.at(id)->GetBinContent(static_cast<int>(cent) + 1, 3, i + 1), objQvec.at(id)->GetBinContent(static_cast<int>(cent) + 1, 4, i + 1));
-
-          helperEP.DoRecenter(qvecRe[(kTPCall + 1) * 4 * id + i * 4 + 3], qvecIm[(kTPCall + 1) * 4 * id + i * 4 + 3],
-                              objQvec.at(id)->GetBinContent(static_cast<int>(cent) + 1, 1, i + 1), objQvec.at(id)->GetBinContent(static_cast<int>(cent) + 1, 2, i + 1));
-          helperEP.DoTwist(qvecRe[(kTPCall + 1) * 4 * id + i * 4 + 3], qvecIm[(kTPCall + 1) * 4 * id + i * 4 + 3],
-                           objQvec.at(id)->GetBinContent(static_cast<int>(cent) + 1, 3, i + 1), objQvec.at(id)->GetBinContent(static_cast<int>(cent) + 1, 4, i + 1));
-          helperEP.DoRescale(qvecRe[(kTPCall + 1) * 4 * id + i * 4 + 3], qvecIm[(kTPCall + 1) * 4 * id + i * 4 + 3],
-                             objQvec.at(id)->GetBinContent(static_cast<int>(cent) + 1, 5, i + 1), objQvec.at(id)->GetBinContent(static_cast<int>(cent) + 1, 6, i + 1));
+          const float meanRe = lut.getBinContent(centBin, 1, i + 1);
+          const float meanIm = lut.getBinContent(centBin, 2, i + 1);
+          const float twistP = lut.getBinContent(centBin, 3, i + 1);
+          const float twistM = lut.getBinContent(centBin, 4, i + 1);
+          const float rescaleP = lut.getBinContent(centBin, 5, i + 1);
+          const float rescaleM = lut.getBinContent(centBin, 6, i + 1);
+          const int index = (kTPCall + 1) * 4 * id + i * 4;
+
+          helperEP.DoRecenter(qvecRe[index + 1], qvecIm[index + 1], meanRe, meanIm);
+
+          helperEP.DoRecenter(qvecRe[index + 2], qvecIm[index + 2], meanRe, meanIm);
+          helperEP.DoTwist(qvecRe[index + 2], qvecIm[index + 2], twistP, twistM);
+
+          helperEP.DoRecenter(qvecRe[index + 3], qvecIm[index + 3], meanRe, meanIm);
+          helperEP.DoTwist(qvecRe[index + 3], qvecIm[index + 3], twistP, twistM);
+          helperEP.DoRescale(qvecRe[index + 3], qvecIm[index + 3], rescaleP, rescaleM);
         }
       }
       int CorrLevel = cfgCorrLevel == 0 ? 0 : cfgCorrLevel - 1;
@@ -24,6 +24,7 @@
 
 #include "Common/CCDB/EventSelectionParams.h"
 #include "Common/CCDB/TriggerAliases.h"
+#include "Common/Core/BcTimeline.h"
 #include "Common/DataModel/EventSelection.h"
 
 #include "CCDB/BasicCCDBManager.h"
@@ -41,11 +42,13 @@
 #include "ITSMFTBase/DPLAlpideParam.h"
 #include "ITSMFTReconstruction/ChipMappingITS.h"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdlib>
 #include <memory>
 #include <string>
+#include <vector>
 
 //__________________________________________
 // MultModule
@@ -142,6 +145,7 @@ class BcSelectionModule
   EventSelectionParams* par = nullptr;
   std::map<uint64_t, uint32_t>* mapRCT = nullptr;
   std::map<int64_t, std::vector<int16_t>> mapInactiveChips; // number of inactive chips vs orbit per layer
+  BcTimeline bcTimeline;                                    // global BC to BC index, rebuilt for each DataFrame
   int64_t prevOrbitForInactiveChips = 0;                    // cached next stored orbit in the inactive chip map
   int64_t nextOrbitForInactiveChips = 0;                    // cached previous stored orbit in the inactive chip map
   bool isGoodITSLayer3 = true;                              // default value
@@ -413,11 +417,10 @@ class BcSelectionModule
       return; // don't do anything in case configuration reported not ok
 
     int run = bcs.iteratorAt(0).runNumber();
-    // map from GlobalBC to BcId needed to find triggerBc
-    std::map<uint64_t, int32_t> mapGlobalBCtoBcId;
-    for (const auto& bc : bcs) {
-      mapGlobalBCtoBcId[bc.globalBC()] = bc.globalIndex();
-    }
+    // index from GlobalBC to BcId needed to find triggerBc
+    bcTimeline.clear();
+    bcTimeline.addBCs(bcs);
+    bcTimeline.build();
 
     int triggerBcShift = bcselOpts.confTriggerBcShift;
     if (bcselOpts.confTriggerBcShift == 999) {                                                                                                                               // o2-linter: disable=magic-number (special shift for early 2022 data)
@@ -441,7 +444,8 @@ class BcSelectionModule
 
       uint32_t alias{0};
       // workaround for pp2022 (trigger info is shifted by -294 bcs)
-      int32_t triggerBcId = mapGlobalBCtoBcId[bc.globalBC() + triggerBcShift];
+      int64_t triggerBcPos = bcTimeline.find(BcTimeline::Any, bc.globalBC() + triggerBcShift);
+      int32_t triggerBcId = triggerBcPos != BcTimeline::NotFound ? bcTimeline.index(BcTimeline::Any, triggerBcPos) : 0;
       if (triggerBcId && aliases) {
         auto triggerBc = bcs.iteratorAt(triggerBcId);
         uint64_t triggerMask = triggerBc.triggerMask();
@@ -597,6 +601,11 @@ class EventSelectionModule
   int run3min = 500000;
   int lastRun = -1;                     // last run number (needed to access ccdb only if run!=lastRun)
   std::bitset<nBCsPerOrbit> bcPatternB; // bc pattern of colliding bunches
+  BcTimeline bcTimeline;                // TVX-fired bcs of the DataFrame, used for closest TVX searches
+  std::vector<float> vTvxVtxZ;          // FT0 vertex z of TVX-fired bcs, parallel to the TVX slot of bcTimeline
+  std::vector<bool> vTvxAvailable;      // TVX-fired bcs not yet assigned to a collision, parallel to the TVX slot of bcTimeline
+
+  enum BcSlots : int { kBcTVX = BcTimeline::NPredefinedSlots }; // slot of bcTimeline with the TVX-fired bcs
 
   int64_t bcSOR = -1;     // global bc of the start of the first orbit
   int64_t nBCsPerTF = -1; // duration of TF in bcs, should be 128*3564 or 32*3564
@@ -626,33 +635,38 @@ class EventSelectionModule
   }
 
   // helper function to find closest TVX signal in time and in zVtx
-  int64_t findBestGlobalBC(int64_t meanBC, int64_t sigmaBC, int32_t nContrib, float zVtxCol, std::map<int64_t, float>& mapGlobalBcVtxZ)
+  // among the TVX bcs of bcTimeline still available for matching
+  // returns the position in the TVX slot of bcTimeline, BcTimeline::NotFound if none
+  int64_t findBestTVX(int64_t meanBC, int64_t sigmaBC, int32_t nContrib, float zVtxCol)
   {
     // protection against
     if (sigmaBC < 1)
       sigmaBC = 1;
 
-    int64_t minBC = meanBC - 3 * sigmaBC;
+    int64_t minBC = std::max<int64_t>(meanBC - 3 * sigmaBC, 0);
     int64_t maxBC = meanBC + 3 * sigmaBC;
     // TODO: use ITS ROF bounds to reduce the search range?
 
     float zVtxSigma = 2.7 * std::pow(nContrib, -0.466) + 0.024;
     zVtxSigma += 1.0; // additional uncertainty due to imperfectections of FT0 time calibration
 
-    auto itMin = mapGlobalBcVtxZ.lower_bound(minBC);
-    auto itMax = mapGlobalBcVtxZ.upper_bound(maxBC);
-
     float bestChi2 = 1e+10;
-    int64_t bestGlobalBC = 0;
-    for (std::map<int64_t, float>::iterator it = itMin; it != itMax; ++it) {
-      float chi2 = std::pow((it->second - zVtxCol) / zVtxSigma, 2) + std::pow(static_cast<float>(it->first - meanBC) / sigmaBC, 2.);
+    int64_t bestPos = BcTimeline::NotFound;
+    if (maxBC < 0) {
+      return bestPos;
+    }
+    bcTimeline.forEachInWindow(kBcTVX, minBC, maxBC, [&](std::size_t pos, uint64_t globalBC, int32_t) {
+      if (!vTvxAvailable[pos]) {
+        return;
+      }
+      float chi2 = std::pow((vTvxVtxZ[pos] - zVtxCol) / zVtxSigma, 2) + std::pow(static_cast<float>(static_cast<int64_t>(globalBC) - meanBC) / sigmaBC, 2.);
       if (chi2 < bestChi2) {
         bestChi2 = chi2;
-        bestGlobalBC = it->first;
+        bestPos = pos;
       }
-    }
+    });
 
-    return bestGlobalBC;
+    return bestPos;
   }
 
   // declaration of structs here
@@ -812,10 +826,9 @@ class EventSelectionModule
       return; // don't do anything in case configuration reported not ok
 
     int run = bcs.iteratorAt(0).runNumber();
-    // create maps from globalBC to bc index for TVX-fired bcs
+    // create index from globalBC to bc index for TVX-fired bcs
     // to be used for closest TVX searches
-    std::map<int64_t, int32_t> mapGlobalBcWithTVX;
-    std::map<int64_t, float> mapGlobalBcVtxZ;
+    bcTimeline.clear();
     for (const auto& bc : bcs) {
       int64_t globalBC = bc.globalBC();
       // skip non-colliding bcs for data and anchored runs
@@ -824,13 +837,19 @@ class EventSelectionModule
       }
       auto selection = bcselbuffer[bc.globalIndex()].selection;
       if (bitcheck64(selection, aod::evsel::kIsTriggerTVX)) {
-        mapGlobalBcWithTVX[globalBC] = bc.globalIndex();
-        mapGlobalBcVtxZ[globalBC] = bc.has_ft0() ? bc.ft0().posZ() : 0;
+        bcTimeline.add(kBcTVX, globalBC, bc.globalIndex());
       }
     }
+    bcTimeline.build();
+    vTvxVtxZ.resize(bcTimeline.size(kBcTVX));
+    vTvxAvailable.assign(bcTimeline.size(kBcTVX), true);
+    for (std::size_t pos = 0; pos < vTvxVtxZ.size(); ++pos) {
+      auto bc = bcs.rawIteratorAt(bcTimeline.index(kBcTVX, pos));
+      vTvxVtxZ[pos] = bc.has_ft0() ? bc.ft0().posZ() : 0;
+    }
 
     // protection against empty FT0 maps
-    if (mapGlobalBcWithTVX.size() == 0) {
+    if (bcTimeline.empty(kBcTVX)) {
       LOGP(error, "FT0 table is empty or corrupted. Filling evsel table with dummy values");
       for (const auto& col : cols) {
         auto bc = col.template bc_as<soa::Join<aod::BCs, aod::Timestamps, aod::Run3MatchedToBCSparse>>();
@@ -932,28 +951,28 @@ class EventSelectionModule
         // for collisions with TOF tracks:
         // take bc corresponding to TOF track with median time
         int64_t tofGlobalBC = globalBC + TMath::Nint(getMedian(vTrackTimesTOF) / bcNS);
-        std::map<int64_t, int32_t>::iterator it = mapGlobalBcWithTVX.find(tofGlobalBC);
-        if (it != mapGlobalBcWithTVX.end()) {
-          foundGlobalBC = it->first;
-          foundBCindex = it->second;
+        int64_t pos = bcTimeline.find(kBcTVX, tofGlobalBC);
+        if (pos != BcTimeline::NotFound) {
+          foundGlobalBC = tofGlobalBC;
+          foundBCindex = bcTimeline.index(kBcTVX, pos);
         }
       } else if (nPvTracksTPCnoTOFnoTRD == 0 && nPvTracksTRDnoTOF > 0) {
         // for collisions with TRD tracks but without TOF or ITSTPC-only tracks:
         // take bc corresponding to TRD track with median time
         int64_t trdGlobalBC = globalBC + TMath::Nint(getMedian(vTrackTimesTRDnoTOF) / bcNS);
-        std::map<int64_t, int32_t>::iterator it = mapGlobalBcWithTVX.find(trdGlobalBC);
-        if (it != mapGlobalBcWithTVX.end()) {
-          foundGlobalBC = it->first;
-          foundBCindex = it->second;
+        int64_t pos = bcTimeline.find(kBcTVX, trdGlobalBC);
+        if (pos != BcTimeline::NotFound) {
+          foundGlobalBC = trdGlobalBC;
+          foundBCindex = bcTimeline.index(kBcTVX, pos);
         }
       } else if (nPvTracksHighPtTPCnoTOFnoTRD > 0) {
         // for collisions with high-pt ITSTPC-nonTOF-nonTRD tracks
         // search in 3*confSigmaBCforHighPtTracks range (3*4 bcs by default)
         int64_t meanBC = globalBC + TMath::Nint(sumHighPtTime / sumHighPtW / bcNS);
-        int64_t bestGlobalBC = findBestGlobalBC(meanBC, evselOpts.confSigmaBCforHighPtTracks, vNcontributors[colIndex], col.posZ(), mapGlobalBcVtxZ);
-        if (bestGlobalBC > 0) {
-          foundGlobalBC = bestGlobalBC;
-          foundBCindex = mapGlobalBcWithTVX[bestGlobalBC];
+        int64_t bestPos = findBestTVX(meanBC, evselOpts.confSigmaBCforHighPtTracks, vNcontributors[colIndex], col.posZ());
+        if (bestPos != BcTimeline::NotFound) {
+          foundGlobalBC = bcTimeline.globalBC(kBcTVX, bestPos);
+          foundBCindex = bcTimeline.index(kBcTVX, bestPos);
         }
       }
 
@@ -962,9 +981,9 @@ class EventSelectionModule
       vFoundBCindex[colIndex] = foundBCindex >= 0 ? foundBCindex : bc.globalIndex();
       vFoundGlobalBC[colIndex] = foundGlobalBC > 0 ? foundGlobalBC : globalBC;
 
-      // erase found global BC with TVX from the pool of bcs for the next loop over low-pt TPCnoTOFnoTRD collisions
+      // remove found global BC with TVX from the pool of bcs for the next loop over low-pt TPCnoTOFnoTRD collisions
       if (foundBCindex >= 0)
-        mapGlobalBcVtxZ.erase(foundGlobalBC);
+        vTvxAvailable[bcTimeline.find(kBcTVX, foundGlobalBC)] = false;
     }
 
     // second loop to match remaining low-pt TPCnoTOFnoTRD collisions
@@ -977,9 +996,9 @@ class EventSelectionModule
         int64_t globalBC = bc.globalBC();
         int64_t meanBC = globalBC + TMath::Nint(weightedTime / bcNS);
         int64_t sigmaBC = TMath::CeilNint(weightedSigma / bcNS);
-        int64_t bestGlobalBC = findBestGlobalBC(meanBC, sigmaBC, vNcontributors[colIndex], col.posZ(), mapGlobalBcVtxZ);
-        vFoundGlobalBC[colIndex] = bestGlobalBC > 0 ? bestGlobalBC : globalBC;
-        vFoundBCindex[colIndex] = bestGlobalBC > 0 ? mapGlobalBcWithTVX[bestGlobalBC] : bc.globalIndex();
+        int64_t bestPos = findBestTVX(meanBC, sigmaBC, vNcontributors[colIndex], col.posZ());
+        vFoundGlobalBC[colIndex] = bestPos != BcTimeline::NotFound ? static_cast<int64_t>(bcTimeline.globalBC(kBcTVX, bestPos)) : globalBC;
+        vFoundBCindex[colIndex] = bestPos != BcTimeline::NotFound ? bcTimeline.index(kBcTVX, bestPos) : bc.globalIndex();
       }
       // fill pileup counter
       vCollisionsPerBc[vFoundBCindex[colIndex]]++;
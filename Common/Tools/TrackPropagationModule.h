@@ -143,9 +143,35 @@ class TrackPropagationModule
       }
     }
 
+    // resolve the table configuration once, the per-track code is specialised for it
+    if (fillTracksCov) {
+      if (fillTracksDCA && fillTracksDCACov) {
+        fillTrackTablesForConfig<isMc, true, true, true>(cGroup, ccdbLoader, collisions, tracks, cursors, registry);
+      } else if (fillTracksDCA) {
+        fillTrackTablesForConfig<isMc, true, true, false>(cGroup, ccdbLoader, collisions, tracks, cursors, registry);
+      } else if (fillTracksDCACov) {
+        fillTrackTablesForConfig<isMc, true, false, true>(cGroup, ccdbLoader, collisions, tracks, cursors, registry);
+      } else {
+        fillTrackTablesForConfig<isMc, true, false, false>(cGroup, ccdbLoader, collisions, tracks, cursors, registry);
+      }
+    } else {
+      if (fillTracksDCA) {
+        fillTrackTablesForConfig<isMc, false, true, false>(cGroup, ccdbLoader, collisions, tracks, cursors, registry);
+      } else {
+        fillTrackTablesForConfig<isMc, false, false, false>(cGroup, ccdbLoader, collisions, tracks, cursors, registry);
+      }
+    }
+  }
+
+ private:
+  template <bool isMc, bool fillCov, bool fillDCA, bool fillDCACov, typename TConfigurableGroup, typename TCCDBLoader, typename TCollisions, typename TTracks, typename TOutputGroup, typename THistoRegistry>
+  void fillTrackTablesForConfig(TConfigurableGroup const& cGroup, TCCDBLoader const& ccdbLoader, TCollisions const& collisions, TTracks const& tracks, TOutputGroup& cursors, THistoRegistry& registry)
+  {
+    const bool useTrackTuner = cGroup.useTrackTuner.value;
+    const bool fillTrackTunerTable = useTrackTuner && cGroup.fillTrackTunerTable.value;
     for (const auto& track : tracks) {
-      if (fillTracksCov) {
-        if (fillTracksDCA || fillTracksDCACov) {
+      if constexpr (fillCov) {
+        if constexpr (fillDCA || fillDCACov) {
           mDcaInfoCov.set(999, 999, 999, 999, 999);
         }
         setTrackParCov(track, mTrackParCov);
@@ -153,7 +179,7 @@ class TrackPropagationModule
           mTrackParCov.setPID(track.pidForTracking());
         }
       } else {
-        if (fillTracksDCA) {
+        if constexpr (fillDCA) {
           mDcaInfo[0] = 999;
           mDcaInfo[1] = 999;
         }
@@ -162,32 +188,25 @@ class TrackPropagationModule
           mTrackPar.setPID(track.pidForTracking());
         }
       }
-      // auto trackParCov = getTrackParCov(track);
       o2::aod::track::TrackTypeEnum trackType = (o2::aod::track::TrackTypeEnum)track.trackType();
-      // std::array<float, 3> trackPxPyPz;
-      // std::array<float, 3> trackPxPyPzTuned = {0.0, 0.0, 0.0};
       double q2OverPtNew = -9999.;
       // Only propagate tracks which have passed the innermost wall of the TPC (e.g. skipping loopers etc). Others fill unpropagated.
       if (track.trackType() == o2::aod::track::TrackIU && track.x() < cGroup.minPropagationRadius.value) {
-        if (fillTracksCov) {
-          if constexpr (isMc) { // checking MC and fillCovMat block begins
-            // bool hasMcParticle = track.has_mcParticle();
-            if (cGroup.useTrackTuner.value) {
-              trackTunedTracks->Fill(1); // all tracks
-              bool hasMcParticle = track.has_mcParticle();
-              if (hasMcParticle) {
-                auto mcParticle = track.mcParticle();
-                trackTunerObj.tuneTrackParams(mcParticle, mTrackParCov, matCorr, &mDcaInfoCov, trackTunedTracks);
-                q2OverPtNew = mTrackParCov.getQ2Pt();
-              }
+        if constexpr (isMc && fillCov) {
+          if (useTrackTuner) {
+            trackTunedTracks->Fill(1); // all tracks
+            if (track.has_mcParticle()) {
+              auto mcParticle = track.mcParticle();
+              trackTunerObj.tuneTrackParams(mcParticle, mTrackParCov, matCorr, &mDcaInfoCov, trackTunedTracks);
+              q2OverPtNew = mTrackParCov.getQ2Pt();
             }
-          } // MC and fillCovMat block ends
+          }
         }
         bool isPropagationOK = true;
 
         if (track.has_collision()) {
           auto const& collision = collisions.rawIteratorAt(track.collisionId());
-          if (fillTracksCov) {
+          if constexpr (fillCov) {
             mVtx.setPos({collision.posX(), collision.posY(), collision.posZ()});
             mVtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
             isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz(mVtx, mTrackParCov, 2.f, matCorr, &mDcaInfoCov);
@@ -195,7 +214,7 @@ class TrackPropagationModule
             isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, mTrackPar, 2.f, matCorr, &mDcaInfo);
           }
         } else {
-          if (fillTracksCov) {
+          if constexpr (fillCov) {
             mVtx.setPos({ccdbLoader.mMeanVtx->getX(), ccdbLoader.mMeanVtx->getY(), ccdbLoader.mMeanVtx->getZ()});
             mVtx.setCov(ccdbLoader.mMeanVtx->getSigmaX() * ccdbLoader.mMeanVtx->getSigmaX(), 0.0f, ccdbLoader.mMeanVtx->getSigmaY() * ccdbLoader.mMeanVtx->getSigmaY(), 0.0f, 0.0f, ccdbLoader.mMeanVtx->getSigmaZ() * ccdbLoader.mMeanVtx->getSigmaZ());
             isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz(mVtx, mTrackParCov, 2.f, matCorr, &mDcaInfoCov);
@@ -207,27 +226,23 @@ class TrackPropagationModule
           trackType = o2::aod::track::Track;
         }
         // filling some QA histograms for track tuner test purpose
-        if (fillTracksCov) {
-          if constexpr (isMc) { // checking MC and fillCovMat block begins
-            if (track.has_mcParticle() && isPropagationOK) {
-              auto mcParticle1 = track.mcParticle();
-              // && abs(mcParticle1.pdgCode())==211
-              if (mcParticle1.isPhysicalPrimary()) {
-                registry.fill(HIST("hDCAxyVsPtRec"), mDcaInfoCov.getY(), mTrackParCov.getPt());
-                registry.fill(HIST("hDCAxyVsPtMC"), mDcaInfoCov.getY(), mcParticle1.pt());
-                registry.fill(HIST("hDCAzVsPtRec"), mDcaInfoCov.getZ(), mTrackParCov.getPt());
-                registry.fill(HIST("hDCAzVsPtMC"), mDcaInfoCov.getZ(), mcParticle1.pt());
-              }
+        if constexpr (isMc && fillCov) {
+          if (track.has_mcParticle() && isPropagationOK) {
+            auto mcParticle1 = track.mcParticle();
+            if (mcParticle1.isPhysicalPrimary()) {
+              registry.fill(HIST("hDCAxyVsPtRec"), mDcaInfoCov.getY(), mTrackParCov.getPt());
+              registry.fill(HIST("hDCAxyVsPtMC"), mDcaInfoCov.getY(), mcParticle1.pt());
+              registry.fill(HIST("hDCAzVsPtRec"), mDcaInfoCov.getZ(), mTrackParCov.getPt());
+              registry.fill(HIST("hDCAzVsPtMC"), mDcaInfoCov.getZ(), mcParticle1.pt());
             }
-          } // MC and fillCovMat block ends
+          }
         }
       }
       // Filling modified Q/Pt values at IU/production point by track tuner in track tuner table
-      if (cGroup.useTrackTuner.value && cGroup.fillTrackTunerTable.value) {
+      if (fillTrackTunerTable) {
         cursors.tunertable(q2OverPtNew);
       }
-      // LOG(info) <<  " trackPropagation (this value filled in tuner table)--> "  << q2OverPtNew;
-      if (fillTracksCov) {
+      if constexpr (fillCov) {
         cursors.tracksParPropagated(track.collisionId(), trackType, mTrackParCov.getX(), mTrackParCov.getAlpha(), mTrackParCov.getY(), mTrackParCov.getZ(), mTrackParCov.getSnp(), mTrackParCov.getTgl(), mTrackParCov.getQ2Pt());
         cursors.tracksParExtensionPropagated(mTrackParCov.getPt(), mTrackParCov.getP(), mTrackParCov.getEta(), mTrackParCov.getPhi());
         // TODO do we keep the rho as 0? Also the sigma's are duplicated information
@@ -237,16 +252,16 @@ class TrackPropagationModule
                                                 mTrackParCov.getSigmaSnpZ(), mTrackParCov.getSigmaSnp2(), mTrackParCov.getSigmaTglY(), mTrackParCov.getSigmaTglZ(), mTrackParCov.getSigmaTglSnp(),
                                                 mTrackParCov.getSigmaTgl2(), mTrackParCov.getSigma1PtY(), mTrackParCov.getSigma1PtZ(), mTrackParCov.getSigma1PtSnp(), mTrackParCov.getSigma1PtTgl(),
                                                 mTrackParCov.getSigma1Pt2());
-        if (fillTracksDCA) {
+        if constexpr (fillDCA) {
           cursors.tracksDCA(mDcaInfoCov.getY(), mDcaInfoCov.getZ());
         }
-        if (fillTracksDCACov) {
+        if constexpr (fillDCACov) {
           cursors.tracksDCACov(mDcaInfoCov.getSigmaY2(), mDcaInfoCov.getSigmaZ2());
         }
       } else {
         cursors.tracksParPropagated(track.collisionId(), trackType, mTrackPar.getX(), mTrackPar.getAlpha(), mTrackPar.getY(), mTrackPar.getZ(), mTrackPar.getSnp(), mTrackPar.getTgl(), mTrackPar.getQ2Pt());
         cursors.tracksParExtensionPropagated(mTrackPar.getPt(), mTrackPar.getP(), mTrackPar.getEta(), mTrackPar.getPhi());
-        if (fillTracksDCA) {
+        if constexpr (fillDCA) {
           cursors.tracksDCA(mDcaInfo[0], mDcaInfo[1]);
         }
       }
@@ -18,6 +18,8 @@
 #ifndef COMMON_TOOLS_TRACKTUNER_H_
 #define COMMON_TOOLS_TRACKTUNER_H_
 
+#include <array>
+#include <cmath>
 #include <map>
 #include <memory>
 #include <string>
@@ -80,6 +82,7 @@ struct TrackTuner : o2::framework::ConfigurableGroup {
   o2::framework::Configurable<float> cfgQOverPtMC{"qOverPtMC", -1., "Scaling factor on q/pt of MC"};
   o2::framework::Configurable<float> cfgQOverPtData{"qOverPtData", -1., "Scaling factor on q/pt of data"};
   o2::framework::Configurable<int> cfgNPhiBins{"nPhiBins", 0, "Number of phi bins"};
+  o2::framework::Configurable<bool> cfgUseTabulatedGraphs{"useTabulatedGraphs", false, "Flag to resample the correction graphs once in a pt table per phi bin, read with a single interpolation per track"};
   ///////////////////////////////
   /// parameters to be configured
   bool debugInfo = false;
@@ -96,6 +99,7 @@ struct TrackTuner : o2::framework::ConfigurableGroup {
   bool usePvRefitCorrections = false; // establish whether to use corrections obtained with or w/o PV refit
   float qOverPtMC = -1.;              // 1/pt MC
   float qOverPtData = -1.;            // 1/pt data
+  bool useTabulatedGraphs = false;    // evaluate the correction graphs from a pt table per phi bin
   ///////////////////////////////
   bool isConfigFromString = false;
   bool isConfigFromConfigurables = false;
@@ -125,6 +129,24 @@ struct TrackTuner : o2::framework::ConfigurableGroup {
   std::vector<std::unique_ptr<TGraphErrors>> grDcaZPullVsPtPionMC;
   std::vector<std::unique_ptr<TGraphErrors>> grDcaZPullVsPtPionData;
 
+  /// correction graphs used in tuneTrackParams, in the order of the columns of the pt table
+  enum TunedGraph : int { GraphDcaXYResMC = 0,
+                          GraphDcaXYResData,
+                          GraphDcaZResMC,
+                          GraphDcaZResData,
+                          GraphDcaXYMeanMC,
+                          GraphDcaXYMeanData,
+                          GraphDcaXYPullMC,
+                          GraphDcaXYPullData,
+                          GraphDcaZPullMC,
+                          GraphDcaZPullData,
+                          GraphQOverPtMC,
+                          GraphQOverPtData,
+                          NTunedGraphs };
+  std::vector<double> tablePt;     // pt grid of each phi bin, i.e. the union of the abscissae of its graphs
+  std::vector<int> tablePtOffsets; // first grid point of each phi bin in tablePt, with a final end marker
+  std::vector<double> tableValues; // graph values at the grid points, NTunedGraphs consecutive values per point
+
   /// @brief Function doing a few sanity-checks on the configurations
   void checkConfig()
   {
@@ -349,6 +371,10 @@ struct TrackTuner : o2::framework::ConfigurableGroup {
     if (nPhiBins < 0)
       LOG(fatal) << "[TrackTuner]   negative nPhiBins!" << nPhiBins;
     LOG(info) << "[TrackTuner]     nPhiBins = " << nPhiBins;
+    // Configure useTabulatedGraphs: it changes only how the graphs are evaluated, so it is taken from the Configurable also here
+    useTabulatedGraphs = cfgUseTabulatedGraphs;
+    outputString += ", useTabulatedGraphs=" + std::to_string(useTabulatedGraphs);
+    LOG(info) << "[TrackTuner]     useTabulatedGraphs = " << useTabulatedGraphs;
     /// declare that the configuration is done via an input string
     isConfigFromString = true;
 
@@ -434,6 +460,10 @@ struct TrackTuner : o2::framework::ConfigurableGroup {
     if (nPhiBins < 0)
       LOG(fatal) << "[TrackTuner]   negative nPhiBins!" << nPhiBins;
     LOG(info) << "[TrackTuner]     nPhiBins = " << nPhiBins;
+    // Configure useTabulatedGraphs
+    useTabulatedGraphs = cfgUseTabulatedGraphs;
+    outputString += ", useTabulatedGraphs=" + std::to_string(useTabulatedGraphs);
+    LOG(info) << "[TrackTuner]     useTabulatedGraphs = " << useTabulatedGraphs;
 
     /// declare that the configuration is done via the Configurables
     isConfigFromConfigurables = true;
@@ -568,8 +598,137 @@ struct TrackTuner : o2::framework::ConfigurableGroup {
       grOneOverPtPionMC.reset(dynamic_cast<TGraphErrors*>(inputFileQoverPt->Get(grOneOverPtPionNameMC.c_str())));
       grOneOverPtPionData.reset(dynamic_cast<TGraphErrors*>(inputFileQoverPt->Get(grOneOverPtPionNameData.c_str())));
     }
+
+    if (useTabulatedGraphs) {
+      tabulateGraphs();
+    }
   } // getDcaGraphs() ends here
 
+  /// @brief Function returning the correction graphs of a phi bin, in the order of TunedGraph (nullptr for graphs not loaded)
+  std::array<const TGraphErrors*, NTunedGraphs> getTunedGraphs(int phiBin) const
+  {
+    return {grDcaXYResVsPtPionMC[phiBin].get(), grDcaXYResVsPtPionData[phiBin].get(),
+            grDcaZResVsPtPionMC[phiBin].get(), grDcaZResVsPtPionData[phiBin].get(),
+            grDcaXYMeanVsPtPionMC[phiBin].get(), grDcaXYMeanVsPtPionData[phiBin].get(),
+            grDcaXYPullVsPtPionMC[phiBin].get(), grDcaXYPullVsPtPionData[phiBin].get(),
+            grDcaZPullVsPtPionMC[phiBin].get(), grDcaZPullVsPtPionData[phiBin].get(),
+            grOneOverPtPionMC.get(), grOneOverPtPionData.get()};
+  }
+
+  /// @brief Function returning whether tuneTrackParams evaluates a correction graph with the current configuration
+  bool isTunedGraphUsed(int iGraph) const
+  {
+    switch (iGraph) {
+      case GraphDcaXYResMC:
+      case GraphDcaXYResData:
+      case GraphDcaZResMC:
+      case GraphDcaZResData:
+        return true;
+      case GraphQOverPtMC:
+      case GraphQOverPtData:
+        return (updateCurvature || updateCurvatureIU) && ((qOverPtMC < 0) || (qOverPtData < 0));
+      default:
+        return updateTrackDCAs;
+    }
+  }
+
+  /// @brief Function resampling the correction graphs of each phi bin in one pt table
+  ///        The grid of a phi bin is the union of the abscissae of its graphs, where the linear interpolation of the table
+  ///        reproduces evalGraph. The agreement is checked at the grid points, between them and outside the grid range:
+  ///        if it fails, the graphs are used directly. The graphs not used by tuneTrackParams are stored as 0.
+  void tabulateGraphs()
+  {
+    // same failure as evalGraph for the graphs that tuneTrackParams evaluates
+    for (int iPhiBin = 0; iPhiBin < nPhiBins; ++iPhiBin) {
+      const auto graphs = getTunedGraphs(iPhiBin);
+      for (int iGraph = 0; iGraph < NTunedGraphs; ++iGraph) {
+        if (isTunedGraphUsed(iGraph) && (!graphs[iGraph] || graphs[iGraph]->GetN() <= 0)) {
+          LOG(fatal) << "[TrackTuner] Correction graph " << iGraph << " of phi bin " << iPhiBin << " missing or empty, cannot tabulate it. Fix it!";
+        }
+      }
+    }
+
+    tablePt.clear();
+    tablePtOffsets.assign(1, 0);
+    tableValues.clear();
+    for (int iPhiBin = 0; iPhiBin < nPhiBins; ++iPhiBin) {
+      const auto graphs = getTunedGraphs(iPhiBin);
+      std::vector<double> grid;
+      for (int iGraph = 0; iGraph < NTunedGraphs; ++iGraph) {
+        if (isTunedGraphUsed(iGraph)) {
+          grid.insert(grid.end(), graphs[iGraph]->GetX(), graphs[iGraph]->GetX() + graphs[iGraph]->GetN());
+        }
+      }
+      std::sort(grid.begin(), grid.end());
+      grid.erase(std::unique(grid.begin(), grid.end()), grid.end());
+      if (grid.empty()) { // not expected, as the dca resolution graphs are always used
+        LOG(warning) << "[TrackTuner] No pt points to tabulate the corrections of phi bin " << iPhiBin << ", using the graphs";
+        useTabulatedGraphs = false;
+        return;
+      }
+      for (const auto& pt : grid) {
+        tablePt.push_back(pt);
+        for (int iGraph = 0; iGraph < NTunedGraphs; ++iGraph) {
+          tableValues.push_back(isTunedGraphUsed(iGraph) ? evalGraph(pt, graphs[iGraph]) : 0.);
+        }
+      }
+      tablePtOffsets.push_back(tablePt.size());
+    }
+
+    // check the agreement with the graph evaluation
+    const double tolerance = 1.e-6; // relative, or absolute for values below 1
+    double maxDeviation = 0.;
+    for (int iPhiBin = 0; iPhiBin < nPhiBins; ++iPhiBin) {
+      const auto graphs = getTunedGraphs(iPhiBin);
+      const int first = tablePtOffsets[iPhiBin];
+      const int last = tablePtOffsets[iPhiBin + 1] - 1;
+      std::vector<double> ptChecks = {tablePt[first] - 1., tablePt[last] + 1.};
+      for (int i = first; i <= last; ++i) {
+        ptChecks.push_back(tablePt[i]);
+        if (i < last) {
+          ptChecks.push_back(0.5 * (tablePt[i] + tablePt[i + 1]));
+        }
+      }
+      for (const auto& pt : ptChecks) {
+        const auto values = evalTabulated(pt, iPhiBin);
+        for (int iGraph = 0; iGraph < NTunedGraphs; ++iGraph) {
+          if (isTunedGraphUsed(iGraph)) {
+            const double graphValue = evalGraph(pt, graphs[iGraph]);
+            maxDeviation = std::max(maxDeviation, std::abs(values[iGraph] - graphValue) / std::max(1., std::abs(graphValue)));
+          }
+        }
+      }
+    }
+    if (maxDeviation > tolerance) {
+      LOG(warning) << "[TrackTuner] Tabulated corrections deviate from the graphs by up to " << maxDeviation << " (e.g. unsorted graph abscissae), using the graphs";
+      useTabulatedGraphs = false;
+      return;
+    }
+    LOG(info) << "[TrackTuner] Correction graphs tabulated on " << tablePt.size() << " pt points for " << nPhiBins << " phi bins, maximum deviation from the graphs " << maxDeviation;
+  }
+
+  /// @brief Function returning all tabulated corrections of a track, in the order of TunedGraph, with one search in the pt grid
+  std::array<double, NTunedGraphs> evalTabulated(double pt, int phiBin) const
+  {
+    const double* grid = tablePt.data() + tablePtOffsets[phiBin];
+    const double* values = tableValues.data() + static_cast<std::size_t>(tablePtOffsets[phiBin]) * NTunedGraphs;
+    const int nPoints = tablePtOffsets[phiBin + 1] - tablePtOffsets[phiBin];
+    std::array<double, NTunedGraphs> result;
+    int point = 0; // grid point of the lower edge of the interpolation
+    double fraction = 0.;
+    if (pt >= grid[nPoints - 1]) {
+      point = nPoints - 1;
+    } else if (pt > grid[0]) {
+      point = std::upper_bound(grid, grid + nPoints, pt) - grid - 1;
+      fraction = (pt - grid[point]) / (grid[point + 1] - grid[point]);
+    }
+    const double* low = values + static_cast<std::size_t>(point) * NTunedGraphs;
+    for (int iGraph = 0; iGraph < NTunedGraphs; ++iGraph) {
+      result[iGraph] = fraction > 0. ? low[iGraph] + fraction * (low[iGraph + NTunedGraphs] - low[iGraph]) : low[iGraph];
+    }
+    return result;
+  }
+
   template <typename T1, typename T2, typename T3, typename T4, typename H>
   void tuneTrackParams(T1 const& mcparticle, T2& trackParCov, T3 const& matCorr, T4 dcaInfoCov, H hQA)
   {
@@ -595,11 +754,20 @@ struct TrackTuner : o2::framework::ConfigurableGroup {
       phiMC += o2::constants::math::TwoPI;                                    // 2 * std::numbers::pi;//
     int phiBin = phiMC / (o2::constants::math::TwoPI + 0.0000001) * nPhiBins; // 0.0000001 just a numerical protection
 
-    dcaXYResMC = evalGraph(ptMC, grDcaXYResVsPtPionMC[phiBin].get());
-    dcaXYResData = evalGraph(ptMC, grDcaXYResVsPtPionData[phiBin].get());
+    // all corrections of the track from a single table read, or from the graphs one by one
+    std::array<double, NTunedGraphs> tabulated{};
+    if (useTabulatedGraphs) {
+      tabulated = evalTabulated(ptMC, phiBin);
+    }
+    auto evalCorrection = [&](int iGraph, const TGraphErrors* graph) {
+      return useTabulatedGraphs ? tabulated[iGraph] : evalGraph(ptMC, graph);
+    };
+
+    dcaXYResMC = evalCorrection(GraphDcaXYResMC, grDcaXYResVsPtPionMC[phiBin].get());
+    dcaXYResData = evalCorrection(GraphDcaXYResData, grDcaXYResVsPtPionData[phiBin].get());
 
-    dcaZResMC = evalGraph(ptMC, grDcaZResVsPtPionMC[phiBin].get());
-    dcaZResData = evalGraph(ptMC, grDcaZResVsPtPionData[phiBin].get());
+    dcaZResMC = evalCorrection(GraphDcaZResMC, grDcaZResVsPtPionMC[phiBin].get());
+    dcaZResData = evalCorrection(GraphDcaZResData, grDcaZResVsPtPionData[phiBin].get());
 
     // For Q/Pt corrections, files on CCDB will be used if both qOverPtMC and qOverPtData are null
     if (updateCurvature || updateCurvatureIU) {
@@ -611,21 +779,21 @@ struct TrackTuner : o2::framework::ConfigurableGroup {
         if (!grOneOverPtPionData.get() || !grOneOverPtPionMC.get()) {
           LOG(fatal) << "### q/pt smearing: input graphs not correctly retrieved. Aborting.";
         }
-        qOverPtMC = std::max(0.0, evalGraph(ptMC, grOneOverPtPionMC.get()));
-        qOverPtData = std::max(0.0, evalGraph(ptMC, grOneOverPtPionData.get()));
+        qOverPtMC = std::max(0.0, evalCorrection(GraphQOverPtMC, grOneOverPtPionMC.get()));
+        qOverPtData = std::max(0.0, evalCorrection(GraphQOverPtData, grOneOverPtPionData.get()));
       } // qOverPtMC, qOverPtData block ends here
     } // updateCurvature, updateCurvatureIU block ends here
 
     if (updateTrackDCAs) {
 
-      dcaXYMeanMC = evalGraph(ptMC, grDcaXYMeanVsPtPionMC[phiBin].get());
-      dcaXYMeanData = evalGraph(ptMC, grDcaXYMeanVsPtPionData[phiBin].get());
+      dcaXYMeanMC = evalCorrection(GraphDcaXYMeanMC, grDcaXYMeanVsPtPionMC[phiBin].get());
+      dcaXYMeanData = evalCorrection(GraphDcaXYMeanData, grDcaXYMeanVsPtPionData[phiBin].get());
 
-      dcaXYPullMC = evalGraph(ptMC, grDcaXYPullVsPtPionMC[phiBin].get());
-      dcaXYPullData = evalGraph(ptMC, grDcaXYPullVsPtPionData[phiBin].get());
+      dcaXYPullMC = evalCorrection(GraphDcaXYPullMC, grDcaXYPullVsPtPionMC[phiBin].get());
+      dcaXYPullData = evalCorrection(GraphDcaXYPullData, grDcaXYPullVsPtPionData[phiBin].get());
 
-      dcaZPullMC = evalGraph(ptMC, grDcaZPullVsPtPionMC[phiBin].get());
-      dcaZPullData = evalGraph(ptMC, grDcaZPullVsPtPionData[phiBin].get());
+      dcaZPullMC = evalCorrection(GraphDcaZPullMC, grDcaZPullVsPtPionMC[phiBin].get());
+      dcaZPullData = evalCorrection(GraphDcaZPullData, grDcaZPullVsPtPionData[phiBin].get());
     }
     //  Unit conversion, is it required ??
     dcaXYResMC *= 1.e-4;
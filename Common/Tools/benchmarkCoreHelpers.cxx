@@ -0,0 +1,436 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file benchmarkCoreHelpers.cxx
+/// \brief Micro-benchmarks of shared analysis helpers on synthetic, seeded input
+///
+/// Measures RecoDecay kinematics, the event-mixing binning, the TPC and TOF PID responses, the 2-prong DCAFitterN
+/// and the MC genealogy index on generated tracks, collisions and MC particle trees. The results are written in the JSON format of Google Benchmark,
+/// so that two commits can be compared with its compare.py tool.
+///
+/// Usage: o2-bench-core-helpers [output file (default benchmarkCoreHelpers.json)] [seed (default 1)]
+
+#include "Common/Core/EventMixing.h"
+#include "Common/Core/McAncestryIndex.h"
+#include "Common/Core/PID/PIDTOF.h"
+#include "Common/Core/PID/TPCPIDResponse.h"
+#include "Common/Core/RecoDecay.h"
+
+#include <CommonConstants/MathConstants.h>
+#include <CommonConstants/PhysicsConstants.h>
+#include <DCAFitter/DCAFitterN.h>
+#include <Framework/Logger.h>
+#include <ReconstructionDataFormats/PID.h>
+#include <ReconstructionDataFormats/Track.h>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+/// Synthetic barrel track with the accessors used by the helpers
+struct SyntheticTrack {
+  std::array<float, 3> pVec{};
+  float pValue = 0.f;
+  float etaValue = 0.f;
+  float tpcInnerParamValue = 0.f;
+  float tpcSignalValue = 0.f;
+  float tglValue = 0.f;
+  float signed1PtValue = 0.f;
+  int16_t tpcNClsFoundValue = 0;
+  int16_t signValue = 1;
+  float lengthValue = 0.f;
+  float tofSignalValue = 0.f;
+  float tofEvTimeValue = 0.f;
+  float tofEvTimeErrValue = 0.f;
+
+  bool hasTPC() const { return true; }
+  bool hasTOF() const { return true; }
+  uint8_t trackType() const { return o2::aod::track::Track; }
+  int16_t sign() const { return signValue; }
+  float p() const { return pValue; }
+  float eta() const { return etaValue; }
+  float tpcInnerParam() const { return tpcInnerParamValue; }
+  float tpcSignal() const { return tpcSignalValue; }
+  float tgl() const { return tglValue; }
+  float signed1Pt() const { return signed1PtValue; }
+  int16_t tpcNClsFound() const { return tpcNClsFoundValue; }
+  float length() const { return lengthValue; }
+  float tofSignal() const { return tofSignalValue; }
+  float tofExpMom() const { return pValue; }
+  float tofEvTime() const { return tofEvTimeValue; }
+  float tofEvTimeErr() const { return tofEvTimeErrValue; }
+};
+
+/// Synthetic MC particle with the accessors used by McAncestryIndex
+struct SyntheticMcParticle {
+  int64_t index = 0;
+  int pdg = 0;
+  TMCProcess process = kPPrimary;
+  std::vector<int> mothers;
+  std::array<int, 2> daughters{-1, -1};
+
+  int64_t globalIndex() const { return index; }
+  int pdgCode() const { return pdg; }
+  TMCProcess getProcess() const { return process; }
+  bool has_mothers() const { return !mothers.empty(); }
+  std::vector<int> const& mothersIds() const { return mothers; }
+  bool has_daughters() const { return daughters[0] > -1; }
+  std::array<int, 2> const& daughtersIds() const { return daughters; }
+};
+
+/// Synthetic MC particle table
+struct SyntheticMcParticles {
+  std::vector<SyntheticMcParticle> particles;
+
+  int64_t size() const { return particles.size(); }
+  int64_t offset() const { return 0; }
+  auto begin() const { return particles.begin(); }
+  auto end() const { return particles.end(); }
+
+  /// Adds a particle, with its mother if motherIndex > -1, and returns its index
+  int add(int pdg, int motherIndex = -1)
+  {
+    SyntheticMcParticle particle;
+    particle.index = particles.size();
+    particle.pdg = pdg;
+    if (motherIndex > -1) {
+      particle.process = kPDecay;
+      particle.mothers.push_back(motherIndex);
+    }
+    particles.push_back(particle);
+    return particle.index;
+  }
+
+  /// Adds the decay products of a particle, stored contiguously as in the MC particle table
+  void decay(int motherIndex, std::vector<int> const& pdgDaughters)
+  {
+    const int first = particles.size();
+    for (const auto& pdg : pdgDaughters) {
+      add(pdg, motherIndex);
+    }
+    particles[motherIndex].daughters = {first, static_cast<int>(particles.size()) - 1};
+  }
+};
+
+/// Synthetic collision with the accessors used by the helpers
+struct SyntheticCollision {
+  std::array<float, 3> pos{};
+  float multTPCValue = 0.f;
+
+  float posZ() const { return pos[2]; }
+  float multTPC() const { return multTPCValue; }
+};
+
+/// Seeded generator of collisions, tracks and 2-prong decays
+class InputGenerator
+{
+ public:
+  explicit InputGenerator(uint64_t seed) : mRandom(seed) {}
+
+  std::vector<SyntheticCollision> collisions(int n)
+  {
+    std::normal_distribution<float> vtxXY(0.f, 0.01f);
+    std::normal_distribution<float> vtxZ(0.f, 6.f);
+    std::exponential_distribution<float> mult(1.f / 1500.f);
+    std::vector<SyntheticCollision> result(n);
+    for (auto& collision : result) {
+      collision.pos = {vtxXY(mRandom), vtxXY(mRandom), vtxZ(mRandom)};
+      collision.multTPCValue = mult(mRandom);
+    }
+    return result;
+  }
+
+  std::vector<SyntheticTrack> tracks(int n)
+  {
+    std::exponential_distribution<float> pt(1.f / 0.7f);
+    std::uniform_real_distribution<float> eta(-0.9f, 0.9f);
+    std::uniform_real_distribution<float> phi(0.f, o2::constants::math::TwoPI);
+    std::normal_distribution<float> dEdx(60.f, 10.f);
+    std::uniform_int_distribution<int> nCls(70, 159);
+    const std::array<float, 3> tofMasses{o2::constants::physics::MassPiPlus, o2::constants::physics::MassKPlus, o2::constants::physics::MassProton};
+    std::discrete_distribution<int> speciesIndex({0.8, 0.12, 0.08});
+    std::normal_distribution<float> tofTime(0.f, 80.f);
+    std::normal_distribution<float> evTime(0.f, 20.f);
+    std::vector<SyntheticTrack> result(n);
+    for (auto& track : result) {
+      const float trackPt = 0.1f + pt(mRandom);
+      const float trackEta = eta(mRandom);
+      const float trackPhi = phi(mRandom);
+      track.signValue = (mRandom() & 1) ? 1 : -1;
+      track.pVec = {trackPt * std::cos(trackPhi), trackPt * std::sin(trackPhi), trackPt * std::sinh(trackEta)};
+      track.tpcInnerParamValue = trackPt * std::cosh(trackEta);
+      track.tpcSignalValue = dEdx(mRandom);
+      track.tglValue = std::sinh(trackEta);
+      track.signed1PtValue = track.signValue / trackPt;
+      track.tpcNClsFoundValue = nCls(mRandom);
+      // TOF: time of flight of a pion, kaon or proton over the track length, with the event time resolution
+      track.pValue = trackPt * std::cosh(trackEta);
+      track.etaValue = trackEta;
+      track.lengthValue = 385.f * std::cosh(trackEta);
+      const float mass = tofMasses[speciesIndex(mRandom)];
+      track.tofSignalValue = track.lengthValue * std::sqrt(mass * mass + track.pValue * track.pValue) / (o2::constants::physics::LightSpeedCm2PS * track.pValue) + tofTime(mRandom);
+      track.tofEvTimeValue = evTime(mRandom);
+      track.tofEvTimeErrValue = 20.f;
+    }
+    return result;
+  }
+
+  /// MC particle trees of nEvents events: primary pions and kaons, prompt D*+ -> D0 pi+ and non-prompt B+ -> D0bar pi+,
+  /// with D0 -> K- pi+ (and charge conjugates)
+  SyntheticMcParticles mcParticles(int nEvents)
+  {
+    std::poisson_distribution<int> nPrimaries(200);
+    std::uniform_real_distribution<float> uniform(0.f, 1.f);
+    SyntheticMcParticles result;
+    for (int iEvent = 0; iEvent < nEvents; iEvent++) {
+      const int n = nPrimaries(mRandom);
+      for (int i = 0; i < n; i++) {
+        const int sign = (mRandom() & 1) ? 1 : -1;
+        const float type = uniform(mRandom);
+        if (type < 0.9f) {
+          result.add(sign * 211);
+        } else if (type < 0.98f) {
+          result.add(sign * 321);
+        } else if (type < 0.995f) {
+          const int dStar = result.add(sign * 413);
+          result.decay(dStar, {sign * 421, sign * 211});
+          const int d0 = result.particles[dStar].daughters[0];
+          result.decay(d0, {-sign * 321, sign * 211});
+        } else {
+          const int bPlus = result.add(sign * 521);
+          result.decay(bPlus, {-sign * 421, sign * 211});
+          const int d0 = result.particles[bPlus].daughters[0];
+          result.decay(d0, {sign * 321, -sign * 211});
+        }
+      }
+    }
+    return result;
+  }
+
+  /// Pairs of tracks from displaced vertices, with a diagonal covariance matrix
+  std::vector<std::array<o2::track::TrackParCov, 2>> trackPairs(int n)
+  {
+    std::exponential_distribution<float> decayLength(1.f / 0.02f);
+    std::uniform_real_distribution<float> direction(-1.f, 1.f);
+    std::exponential_distribution<float> pt(1.f / 1.5f);
+    std::uniform_real_distribution<float> phi(0.f, o2::constants::math::TwoPI);
+    std::uniform_real_distribution<float> eta(-0.8f, 0.8f);
+    const std::array<float, 21> cov{1.e-4f, 0.f, 1.e-4f, 0.f, 0.f, 1.e-4f, 0.f, 0.f, 0.f, 1.e-4f, 0.f, 0.f, 0.f, 0.f, 1.e-4f,
+                                    0.f, 0.f, 0.f, 0.f, 0.f, 1.e-4f};
+    std::vector<std::array<o2::track::TrackParCov, 2>> result;
+    result.reserve(n);
+    for (int i = 0; i < n; i++) {
+      const float length = decayLength(mRandom);
+      const std::array<float, 3> vertex{length * direction(mRandom), length * direction(mRandom), length * direction(mRandom)};
+      std::array<o2::track::TrackParCov, 2> pair;
+      for (int iProng = 0; iProng < 2; iProng++) {
+        const float prongPt = 0.2f + pt(mRandom);
+        const float prongPhi = phi(mRandom);
+        const std::array<float, 3> pVec{prongPt * std::cos(prongPhi), prongPt * std::sin(prongPhi), prongPt * std::sinh(eta(mRandom))};
+        pair[iProng] = o2::track::TrackParCov(vertex, pVec, cov, iProng == 0 ? 1 : -1);
+      }
+      result.push_back(pair);
+    }
+    return result;
+  }
+
+ private:
+  std::mt19937_64 mRandom;
+};
+
+struct BenchmarkResult {
+  std::string name;
+  int64_t iterations;
+  double timePerItem; // ns
+};
+
+/// Repeats func(), which processes nItems items, for at least minTime seconds and returns the time per item
+template <typename F>
+BenchmarkResult measure(std::string const& name, int64_t nItems, F&& func, double minTime = 0.5)
+{
+  func(); // warm-up
+  int64_t iterations = 0;
+  const auto start = std::chrono::steady_clock::now();
+  double elapsed = 0.;
+  do {
+    func();
+    iterations++;
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  } while (elapsed < minTime);
+  BenchmarkResult result{name, iterations * nItems, elapsed * 1.e9 / (iterations * nItems)};
+  LOGF(info, "%-40s %12.2f ns/item (%lld items)", name, result.timePerItem, static_cast<long long>(result.iterations));
+  return result;
+}
+
+void writeJson(std::string const& fileName, uint64_t seed, std::vector<BenchmarkResult> const& results)
+{
+  std::ofstream out(fileName);
+  out << "{\n  \"context\": {\"executable\": \"o2-bench-core-helpers\", \"seed\": " << seed << "},\n  \"benchmarks\": [\n";
+  for (std::size_t i = 0; i < results.size(); i++) {
+    const auto& result = results[i];
+    out << "    {\"name\": \"" << result.name << "\", \"run_type\": \"iteration\", \"iterations\": " << result.iterations
+        << ", \"real_time\": " << result.timePerItem << ", \"cpu_time\": " << result.timePerItem << ", \"time_unit\": \"ns\"}"
+        << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  const std::string outputName = argc > 1 ? argv[1] : "benchmarkCoreHelpers.json";
+  const uint64_t seed = argc > 2 ? std::stoull(argv[2]) : 1;
+  constexpr int NTracks = 100000;
+  constexpr int NCollisions = 10000;
+  constexpr int NPairs = 10000;
+  constexpr int NMcEvents = 1000;
+
+  InputGenerator generator(seed);
+  const auto collisions = generator.collisions(NCollisions);
+  const auto tracks = generator.tracks(NTracks);
+  const auto pairs = generator.trackPairs(NPairs);
+  const auto mcParticles = generator.mcParticles(NMcEvents);
+  std::vector<BenchmarkResult> results;
+  double sink = 0.; // result accumulator, prevents the removal of the measured code
+
+  // RecoDecay kinematics
+  const std::array<double, 2> massesPiK{o2::constants::physics::MassPiPlus, o2::constants::physics::MassKPlus};
+  results.push_back(measure("RecoDecay/m_2prong", NTracks - 1, [&]() {
+    for (int i = 0; i < NTracks - 1; i++) {
+      sink += RecoDecay::m(std::array{tracks[i].pVec, tracks[i + 1].pVec}, massesPiK);
+    }
+  }));
+  results.push_back(measure("RecoDecay/pt_eta_phi", NTracks, [&]() {
+    for (const auto& track : tracks) {
+      sink += RecoDecay::pt(track.pVec) + RecoDecay::eta(track.pVec) + RecoDecay::phi(track.pVec);
+    }
+  }));
+  results.push_back(measure("RecoDecay/cpa", NTracks - 1, [&]() {
+    for (int i = 0; i < NTracks - 1; i++) {
+      const auto& collision = collisions[i % NCollisions];
+      sink += RecoDecay::cpa(collision.pos, std::array{0.01f, 0.02f, 0.03f}, RecoDecay::pVec(tracks[i].pVec, tracks[i + 1].pVec));
+    }
+  }));
+
+  // event-mixing binning
+  const std::vector<double> vtxBins{-10., -8., -6., -4., -2., 0., 2., 4., 6., 8., 10.};
+  const std::vector<double> multBins{0., 100., 200., 400., 700., 1000., 1500., 2000., 3000., 5000., 10000.};
+  results.push_back(measure("EventMixing/getMixingBin", NCollisions, [&]() {
+    for (const auto& collision : collisions) {
+      sink += eventmixing::getMixingBin(vtxBins, multBins, static_cast<double>(collision.posZ()), static_cast<double>(collision.multTPC()));
+    }
+  }));
+
+  // TPC PID response, default and full resolution parametrisation
+  o2::pid::tpc::Response response;
+  for (const bool useDefaultResolution : {true, false}) {
+    response.SetUseDefaultResolutionParam(useDefaultResolution);
+    const std::string suffix = useDefaultResolution ? "_defaultReso" : "_fullReso";
+    results.push_back(measure("TPCPIDResponse/nSigma_perSpecies" + suffix, NTracks, [&]() {
+      for (int i = 0; i < NTracks; i++) {
+        for (int id = 0; id < o2::track::PID::NIDs; id++) {
+          sink += response.GetNumberOfSigma(collisions[i % NCollisions], tracks[i], static_cast<o2::track::PID::ID>(id));
+        }
+      }
+    }));
+    results.push_back(measure("TPCPIDResponse/nSigma_allSpecies" + suffix, NTracks, [&]() {
+      std::array<float, o2::track::PID::NIDs> expSignal, expSigma, nSigma;
+      for (int i = 0; i < NTracks; i++) {
+        response.GetExpectedSignalAndSigmaAllSpecies(collisions[i % NCollisions], tracks[i], expSignal, expSigma);
+        o2::pid::tpc::Response::GetNumberOfSigmaAllSpecies(tracks[i].tpcSignal(), expSignal, expSigma, nSigma);
+        sink += nSigma[o2::track::PID::Pion];
+      }
+    }));
+  }
+
+  // TOF PID response with the default resolution parametrisation, per species and all species
+  o2::pid::tof::TOFResoParamsV3 tofParameters;
+  tofParameters.setResolutionParametrization(std::unordered_map<std::string, float>{});
+  using TOFResponsePion = o2::pid::tof::ExpTimes<SyntheticTrack, o2::track::PID::Pion>;
+  using TOFResponseKaon = o2::pid::tof::ExpTimes<SyntheticTrack, o2::track::PID::Kaon>;
+  using TOFResponseProton = o2::pid::tof::ExpTimes<SyntheticTrack, o2::track::PID::Proton>;
+  results.push_back(measure("TOFPIDResponse/expectedSignal_piKp", NTracks, [&]() {
+    for (const auto& track : tracks) {
+      sink += TOFResponsePion::GetCorrectedExpectedSignal(tofParameters, track) + TOFResponseKaon::GetCorrectedExpectedSignal(tofParameters, track) +
+              TOFResponseProton::GetCorrectedExpectedSignal(tofParameters, track);
+    }
+  }));
+  results.push_back(measure("TOFPIDResponse/nSigma_piKp", NTracks, [&]() {
+    for (const auto& track : tracks) {
+      sink += TOFResponsePion::GetSeparation(tofParameters, track) + TOFResponseKaon::GetSeparation(tofParameters, track) +
+              TOFResponseProton::GetSeparation(tofParameters, track);
+    }
+  }));
+  results.push_back(measure("TOFPIDResponse/nSigma_allSpecies", NTracks, [&]() {
+    std::array<float, o2::track::PID::NIDs> expSigma, nSigma;
+    for (const auto& track : tracks) {
+      o2::pid::tof::ExpTimesAllSpecies<SyntheticTrack>::GetExpectedSigmaAndSeparation(tofParameters, track, o2::pid::tof::ExpTimesAllSpecies<SyntheticTrack>::AllSpecies, expSigma, nSigma);
+      sink += nSigma[o2::track::PID::Pion];
+    }
+  }));
+
+  // 2-prong vertexing with the settings of the HF candidate creators
+  o2::vertexing::DCAFitterN<2> df;
+  df.setBz(5.f);
+  df.setPropagateToPCA(true);
+  df.setMaxR(200.);
+  df.setMaxDZIni(4.);
+  df.setMinParamChange(1.e-3);
+  df.setMinRelChi2Change(0.9);
+  df.setUseAbsDCA(false);
+  results.push_back(measure("DCAFitterN/process_2prong", NPairs, [&]() {
+    for (const auto& pair : pairs) {
+      if (df.process(pair[0], pair[1]) > 0) {
+        sink += df.getPCACandidatePos()[0];
+      }
+    }
+  }));
+
+  // MC genealogy: index build with the D0 mother search of the final-state kaons, and the D0 daughters
+  McAncestryIndex mcIndex;
+  results.push_back(measure("McAncestryIndex/build_getMother", mcParticles.size(), [&]() {
+    mcIndex.build(mcParticles);
+    int8_t sign = 0;
+    for (const auto& particle : mcParticles) {
+      if (std::abs(particle.pdg) == 321 && particle.has_mothers()) {
+        sink += mcIndex.getMother(particle.index, 421, true, &sign, 2);
+      }
+    }
+  }));
+  std::vector<int64_t> d0Indices;
+  for (const auto& particle : mcParticles) {
+    if (std::abs(particle.pdg) == 421) {
+      d0Indices.push_back(particle.index);
+    }
+  }
+  std::vector<int> daughters;
+  results.push_back(measure("McAncestryIndex/getDaughters_D0", d0Indices.size(), [&]() {
+    for (const auto& index : d0Indices) {
+      daughters.clear();
+      mcIndex.getDaughters(index, &daughters, std::array{0}, 1);
+      sink += daughters.size();
+    }
+  }));
+
+  writeJson(outputName, seed, results);
+  LOG(info) << "Results written to " << outputName << " (checksum " << sink << ")";
+  return 0;
+}
@@ -740,6 +740,24 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   fBinsAllocated += bins;
 }
 
+//__________________________________________________________________
+HistogramManager::HistClassHandle HistogramManager::GetHistClassHandle(const char* className) const
+{
+  //
+  //  get the histogram list of a class and the identifiers of its variables
+  //
+  HistClassHandle handle;
+  auto varList = fVariablesMap.find(className);
+  if (varList == fVariablesMap.end()) {
+    return handle;
+  }
+  handle.fList = reinterpret_cast<TList*>(fMainList->FindObject(className));
+  if (handle.fList) {
+    handle.fVariables = &(varList->second);
+  }
+  return handle;
+}
+
 //__________________________________________________________________
 void HistogramManager::FillHistClass(const char* className, Float_t* values)
 {
@@ -747,19 +765,23 @@ void HistogramManager::FillHistClass(const char* className, Float_t* values)
   //  fill a class of histograms
   //
 
-  // get the needed histogram list
-  auto* hList = reinterpret_cast<TList*>(fMainList->FindObject(className));
-  if (!hList) {
-    // TODO: add some meaningfull error message
-    /*LOG(warn) << "HistogramManager::FillHistClass(): Histogram list " << className << " not found!";
-    LOG(warn) << "         Histogram list not filled" << endl; */
+  // get the needed histogram list and the corresponding std::list containng identifiers to the needed variables to be filled
+  // TODO: add some meaningfull error message if the histogram list is not found
+  FillHistClass(GetHistClassHandle(className), values);
+}
+
+//__________________________________________________________________
+void HistogramManager::FillHistClass(const HistClassHandle& handle, Float_t* values)
+{
+  //
+  //  fill a class of histograms, from a handle obtained with GetHistClassHandle()
+  //
+  if (!handle.fList) {
     return;
   }
+  const auto& varList = *handle.fVariables;
 
-  // get the corresponding std::list containng identifiers to the needed variables to be filled
-  list varList = fVariablesMap[className];
-
-  TIter next(hList);
+  TIter next(handle.fList);
 
   TObject* h = nullptr;
   bool isProfile;
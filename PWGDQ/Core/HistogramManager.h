@@ -84,7 +84,17 @@ class HistogramManager : public TNamed
                     int nDimensions, int* vars, TArrayD* binLimits,
                     TString* axLabels = nullptr, int varW = -1, bool useSparse = kFALSE, bool isdouble = false);
 
+  // Handle to a histogram class, to fill it repeatedly without looking it up by name (e.g. in pair loops)
+  // The handle is valid once the histograms of the class are defined; it is empty if the class does not exist
+  struct HistClassHandle {
+    TList* fList = nullptr;                                  // histograms of the class
+    const std::list<std::vector<int>>* fVariables = nullptr; // identifiers of the variables of each histogram
+  };
+  HistClassHandle GetHistClassHandle(const char* className) const;
+
   void FillHistClass(const char* className, float* values);
+  // Same as above, no-op for an empty handle
+  void FillHistClass(const HistClassHandle& handle, float* values);
 
   void SetUseDefaultVariableNames(bool flag) { fUseDefaultVariableNames = flag; }
   void SetDefaultVarNames(TString* vars, TString* units);
@@ -116,6 +116,34 @@ class MCSignal : public TNamed
     return CheckMC(0, checkSources, args...);
   };
 
+  // Check of a single prong, without the common ancestor match with the other prongs.
+  // ancestorLabel is set to the global index of the particle at the common ancestor generation of this prong (-1 if none).
+  // CheckSignal(checkSources, p_0, ..., p_N) is equivalent to CheckProngAlone(i, checkSources, p_i, a_i) for all prongs
+  //   and CheckCommonAncestors({a_0, ..., a_N}), which allows to cache the prong decisions per particle.
+  template <typename T>
+  bool CheckProngAlone(int i, bool checkSources, const T& track, int& ancestorLabel)
+  {
+    ancestorLabel = -1;
+    return CheckProng(i, checkSources, track, &ancestorLabel);
+  }
+
+  // Check of the common ancestor requirement, given the ancestor labels of the prongs from CheckProngAlone()
+  bool CheckCommonAncestors(const int* ancestorLabels) const
+  {
+    if (fNProngs < 2) {
+      return true;
+    }
+    for (unsigned int i = 1; i < fNProngs; i++) {
+      if (fCommonAncestorIdxs[i] < 0 || fCommonAncestorIdxs[i] >= fProngs[i].fNGenerations) {
+        continue;
+      }
+      if ((ancestorLabels[i] == ancestorLabels[0]) == fExcludeCommonAncestor) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   void PrintConfig();
 
  private:
@@ -129,7 +157,7 @@ class MCSignal : public TNamed
   int fTempAncestorLabel;
 
   template <typename T>
-  bool CheckProng(int i, bool checkSources, const T& track);
+  bool CheckProng(int i, bool checkSources, const T& track, int* ancestorLabel = nullptr);
 
   bool CheckMC(int, bool)
   {
@@ -149,7 +177,7 @@ class MCSignal : public TNamed
 };
 
 template <typename T>
-bool MCSignal::CheckProng(int i, bool checkSources, const T& track)
+bool MCSignal::CheckProng(int i, bool checkSources, const T& track, int* ancestorLabel)
 {
   using P = typename T::parent_t;
   auto currentMCParticle = track;
@@ -162,6 +190,9 @@ bool MCSignal::CheckProng(int i, bool checkSources, const T& track)
     }
     // check the common ancestor (if specified)
     if (fNProngs > 1 && fCommonAncestorIdxs[i] == j) {
+      if (ancestorLabel) {
+        *ancestorLabel = currentMCParticle.globalIndex();
+      }
       if (i == 0) {
         fTempAncestorLabel = currentMCParticle.globalIndex();
         // In the case of decay channels marked as being "exclusive", check how many decay daughters this mother has registered
@@ -176,7 +207,7 @@ bool MCSignal::CheckProng(int i, bool checkSources, const T& track)
             return false;
           }
         }
-      } else {
+      } else if (!ancestorLabel) {
         if (currentMCParticle.globalIndex() != fTempAncestorLabel && !fExcludeCommonAncestor)
           return false;
         else if (currentMCParticle.globalIndex() == fTempAncestorLabel && fExcludeCommonAncestor)
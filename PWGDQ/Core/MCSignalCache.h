@@ -0,0 +1,134 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Contact: iarsene@cern.ch, i.c.arsene@fys.uio.no
+//
+// Per-DataFrame cache of the single-prong decisions of a list of MC signals.
+//
+// Each prong of each signal is evaluated at most once per MC particle (MCSignal::CheckProngAlone), when the particle
+// is first used in a pair or triplet. The decision bits and the common ancestor labels are stored per particle,
+// so that the matching of pairs and triplets reduces to bit tests and a comparison of the ancestor labels
+// (MCSignal::CheckCommonAncestors), with the same result as MCSignal::CheckSignal.
+//
+// Usage: init() with the signals, reset() with the size of the MC particle table at the beginning of each DataFrame,
+// then GetDecisions(p1, p2[, p3]) returns the bit map of the matched signals, as built from CheckSignal.
+
+#ifndef PWGDQ_CORE_MCSIGNALCACHE_H_
+#define PWGDQ_CORE_MCSIGNALCACHE_H_
+
+#include "PWGDQ/Core/MCSignal.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class MCSignalCache
+{
+ public:
+  static constexpr int MaxProngs = 3;
+
+  // signals: the bit i of the decisions corresponds to signals[i]
+  void init(std::vector<MCSignal*> const& signals, bool checkSources = true)
+  {
+    fSignals = signals;
+    fCheckSources = checkSources;
+    fFirstSlot.clear();
+    fNSlots = 0;
+    for (const auto& signal : fSignals) {
+      fFirstSlot.push_back(fNSlots);
+      fNSlots += signal->GetNProngs();
+    }
+    fNWords = (fNSlots + 63) / 64;
+    fStamps.clear();
+    fStamp = 0;
+  }
+
+  // Invalidates the cached decisions, to be called for each new MC particle table
+  void reset(int64_t nParticles)
+  {
+    fStamp++;
+    if (static_cast<int64_t>(fStamps.size()) < nParticles || fStamp == 0) {
+      fStamps.assign(nParticles, 0);
+      fBits.resize(nParticles * fNWords);
+      fAncestors.resize(nParticles * fNSlots);
+      fStamp = 1;
+    }
+  }
+
+  // Bit map of the signals with sizeof...(T) prongs matched by the particles, as from MCSignal::CheckSignal
+  template <typename... T>
+  uint32_t GetDecisions(const T&... particles)
+  {
+    constexpr int nProngs = sizeof...(T);
+    static_assert(nProngs <= MaxProngs, "Too many prongs");
+    const std::array<int64_t, nProngs> rows{Evaluate(particles)...};
+    uint32_t decisions = 0;
+    std::array<int, MaxProngs> ancestors{};
+    for (std::size_t iSig = 0; iSig < fSignals.size() && iSig < 32; iSig++) {
+      if (fSignals[iSig]->GetNProngs() != nProngs) {
+        continue;
+      }
+      bool matched = true;
+      for (int i = 0; i < nProngs && matched; i++) {
+        const int slot = fFirstSlot[iSig] + i;
+        matched = (fBits[rows[i] * fNWords + slot / 64] >> (slot % 64)) & 1;
+        ancestors[i] = fAncestors[rows[i] * fNSlots + slot];
+      }
+      if (matched && fSignals[iSig]->CheckCommonAncestors(ancestors.data())) {
+        decisions |= (static_cast<uint32_t>(1) << iSig);
+      }
+    }
+    return decisions;
+  }
+
+ private:
+  // Evaluates all prongs of all signals for a particle if not done yet in this DataFrame, returns its row
+  template <typename T>
+  int64_t Evaluate(const T& particle)
+  {
+    const int64_t row = particle.globalIndex();
+    if (row >= static_cast<int64_t>(fStamps.size())) { // table larger than announced in reset()
+      fStamps.resize(row + 1, 0);
+      fBits.resize((row + 1) * fNWords);
+      fAncestors.resize((row + 1) * fNSlots);
+    }
+    if (fStamps[row] == fStamp) {
+      return row;
+    }
+    fStamps[row] = fStamp;
+    uint64_t* bits = &fBits[row * fNWords];
+    for (int w = 0; w < fNWords; w++) {
+      bits[w] = 0;
+    }
+    for (std::size_t iSig = 0; iSig < fSignals.size(); iSig++) {
+      for (int i = 0; i < fSignals[iSig]->GetNProngs(); i++) {
+        const int slot = fFirstSlot[iSig] + i;
+        int& ancestor = fAncestors[row * fNSlots + slot];
+        if (fSignals[iSig]->CheckProngAlone(i, fCheckSources, particle, ancestor)) {
+          bits[slot / 64] |= (static_cast<uint64_t>(1) << (slot % 64));
+        }
+      }
+    }
+    return row;
+  }
+
+  std::vector<MCSignal*> fSignals; // signals, in the order of the decision bits
+  bool fCheckSources = true;       // check the sources of the prongs
+  std::vector<int> fFirstSlot;     // index of the first prong of each signal in the per-particle slots
+  int fNSlots = 0;                 // total number of prongs
+  int fNWords = 0;                 // number of 64-bit words of decision bits per particle
+  std::vector<uint32_t> fStamps;   // per particle, stamp of the DataFrame of the cached decisions
+  uint32_t fStamp = 0;             // stamp of the current DataFrame
+  std::vector<uint64_t> fBits;     // per particle, decision bits of the prongs
+  std::vector<int> fAncestors;     // per particle and prong, common ancestor label
+};
+
+#endif // PWGDQ_CORE_MCSIGNALCACHE_H_
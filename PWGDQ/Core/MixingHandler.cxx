@@ -16,6 +16,9 @@
 #include <fstream>
 using namespace std;
 
+#include <algorithm>
+#include <cmath>
+
 #include <TMath.h>
 #include <TTimeStamp.h>
 #include <TRandom.h>
@@ -26,7 +29,12 @@ ClassImp(MixingHandler);
 MixingHandler::MixingHandler() : TNamed(),
                                  fIsInitialized(kFALSE),
                                  fVariableLimits(),
-                                 fVariables()
+                                 fVariables(),
+                                 fNCategories(1),
+                                 fNBins(),
+                                 fStrides(),
+                                 fBinWidth(),
+                                 fVariablePosition()
 {
   //
   // default constructor
@@ -37,7 +45,12 @@ MixingHandler::MixingHandler() : TNamed(),
 MixingHandler::MixingHandler(const char* name, const char* title) : TNamed(name, title),
                                                                     fIsInitialized(kFALSE),
                                                                     fVariableLimits(),
-                                                                    fVariables()
+                                                                    fVariables(),
+                                                                    fNCategories(1),
+                                                                    fNBins(),
+                                                                    fStrides(),
+                                                                    fBinWidth(),
+                                                                    fVariablePosition()
 {
   //
   // Named constructor
@@ -63,17 +76,13 @@ void MixingHandler::AddMixingVariable(int var, int nBins, float* binLims)
   varBins.Set(nBins, binLims);
   fVariableLimits.push_back(varBins);
   VarManager::SetUseVariable(var);
+  UpdateCategoryLookup();
 }
 
 //_________________________________________________________________________
 void MixingHandler::AddMixingVariable(int var, int nBins, std::vector<float> binLims)
 {
-
-  float* bins = new float[nBins];
-  for (int i = 0; i < nBins; ++i) {
-    bins[i] = binLims[i];
-  }
-  AddMixingVariable(var, nBins, bins);
+  AddMixingVariable(var, nBins, binLims.data());
 }
 
 //_________________________________________________________________________
@@ -104,6 +113,70 @@ std::vector<float> MixingHandler::GetMixingVariableLimits(VarManager::Variables
   return binLimits;
 }
 
+//_________________________________________________________________________
+void MixingHandler::UpdateCategoryLookup() const
+{
+  //
+  // Precompute the number of bins, the category strides and the uniform bin widths of the variables,
+  //   such that the category of an event is found without allocation
+  //
+  const int nVars = fVariables.size();
+  fNBins.resize(nVars);
+  fStrides.resize(nVars);
+  fBinWidth.resize(nVars);
+  fVariablePosition.assign(VarManager::kNVars, -1);
+  fNCategories = 1;
+  for (int iVar = nVars - 1; iVar >= 0; --iVar) { // the last variable varies fastest with the category
+    const TArrayF& limits = fVariableLimits[iVar];
+    fNBins[iVar] = limits.GetSize() - 1;
+    fStrides[iVar] = fNCategories;
+    fNCategories *= std::max(fNBins[iVar], 0);
+    if (fVariables[iVar] >= 0 && fVariables[iVar] < VarManager::kNVars) { // the first position is kept for variables added twice
+      fVariablePosition[fVariables[iVar]] = iVar;
+    }
+    // uniform binning: the bin is computed from the width, then checked against the limits
+    fBinWidth[iVar] = 0.0;
+    if (fNBins[iVar] > 0) {
+      const float width = (limits[fNBins[iVar]] - limits[0]) / fNBins[iVar];
+      bool isUniform = width > 0.0;
+      for (int iBin = 1; iBin <= fNBins[iVar] && isUniform; ++iBin) {
+        isUniform = std::abs(limits[iBin] - limits[iBin - 1] - width) < 1.0e-3 * width;
+      }
+      if (isUniform) {
+        fBinWidth[iVar] = width;
+      }
+    }
+  }
+}
+
+//_________________________________________________________________________
+int MixingHandler::FindBin(int iVar, float value) const
+{
+  //
+  // Bin of the value in the limits of the variable iVar, -1 if outside the limits.
+  //   Same result as TMath::BinarySearch on the limits, with the upper limit excluded
+  //
+  const TArrayF& limits = fVariableLimits[iVar];
+  const int nBins = fNBins[iVar];
+  if (nBins <= 0) {
+    return -1;
+  }
+  if (!(value >= limits[0]) || !(value < limits[nBins])) { // also catches NaN
+    return -1;
+  }
+  if (fBinWidth[iVar] > 0.0) {
+    int bin = std::min(static_cast<int>((value - limits[0]) / fBinWidth[iVar]), nBins - 1);
+    while (value < limits[bin]) {
+      --bin;
+    }
+    while (value >= limits[bin + 1]) {
+      ++bin;
+    }
+    return bin;
+  }
+  return TMath::BinarySearch(nBins + 1, limits.GetArray(), value);
+}
+
 //_________________________________________________________________________
 void MixingHandler::Init()
 {
@@ -111,11 +184,7 @@ void MixingHandler::Init()
   // Initialization of pools
   //       The correct event category will be retrieved using the function FindEventCategory()
   //
-  int size = 1;
-  for (auto v : fVariableLimits) {
-    size *= (v.GetSize() - 1);
-  }
-  (void)size;
+  UpdateCategoryLookup();
   fIsInitialized = kTRUE;
 }
 
@@ -128,35 +197,17 @@ int MixingHandler::FindEventCategory(float* values)
   if (fVariables.size() == 0) {
     return -1;
   }
-  if (!fIsInitialized) {
+  if (!fIsInitialized || fNBins.size() != fVariables.size()) {
     Init();
   }
 
-  std::vector<int> bin;
-  int iVar = 0;
-  for (auto v = fVariableLimits.begin(); v != fVariableLimits.end(); v++, iVar++) {
-    int binValue = TMath::BinarySearch((*v).GetSize(), (*v).GetArray(), values[fVariables[iVar]]);
-    bin.push_back(binValue);
-    if (bin[iVar] == -1 || bin[iVar] == (*v).GetSize() - 1) {
-      return -1; // all variables must be inside limits
-    }
-  }
-
   int category = 0;
-  int tempCategory = 1;
-  int iv1 = 0;
-  int iv2 = 0;
-  for (auto v1 = fVariables.begin(); v1 != fVariables.end(); v1++, iv1++) {
-    tempCategory = 1;
-    iv2 = iv1;
-    for (auto v2 = v1; v2 != fVariables.end(); v2++, iv2++) {
-      if (iv2 == iv1) {
-        tempCategory *= bin[iv2];
-      } else {
-        tempCategory *= (fVariableLimits[iv2].GetSize() - 1);
-      }
+  for (std::size_t iVar = 0; iVar < fVariables.size(); ++iVar) {
+    const int bin = FindBin(iVar, values[fVariables[iVar]]);
+    if (bin < 0) {
+      return -1; // all variables must be inside limits
     }
-    category += tempCategory;
+    category += bin * fStrides[iVar];
   }
   return category;
 }
@@ -171,20 +222,16 @@ int MixingHandler::GetBinFromCategory(VarManager::Variables var, int category) c
     return -1;
   }
 
-  // Search for the position of the variable "var" in the internal variable list of the handler
-  int tempVar = 0;
-  for (auto v = fVariables.begin(); v != fVariables.end(); v++, tempVar++) {
-    if (*v == var) {
-      break;
-    }
+  if (fNBins.size() != fVariables.size()) { // e.g. handler read from a file
+    UpdateCategoryLookup();
   }
 
-  // extract the bin position in variable "var" from the category
-  int norm = 1;
-  for (int i = fVariables.size() - 1; i > tempVar; --i) {
-    norm *= (fVariableLimits[i].GetSize() - 1);
+  // position of the variable "var" in the internal variable list of the handler
+  if (var < 0 || var >= static_cast<int>(fVariablePosition.size()) || fVariablePosition[var] < 0) {
+    return -1;
   }
-  int truncatedCategory = category - (category % norm);
-  truncatedCategory /= norm;
-  return truncatedCategory % (fVariableLimits[tempVar].GetSize() - 1);
+  const int iVar = fVariablePosition[var];
+
+  // extract the bin position in variable "var" from the category
+  return (category / fStrides[iVar]) % fNBins[iVar];
 }
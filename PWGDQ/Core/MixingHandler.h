@@ -24,6 +24,8 @@
 #include <TList.h>
 #include <TString.h>
 
+#include <vector>
+
 #include "PWGDQ/Core/HistogramManager.h"
 #include "PWGDQ/Core/VarManager.h"
 
@@ -44,7 +46,11 @@ class MixingHandler : public TNamed
   int GetMixingVariable(VarManager::Variables var); // returns the position in the internal varible list of the handler. Useful for checks, mostly
   std::vector<float> GetMixingVariableLimits(VarManager::Variables var);
 
+  int GetNCategories() const { return fNCategories; }
+
   void Init();
+  // the category is published as the mixing hash of the events; the event pools of the DQ readers are
+  // kept by the framework, through selfCombinations on this hash with a configurable depth (cfgMixingDepth)
   int FindEventCategory(float* values);
   int GetBinFromCategory(VarManager::Variables var, int category) const;
 
@@ -58,6 +64,16 @@ class MixingHandler : public TNamed
   std::vector<TArrayF> fVariableLimits;
   std::vector<int> fVariables;
 
+  // category lookup, rebuilt from the variables and their limits by UpdateCategoryLookup()
+  mutable int fNCategories;                   //! product of the number of bins of all variables
+  mutable std::vector<int> fNBins;            //! number of bins of each variable
+  mutable std::vector<int> fStrides;          //! step of the category for one bin of each variable
+  mutable std::vector<float> fBinWidth;       //! bin width of each variable with uniform bins, 0 otherwise
+  mutable std::vector<int> fVariablePosition; //! position in fVariables of each VarManager variable, -1 if not used for mixing
+
+  void UpdateCategoryLookup() const;
+  int FindBin(int iVar, float value) const;
+
   ClassDef(MixingHandler, 1);
 };
 
@@ -42,6 +42,7 @@
 #include "PWGDQ/Core/CutsLibrary.h"
 #include "PWGDQ/Core/MixingLibrary.h"
 #include "PWGDQ/Core/MCSignal.h"
+#include "PWGDQ/Core/MCSignalCache.h"
 #include "PWGDQ/Core/MCSignalLibrary.h"
 #include "DataFormatsParameters/GRPMagField.h"
 #include "Field/MagneticField.h"
@@ -1321,6 +1322,7 @@ struct AnalysisSameEventPairing {
   std::map<int, std::vector<TString>> fMuonHistNames;
   std::map<int, std::vector<TString>> fMuonHistNamesMCmatched;
   std::vector<MCSignal*> fRecMCSignals;
+  MCSignalCache fRecMCSignalCache; // per MC particle decisions of the fRecMCSignals prongs
   std::vector<MCSignal*> fGenMCSignals;
 
   std::vector<AnalysisCompositeCut> fPairCuts;
@@ -1396,6 +1398,7 @@ struct AnalysisSameEventPairing {
         fRecMCSignals.push_back(mcIt);
       }
     }
+    fRecMCSignalCache.init(fRecMCSignals);
 
     // get the barrel track selection cuts
     string tempCuts;
@@ -1680,12 +1683,13 @@ struct AnalysisSameEventPairing {
 
   // Template function to run same event pairing (barrel-barrel, muon-muon, barrel-muon)
   template <bool TTwoProngFitter, int TPairType, uint32_t TEventFillMap, uint32_t TTrackFillMap, typename TEvents, typename TTrackAssocs, typename TTracks>
-  void runSameEventPairing(TEvents const& events, Preslice<TTrackAssocs>& preslice, TTrackAssocs const& assocs, TTracks const& /*tracks*/, ReducedMCEvents const& /*mcEvents*/, ReducedMCTracks const& /*mcTracks*/)
+  void runSameEventPairing(TEvents const& events, Preslice<TTrackAssocs>& preslice, TTrackAssocs const& assocs, TTracks const& /*tracks*/, ReducedMCEvents const& /*mcEvents*/, ReducedMCTracks const& mcTracks)
   {
     if (fCurrentRun != events.begin().runNumber()) {
       initParamsFromCCDB(events.begin().timestamp(), TTwoProngFitter);
       fCurrentRun = events.begin().runNumber();
     }
+    fRecMCSignalCache.reset(mcTracks.size());
 
     TString cutNames = fConfigCuts.track.value;
     std::map<int, std::vector<TString>> histNames = fTrackHistNames;
@@ -1763,16 +1767,9 @@ struct AnalysisSameEventPairing {
           }
 
           // run MC matching for this pair
-          int isig = 0;
           mcDecision = 0;
-          for (auto sig = fRecMCSignals.begin(); sig != fRecMCSignals.end(); sig++, isig++) {
-            if (t1.has_reducedMCTrack() && t2.has_reducedMCTrack()) {
-              if ((*sig)->CheckSignal(true, t1.reducedMCTrack(), t2.reducedMCTrack())) {
-                mcDecision |= (static_cast<uint32_t>(1) << isig);
-              }
-            }
-          } // end loop over MC signals
           if (t1.has_reducedMCTrack() && t2.has_reducedMCTrack()) {
+            mcDecision = fRecMCSignalCache.GetDecisions(t1.reducedMCTrack(), t2.reducedMCTrack());
             isCorrectAssoc_leg1 = (t1.reducedMCTrack().reducedMCevent() == event.reducedMCevent());
             isCorrectAssoc_leg2 = (t2.reducedMCTrack().reducedMCevent() == event.reducedMCevent());
           }
@@ -1830,17 +1827,9 @@ struct AnalysisSameEventPairing {
           }
 
           // run MC matching for this pair
-          int isig = 0;
           mcDecision = 0;
-          for (auto sig = fRecMCSignals.begin(); sig != fRecMCSignals.end(); sig++, isig++) {
-            if (t1.has_reducedMCTrack() && t2.has_reducedMCTrack()) {
-              if ((*sig)->CheckSignal(true, t1.reducedMCTrack(), t2.reducedMCTrack())) {
-                mcDecision |= (static_cast<uint32_t>(1) << isig);
-              }
-            }
-          } // end loop over MC signals
-
           if (t1.has_reducedMCTrack() && t2.has_reducedMCTrack()) {
+            mcDecision = fRecMCSignalCache.GetDecisions(t1.reducedMCTrack(), t2.reducedMCTrack());
             isCorrectAssoc_leg1 = (t1.reducedMCTrack().reducedMCevent() == event.reducedMCevent());
             isCorrectAssoc_leg2 = (t2.reducedMCTrack().reducedMCevent() == event.reducedMCevent());
           }
@@ -2256,6 +2245,7 @@ struct AnalysisAsymmetricPairing {
   int fNPairHistPrefixes;
 
   std::vector<MCSignal*> fRecMCSignals;
+  MCSignalCache fRecMCSignalCache; // per MC particle decisions of the fRecMCSignals prongs
   std::vector<MCSignal*> fGenMCSignals;
 
   // Filter masks to find legs in BarrelTrackCuts table
@@ -2353,6 +2343,7 @@ struct AnalysisAsymmetricPairing {
         sigNamesStr += Form(",%s", mcIt->GetName());
       }
     }
+    fRecMCSignalCache.init(fRecMCSignals);
     // Put all the reco MCSignal names in the vector for histogram naming
     std::unique_ptr<TObjArray> objArrayRecMCSignals(sigNamesStr.Tokenize(","));
     for (int i = 0; i < objArrayRecMCSignals->GetEntries(); i++) {
@@ -2683,9 +2674,10 @@ struct AnalysisAsymmetricPairing {
 
   // Template function to run same event pairing with asymmetric pairs (e.g. kaon-pion)
   template <bool TTwoProngFitter, int TPairType, uint32_t TEventFillMap, uint32_t TTrackFillMap, typename TEvents, typename TTrackAssocs, typename TTracks>
-  void runAsymmetricPairing(TEvents const& events, Preslice<TTrackAssocs>& preslice, TTrackAssocs const& /*assocs*/, TTracks const& /*tracks*/, ReducedMCEvents const& /*mcEvents*/, ReducedMCTracks const& /*mcTracks*/)
+  void runAsymmetricPairing(TEvents const& events, Preslice<TTrackAssocs>& preslice, TTrackAssocs const& /*assocs*/, TTracks const& /*tracks*/, ReducedMCEvents const& /*mcEvents*/, ReducedMCTracks const& mcTracks)
   {
     fPairCount.clear();
+    fRecMCSignalCache.reset(mcTracks.size());
 
     if (events.size() > 0) { // Additional protection to avoid crashing of events.begin().runNumber()
       if (fCurrentRun != events.begin().runNumber()) {
@@ -2776,16 +2768,13 @@ struct AnalysisAsymmetricPairing {
         }
 
         // run MC matching for this pair
-        int isig = 0;
         mcDecision = 0;
-        for (auto sig = fRecMCSignals.begin(); sig != fRecMCSignals.end(); sig++, isig++) {
-          if (t1.has_reducedMCTrack() && t2.has_reducedMCTrack()) {
+        if (t1.has_reducedMCTrack() && t2.has_reducedMCTrack()) {
+          if (!fRecMCSignals.empty()) {
             VarManager::FillPairMC<TPairType>(t1.reducedMCTrack(), t2.reducedMCTrack());
-            if ((*sig)->CheckSignal(true, t1.reducedMCTrack(), t2.reducedMCTrack())) {
-              mcDecision |= static_cast<uint32_t>(1) << isig;
-            }
           }
-        } // end loop over MC signals
+          mcDecision = fRecMCSignalCache.GetDecisions(t1.reducedMCTrack(), t2.reducedMCTrack());
+        }
 
         VarManager::FillPair<TPairType, TTrackFillMap>(t1, t2);
         if constexpr (TTwoProngFitter) {
@@ -2942,8 +2931,9 @@ struct AnalysisAsymmetricPairing {
 
   // Template function to run same event triplets (e.g. D+->K-pi+pi+)
   template <bool TThreeProngFitter, uint32_t TEventFillMap, uint32_t TTrackFillMap, typename TEvents, typename TTrackAssocs, typename TTracks>
-  void runThreeProng(TEvents const& events, Preslice<TTrackAssocs>& preslice, TTrackAssocs const& /*assocs*/, TTracks const& tracks, ReducedMCEvents const& /*mcEvents*/, ReducedMCTracks const& /*mcTracks*/, VarManager::PairCandidateType tripletType)
+  void runThreeProng(TEvents const& events, Preslice<TTrackAssocs>& preslice, TTrackAssocs const& /*assocs*/, TTracks const& tracks, ReducedMCEvents const& /*mcEvents*/, ReducedMCTracks const& mcTracks, VarManager::PairCandidateType tripletType)
   {
+    fRecMCSignalCache.reset(mcTracks.size());
     if (events.size() > 0) { // Additional protection to avoid crashing of events.begin().runNumber()
       if (fCurrentRun != events.begin().runNumber()) {
         initParamsFromCCDB(events.begin().timestamp(), true);
@@ -3058,15 +3048,10 @@ struct AnalysisAsymmetricPairing {
     }
 
     // run MC matching for this triplet
-    int isig = 0;
     mcDecision = 0;
-    for (auto sig = fRecMCSignals.begin(); sig != fRecMCSignals.end(); sig++, isig++) {
-      if (t1.has_reducedMCTrack() && t2.has_reducedMCTrack() && t3.has_reducedMCTrack()) {
-        if ((*sig)->CheckSignal(true, t1.reducedMCTrack(), t2.reducedMCTrack(), t3.reducedMCTrack())) {
-          mcDecision |= (static_cast<uint32_t>(1) << isig);
-        }
-      }
-    } // end loop over MC signals
+    if (t1.has_reducedMCTrack() && t2.has_reducedMCTrack() && t3.has_reducedMCTrack()) {
+      mcDecision = fRecMCSignalCache.GetDecisions(t1.reducedMCTrack(), t2.reducedMCTrack(), t3.reducedMCTrack());
+    }
 
     VarManager::FillTriple(t1, t2, t3, VarManager::fgValues, tripletType);
     if constexpr (TThreeProngFitter) {
@@ -3272,6 +3257,7 @@ struct AnalysisDileptonTrack {
   HistogramManager* fHistMan;
 
   std::vector<MCSignal*> fRecMCSignals;
+  MCSignalCache fRecMCSignalCache; // per MC particle decisions of the fRecMCSignals prongs
   std::vector<MCSignal*> fGenMCSignals;
 
   void init(o2::framework::InitContext& context)
@@ -3327,6 +3313,7 @@ struct AnalysisDileptonTrack {
         fRecMCSignals.push_back(mcIt);
       }
     }
+    fRecMCSignalCache.init(fRecMCSignals);
 
     // Add histogram classes for each specified MCsignal at the generator level
     // TODO: create a std::vector of hist classes to be used at Fill time, to avoid using Form in the process function
@@ -3601,7 +3588,6 @@ struct AnalysisDileptonTrack {
     VarManager::FillEvent<VarManager::ObjTypes::ReducedEventMC>(event.reducedMCevent(), fValuesDilepton);
 
     uint32_t mcDecision = static_cast<uint32_t>(0);
-    size_t isig = 0;
 
     for (auto dilepton : dileptons) {
       // get full track info of tracks based on the index
@@ -3667,13 +3653,7 @@ struct AnalysisDileptonTrack {
           VarManager::FillDileptonTrackVertexing<TCandidateType, TEventFillMap, TTrackFillMap>(event, lepton1, lepton2, track, fValuesHadron);
 
           auto trackMC = track.reducedMCTrack();
-          mcDecision = 0;
-          isig = 0;
-          for (auto sig = fRecMCSignals.begin(); sig != fRecMCSignals.end(); sig++, isig++) {
-            if ((*sig)->CheckSignal(true, lepton1MC, lepton2MC, trackMC)) {
-              mcDecision |= (static_cast<uint32_t>(1) << isig);
-            }
-          }
+          mcDecision = fRecMCSignalCache.GetDecisions(lepton1MC, lepton2MC, trackMC);
           // table to be written out for ML analysis
           BmesonsTable(fValuesHadron[VarManager::kPairMass], dilepton.mass(), fValuesHadron[VarManager::kDeltaMass], fValuesHadron[VarManager::kPairPt],
                        fValuesHadron[VarManager::kVertexingLxy], fValuesHadron[VarManager::kVertexingLxyz], fValuesHadron[VarManager::kVertexingLz],
@@ -3709,13 +3689,7 @@ struct AnalysisDileptonTrack {
           VarManager::FillDileptonTrackVertexing<TCandidateType, TEventFillMap, TTrackFillMap>(event, lepton1, lepton2, track, fValuesHadron);
 
           auto trackMC = track.reducedMCTrack();
-          mcDecision = 0;
-          isig = 0;
-          for (auto sig = fRecMCSignals.begin(); sig != fRecMCSignals.end(); sig++, isig++) {
-            if ((*sig)->CheckSignal(true, lepton1MC, lepton2MC, trackMC)) {
-              mcDecision |= (static_cast<uint32_t>(1) << isig);
-            }
-          }
+          mcDecision = fRecMCSignalCache.GetDecisions(lepton1MC, lepton2MC, trackMC);
         }
 
         if constexpr (TCandidateType == VarManager::kBcToThreeMuons) {
@@ -3733,13 +3707,7 @@ struct AnalysisDileptonTrack {
           VarManager::FillDileptonTrackVertexing<TCandidateType, TEventFillMap, TTrackFillMap>(event, lepton1, lepton2, track, fValuesHadron);
 
           auto trackMC = track.reducedMCTrack();
-          mcDecision = 0;
-          isig = 0;
-          for (auto sig = fRecMCSignals.begin(); sig != fRecMCSignals.end(); sig++, isig++) {
-            if ((*sig)->CheckSignal(true, lepton1MC, lepton2MC, trackMC)) {
-              mcDecision |= (static_cast<uint32_t>(1) << isig);
-            }
-          }
+          mcDecision = fRecMCSignalCache.GetDecisions(lepton1MC, lepton2MC, trackMC);
         }
 
         // Fill histograms for the triplets
@@ -3819,6 +3787,7 @@ struct AnalysisDileptonTrack {
       initParamsFromCCDB(events.begin().timestamp());
       fCurrentRun = events.begin().runNumber();
     } // end: runNumber
+    fRecMCSignalCache.reset(mcTracks.size());
     for (auto& event : events) {
       if (!event.isEventSelected_bit(0)) {
         continue;
@@ -3842,6 +3811,7 @@ struct AnalysisDileptonTrack {
       initParamsFromCCDB(events.begin().timestamp());
       fCurrentRun = events.begin().runNumber();
     } // end: runNumber
+    fRecMCSignalCache.reset(mcTracks.size());
     for (auto& event : events) {
       auto groupedBarrelAssocs = assocs.sliceBy(trackAssocsPerCollision, event.globalIndex());
       auto groupedDitracks = ditracks.sliceBy(ditracksPerCollision, event.globalIndex());
@@ -3865,6 +3835,7 @@ struct AnalysisDileptonTrack {
       initParamsFromCCDB(events.begin().timestamp());
       fCurrentRun = events.begin().runNumber();
     } // end: runNumber
+    fRecMCSignalCache.reset(mcTracks.size());
     for (auto& event : events) {
       if (!event.isEventSelected_bit(0)) {
         continue;
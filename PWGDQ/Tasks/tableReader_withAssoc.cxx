@@ -1232,13 +1232,42 @@ struct AnalysisSameEventPairing {
   HistogramManager* fHistMan;
 
   // keep histogram class names in maps, so we don't have to buld their names in the pair loops
-  std::map<int, std::vector<TString>> fTrackHistNames;
-  std::map<int, std::vector<TString>> fMuonHistNames;
   std::map<int, std::vector<TString>> fTrackMuonHistNames;
   std::vector<AnalysisCompositeCut> fPairCuts;
   std::vector<TString> fTrackCuts;
+  std::vector<TString> fMuonCuts;
   std::map<std::pair<uint32_t, uint32_t>, uint32_t> fAmbiguousPairs;
 
+  // histogram classes of the pairs, resolved at init for each combination of leg cut, pair cut, sign and ambiguity,
+  //   so that the pair loops fill them without composing or looking up class names
+  enum PairHistSign {
+    kPairPM = 0,
+    kPairPP,
+    kPairMM,
+    kNPairSigns
+  };
+  enum PairHistCategory {
+    kPairAll = 0,
+    kPairAmbiguousExtra,
+    kPairAmbiguousInBunch,
+    kPairAmbiguousOutOfBunch,
+    kPairUnambiguous,
+    kNPairCategories
+  };
+  struct PairHistTable {
+    int nPairCuts = 0;
+    std::vector<HistogramManager::HistClassHandle> handles; // [leg cut][pair cut + 1][sign][category], pair cut -1 is no pair cut
+    int index(int icut, int iPairCut, int sign, int category) const
+    {
+      return ((icut * (nPairCuts + 1) + iPairCut + 1) * kNPairSigns + sign) * kNPairCategories + category;
+    }
+    const HistogramManager::HistClassHandle& get(int icut, int iPairCut, int sign, int category) const { return handles[index(icut, iPairCut, sign, category)]; }
+  };
+  PairHistTable fBarrelSEHists;
+  PairHistTable fBarrelMEHists;
+  PairHistTable fMuonSEHists;
+  PairHistTable fMuonMEHists;
+
   uint32_t fTrackFilterMask; // mask for the track cuts required in this task to be applied on the barrel cuts produced upstream
   uint32_t fMuonFilterMask;  // mask for the muon cuts required in this task to be applied on the muon cuts produced upstream
   int fNCutsBarrel;
@@ -1336,7 +1365,6 @@ struct AnalysisSameEventPairing {
               names.push_back(Form("PairsBarrelMEMM_%s", objArray->At(icut)->GetName()));
               histNames += Form("%s;%s;%s;", names[6].Data(), names[7].Data(), names[8].Data());
             }
-            fTrackHistNames[icut] = names;
 
             TString cutNamesStr = fConfigCuts.pair.value;
             if (!cutNamesStr.IsNull()) { // if pair cuts
@@ -1348,7 +1376,6 @@ struct AnalysisSameEventPairing {
                   Form("PairsBarrelSEPP_%s_%s", objArray->At(icut)->GetName(), objArrayPair->At(iPairCut)->GetName()),
                   Form("PairsBarrelSEMM_%s_%s", objArray->At(icut)->GetName(), objArrayPair->At(iPairCut)->GetName())};
                 histNames += Form("%s;%s;%s;", names[0].Data(), names[1].Data(), names[2].Data());
-                fTrackHistNames[fNCutsBarrel + icut * fNPairCuts + iPairCut] = names;
               } // end loop (pair cuts)
             } // end if (pair cuts)
           } // end if enableBarrelHistos
@@ -1375,6 +1402,7 @@ struct AnalysisSameEventPairing {
       fNCutsMuon = objArray->GetEntries();
       for (int icut = 0; icut < objArray->GetEntries(); ++icut) {
         TString tempStr = objArray->At(icut)->GetName();
+        fMuonCuts.push_back(tempStr);
         if (objArrayMuonCuts->FindObject(tempStr.Data()) != nullptr) {
           fMuonFilterMask |= (static_cast<uint32_t>(1) << icut);
 
@@ -1417,7 +1445,6 @@ struct AnalysisSameEventPairing {
               histNames += Form("%s;%s;%s;", names[18].Data(), names[19].Data(), names[20].Data());
               histNames += Form("%s;%s;%s;", names[21].Data(), names[22].Data(), names[23].Data());
             }
-            fMuonHistNames[icut] = names;
 
             TString cutNamesStr = fConfigCuts.pair.value;
             if (!cutNamesStr.IsNull()) { // if pair cuts
@@ -1429,7 +1456,6 @@ struct AnalysisSameEventPairing {
                   Form("PairsMuonSEPP_%s_%s", objArray->At(icut)->GetName(), objArrayPair->At(iPairCut)->GetName()),
                   Form("PairsMuonSEMM_%s_%s", objArray->At(icut)->GetName(), objArrayPair->At(iPairCut)->GetName())};
                 histNames += Form("%s;%s;%s;", names[0].Data(), names[1].Data(), names[2].Data());
-                fMuonHistNames[fNCutsMuon + icut * fNCutsMuon + iPairCut] = names;
               } // end loop (pair cuts)
             } // end if (pair cuts)
           }
@@ -1499,10 +1525,43 @@ struct AnalysisSameEventPairing {
       dqhistograms::AddHistogramsFromJSON(fHistMan, fConfigAddJSONHistograms.value.c_str());                    // ad-hoc histograms via JSON
       VarManager::SetUseVars(fHistMan->GetUsedVars());                                                          // provide the list of required variables so that VarManager knows what to fill
       fOutputList.setObject(fHistMan->GetMainHistogramList());
+
+      resolvePairHistTable(fBarrelSEHists, "PairsBarrelSE", fTrackCuts, true);
+      resolvePairHistTable(fBarrelMEHists, "PairsBarrelME", fTrackCuts, false);
+      resolvePairHistTable(fMuonSEHists, "PairsMuonSE", fMuonCuts, true);
+      resolvePairHistTable(fMuonMEHists, "PairsMuonME", fMuonCuts, false);
     }
     LOG(info) << "Finished initialization of AnalysisSameEventPairing (idstoreh)";
   }
 
+  // Resolve the histogram classes <prefix><sign><category>_<leg cut>[_<pair cut>] into a table of handles
+  //   Classes which are not defined (e.g. leg cuts not requested in this task) give empty handles, which are not filled
+  void resolvePairHistTable(PairHistTable& table, const char* prefix, std::vector<TString> const& legCuts, bool withPairCuts)
+  {
+    const char* signNames[kNPairSigns] = {"PM", "PP", "MM"};
+    const char* categoryNames[kNPairCategories] = {"", "_ambiguousextra", "_ambiguousInBunch", "_ambiguousOutOfBunch", "_unambiguous"};
+    std::vector<TString> pairCuts;
+    TString pairCutNamesStr = fConfigCuts.pair.value;
+    if (withPairCuts && !pairCutNamesStr.IsNull()) {
+      std::unique_ptr<TObjArray> objArrayPair(pairCutNamesStr.Tokenize(","));
+      for (int iPairCut = 0; iPairCut < objArrayPair->GetEntries(); ++iPairCut) {
+        pairCuts.push_back(objArrayPair->At(iPairCut)->GetName());
+      }
+    }
+    table.nPairCuts = pairCuts.size();
+    table.handles.assign(legCuts.size() * (table.nPairCuts + 1) * kNPairSigns * kNPairCategories, HistogramManager::HistClassHandle{});
+    for (int icut = 0; icut < static_cast<int>(legCuts.size()); icut++) {
+      for (int sign = 0; sign < kNPairSigns; sign++) {
+        for (int category = 0; category < kNPairCategories; category++) {
+          table.handles[table.index(icut, -1, sign, category)] = fHistMan->GetHistClassHandle(Form("%s%s%s_%s", prefix, signNames[sign], categoryNames[category], legCuts[icut].Data()));
+        }
+        for (int iPairCut = 0; iPairCut < table.nPairCuts; iPairCut++) {
+          table.handles[table.index(icut, iPairCut, sign, kPairAll)] = fHistMan->GetHistClassHandle(Form("%s%s_%s_%s", prefix, signNames[sign], legCuts[icut].Data(), pairCuts[iPairCut].Data()));
+        }
+      }
+    }
+  }
+
   void initParamsFromCCDB(uint64_t timestamp, int runNumber, bool withTwoProngFitter = true)
   {
 
@@ -1555,27 +1614,11 @@ struct AnalysisSameEventPairing {
       }
     }
 
-    TString cutNames = fConfigCuts.track.value;
-    std::map<int, std::vector<TString>> histNames = fTrackHistNames;
+    const PairHistTable& histTable = (TPairType == pairTypeMuMu ? fMuonSEHists : fBarrelSEHists);
     int ncuts = fNCutsBarrel;
-    int histIdxOffset = 0;
     if constexpr (TPairType == pairTypeMuMu) {
-      cutNames = fConfigCuts.muon.value;
-      histNames = fMuonHistNames;
       ncuts = fNCutsMuon;
-      if (fEnableMuonMixingHistos) {
-        histIdxOffset = 3;
-      }
-    }
-    if constexpr (TPairType == pairTypeEE) {
-      if (fEnableBarrelMixingHistos) {
-        histIdxOffset = 3;
-      }
     }
-    /*if constexpr (TPairType == pairTypeEMu) {
-      cutNames = fConfigCuts.muon.value;
-      histNames = fTrackMuonHistNames;
-    }*/
 
     uint32_t twoTrackFilter = static_cast<uint32_t>(0);
     uint32_t dileptonMcDecision = static_cast<uint32_t>(0); // placeholder, copy of the dqEfficiency.cxx one
@@ -1781,6 +1824,14 @@ struct AnalysisSameEventPairing {
         }*/
 
         // Fill histograms
+        // evaluate the pair cuts once for all the leg cuts
+        uint32_t pairCutFilter = 0;
+        for (unsigned int iPairCut = 0; iPairCut < fPairCuts.size(); iPairCut++) {
+          if (fPairCuts[iPairCut].IsSelected(VarManager::fgValues)) {
+            pairCutFilter |= (static_cast<uint32_t>(1) << iPairCut);
+          }
+        }
+        const int pairSign = (sign1 * sign2 < 0 ? kPairPM : (sign1 > 0 ? kPairPP : kPairMM));
         bool isAmbiInBunch = false;
         bool isAmbiOutOfBunch = false;
         bool isUnambiguous = false;
@@ -1810,77 +1861,27 @@ struct AnalysisSameEventPairing {
             }
             if (sign1 * sign2 < 0) {
               PromptNonPromptSepTable(VarManager::fgValues[VarManager::kMass], VarManager::fgValues[VarManager::kPt], VarManager::fgValues[VarManager::kVertexingTauxyProjected], VarManager::fgValues[VarManager::kVertexingTauxyProjectedPoleJPsiMass], VarManager::fgValues[VarManager::kVertexingTauzProjected], isAmbiInBunch, isAmbiOutOfBunch);
-              if constexpr (TPairType == VarManager::kDecayToMuMu) {
-                fHistMan->FillHistClass(histNames[icut][0].Data(), VarManager::fgValues);
-                if (isAmbiInBunch) {
-                  fHistMan->FillHistClass(histNames[icut][3 + histIdxOffset].Data(), VarManager::fgValues);
-                }
-                if (isAmbiOutOfBunch) {
-                  fHistMan->FillHistClass(histNames[icut][3 + histIdxOffset + 3].Data(), VarManager::fgValues);
-                }
-                if (isUnambiguous) {
-                  fHistMan->FillHistClass(histNames[icut][3 + histIdxOffset + 6].Data(), VarManager::fgValues);
-                }
+            }
+            fHistMan->FillHistClass(histTable.get(icut, -1, pairSign, kPairAll), VarManager::fgValues);
+            if constexpr (TPairType == VarManager::kDecayToMuMu) {
+              if (isAmbiInBunch) {
+                fHistMan->FillHistClass(histTable.get(icut, -1, pairSign, kPairAmbiguousInBunch), VarManager::fgValues);
               }
-              if constexpr (TPairType == VarManager::kDecayToEE) {
-                fHistMan->FillHistClass(Form("PairsBarrelSEPM_%s", fTrackCuts[icut].Data()), VarManager::fgValues);
-                if (isAmbiExtra) {
-                  fHistMan->FillHistClass(Form("PairsBarrelSEPM_ambiguousextra_%s", fTrackCuts[icut].Data()), VarManager::fgValues);
-                }
+              if (isAmbiOutOfBunch) {
+                fHistMan->FillHistClass(histTable.get(icut, -1, pairSign, kPairAmbiguousOutOfBunch), VarManager::fgValues);
               }
-            } else {
-              if (sign1 > 0) {
-                if constexpr (TPairType == VarManager::kDecayToMuMu) {
-                  fHistMan->FillHistClass(histNames[icut][1].Data(), VarManager::fgValues);
-                  if (isAmbiInBunch) {
-                    fHistMan->FillHistClass(histNames[icut][4 + histIdxOffset].Data(), VarManager::fgValues);
-                  }
-                  if (isAmbiOutOfBunch) {
-                    fHistMan->FillHistClass(histNames[icut][4 + histIdxOffset + 3].Data(), VarManager::fgValues);
-                  }
-                  if (isUnambiguous) {
-                    fHistMan->FillHistClass(histNames[icut][4 + histIdxOffset + 6].Data(), VarManager::fgValues);
-                  }
-                }
-                if constexpr (TPairType == VarManager::kDecayToEE) {
-                  fHistMan->FillHistClass(Form("PairsBarrelSEPP_%s", fTrackCuts[icut].Data()), VarManager::fgValues);
-                  if (isAmbiExtra) {
-                    fHistMan->FillHistClass(Form("PairsBarrelSEPP_ambiguousextra_%s", fTrackCuts[icut].Data()), VarManager::fgValues);
-                  }
-                }
-              } else {
-                if constexpr (TPairType == VarManager::kDecayToMuMu) {
-                  fHistMan->FillHistClass(histNames[icut][2].Data(), VarManager::fgValues);
-                  if (isAmbiInBunch) {
-                    fHistMan->FillHistClass(histNames[icut][5 + histIdxOffset].Data(), VarManager::fgValues);
-                  }
-                  if (isAmbiOutOfBunch) {
-                    fHistMan->FillHistClass(histNames[icut][5 + histIdxOffset + 3].Data(), VarManager::fgValues);
-                  }
-                  if (isUnambiguous) {
-                    fHistMan->FillHistClass(histNames[icut][5 + histIdxOffset + 6].Data(), VarManager::fgValues);
-                  }
-                }
-                if constexpr (TPairType == VarManager::kDecayToEE) {
-                  fHistMan->FillHistClass(Form("PairsBarrelSEMM_%s", fTrackCuts[icut].Data()), VarManager::fgValues);
-                  if (isAmbiExtra) {
-                    fHistMan->FillHistClass(Form("PairsBarrelSEMM_ambiguousextra_%s", fTrackCuts[icut].Data()), VarManager::fgValues);
-                  }
-                }
+              if (isUnambiguous) {
+                fHistMan->FillHistClass(histTable.get(icut, -1, pairSign, kPairUnambiguous), VarManager::fgValues);
               }
             }
-            for (unsigned int iPairCut = 0; iPairCut < fPairCuts.size(); iPairCut++) {
-              AnalysisCompositeCut cut = fPairCuts.at(iPairCut);
-              if (!(cut.IsSelected(VarManager::fgValues))) // apply pair cuts
-                continue;
-              if (sign1 * sign2 < 0) {
-                fHistMan->FillHistClass(histNames[ncuts + icut * ncuts + iPairCut][0].Data(), VarManager::fgValues);
-              } else {
-                if (sign1 > 0) {
-                  fHistMan->FillHistClass(histNames[ncuts + icut * ncuts + iPairCut][1].Data(), VarManager::fgValues);
-                } else {
-                  fHistMan->FillHistClass(histNames[ncuts + icut * ncuts + iPairCut][2].Data(), VarManager::fgValues);
-                }
+            if constexpr (TPairType == VarManager::kDecayToEE) {
+              if (isAmbiExtra) {
+                fHistMan->FillHistClass(histTable.get(icut, -1, pairSign, kPairAmbiguousExtra), VarManager::fgValues);
+              }
+            }
+            for (int iPairCut = 0; iPairCut < histTable.nPairCuts; iPairCut++) {
+              if (pairCutFilter & (static_cast<uint32_t>(1) << iPairCut)) { // apply pair cuts
+                fHistMan->FillHistClass(histTable.get(icut, iPairCut, pairSign, kPairAll), VarManager::fgValues);
               }
             } // end loop (pair cuts)
           }
@@ -1892,7 +1893,7 @@ struct AnalysisSameEventPairing {
   template <int TPairType, uint32_t TEventFillMap, typename TAssoc1, typename TAssoc2, typename TTracks1, typename TTracks2>
   void runMixedPairing(TAssoc1 const& assocs1, TAssoc2 const& assocs2, TTracks1 const& /*tracks1*/, TTracks2 const& /*tracks2*/)
   {
-    std::map<int, std::vector<TString>> histNames = fTrackHistNames;
+    const PairHistTable& histTable = (TPairType == VarManager::kDecayToMuMu ? fMuonMEHists : fBarrelMEHists);
     int pairSign = 0;
     int ncuts = 0;
     uint32_t twoTrackFilter = static_cast<uint32_t>(0);
@@ -1942,7 +1943,6 @@ struct AnalysisSameEventPairing {
             twoTrackFilter |= (static_cast<uint32_t>(1) << 31);
           }
           ncuts = fNCutsMuon;
-          histNames = fMuonHistNames;
 
           if (fConfigOptions.flatTables.value) {
             dimuonAllList(-999., -999., -999., -999.,
@@ -1987,55 +1987,17 @@ struct AnalysisSameEventPairing {
           isAmbiInBunch = (twoTrackFilter & (static_cast<uint32_t>(1) << 28)) || (twoTrackFilter & (static_cast<uint32_t>(1) << 29));
           isAmbiOutOfBunch = (twoTrackFilter & (static_cast<uint32_t>(1) << 30)) || (twoTrackFilter & (static_cast<uint32_t>(1) << 31));
           isUnambiguous = !((twoTrackFilter & (static_cast<uint32_t>(1) << 28)) || (twoTrackFilter & (static_cast<uint32_t>(1) << 29)) || (twoTrackFilter & (static_cast<uint32_t>(1) << 30)) || (twoTrackFilter & (static_cast<uint32_t>(1) << 31)));
-          if (pairSign == 0) {
-            if constexpr (TPairType == VarManager::kDecayToMuMu) {
-              fHistMan->FillHistClass(histNames[icut][3].Data(), VarManager::fgValues);
-              if (isAmbiInBunch) {
-                fHistMan->FillHistClass(histNames[icut][15].Data(), VarManager::fgValues);
-              }
-              if (isAmbiOutOfBunch) {
-                fHistMan->FillHistClass(histNames[icut][18].Data(), VarManager::fgValues);
-              }
-              if (isUnambiguous) {
-                fHistMan->FillHistClass(histNames[icut][21].Data(), VarManager::fgValues);
-              }
+          const int sign = (pairSign == 0 ? kPairPM : (pairSign > 0 ? kPairPP : kPairMM));
+          fHistMan->FillHistClass(histTable.get(icut, -1, sign, kPairAll), VarManager::fgValues);
+          if constexpr (TPairType == VarManager::kDecayToMuMu) {
+            if (isAmbiInBunch) {
+              fHistMan->FillHistClass(histTable.get(icut, -1, sign, kPairAmbiguousInBunch), VarManager::fgValues);
             }
-            if constexpr (TPairType == VarManager::kDecayToEE) {
-              fHistMan->FillHistClass(Form("PairsBarrelMEPM_%s", fTrackCuts[icut].Data()), VarManager::fgValues);
+            if (isAmbiOutOfBunch) {
+              fHistMan->FillHistClass(histTable.get(icut, -1, sign, kPairAmbiguousOutOfBunch), VarManager::fgValues);
             }
-          } else {
-            if (pairSign > 0) {
-              if constexpr (TPairType == VarManager::kDecayToMuMu) {
-                fHistMan->FillHistClass(histNames[icut][4].Data(), VarManager::fgValues);
-                if (isAmbiInBunch) {
-                  fHistMan->FillHistClass(histNames[icut][16].Data(), VarManager::fgValues);
-                }
-                if (isAmbiOutOfBunch) {
-                  fHistMan->FillHistClass(histNames[icut][19].Data(), VarManager::fgValues);
-                }
-                if (isUnambiguous) {
-                  fHistMan->FillHistClass(histNames[icut][22].Data(), VarManager::fgValues);
-                }
-              }
-              if constexpr (TPairType == VarManager::kDecayToEE) {
-                fHistMan->FillHistClass(Form("PairsBarrelMEPP_%s", fTrackCuts[icut].Data()), VarManager::fgValues);
-              }
-            } else {
-              if constexpr (TPairType == VarManager::kDecayToMuMu) {
-                fHistMan->FillHistClass(histNames[icut][5].Data(), VarManager::fgValues);
-                if (isAmbiInBunch) {
-                  fHistMan->FillHistClass(histNames[icut][17].Data(), VarManager::fgValues);
-                }
-                if (isAmbiOutOfBunch) {
-                  fHistMan->FillHistClass(histNames[icut][20].Data(), VarManager::fgValues);
-                }
-                if (isUnambiguous) {
-                  fHistMan->FillHistClass(histNames[icut][23].Data(), VarManager::fgValues);
-                }
-              }
-              if constexpr (TPairType == VarManager::kDecayToEE) {
-                fHistMan->FillHistClass(Form("PairsBarrelMEMM_%s", fTrackCuts[icut].Data()), VarManager::fgValues);
-              }
+            if (isUnambiguous) {
+              fHistMan->FillHistClass(histTable.get(icut, -1, sign, kPairUnambiguous), VarManager::fgValues);
             }
           }
         } // end for (cuts)
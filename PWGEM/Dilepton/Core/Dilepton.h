@@ -57,6 +57,8 @@
 #include <map>
 #include <string>
 #include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -508,7 +510,6 @@ struct Dilepton {
     emh_neg = 0x0;
 
     used_trackIds.clear();
-    used_trackIds.shrink_to_fit();
 
     delete h2sp_resolution;
   }
@@ -864,7 +865,7 @@ struct Dilepton {
 
     float weight = 1.f;
     if (cfgApplyWeightTTCA) {
-      weight = map_weight[std::make_pair(t1.globalIndex(), t2.globalIndex())];
+      weight = map_weight[getPairKey(t1.globalIndex(), t2.globalIndex())];
     }
     if (ev_id == 1) {
       weight = 1.f;
@@ -1051,8 +1052,8 @@ struct Dilepton {
     // store tracks for event mixing without double counting
     if constexpr (ev_id == 0) {
       std::pair<int, int> key_df_collision = std::make_pair(ndf, collision.globalIndex());
-      std::pair<int, int> pair_tmp_id1 = std::make_pair(ndf, t1.globalIndex());
-      std::pair<int, int> pair_tmp_id2 = std::make_pair(ndf, t2.globalIndex());
+      uint64_t pair_tmp_id1 = getPairKey(ndf, t1.globalIndex());
+      uint64_t pair_tmp_id2 = getPairKey(ndf, t2.globalIndex());
 
       std::vector<int> possibleIds1;
       std::vector<int> possibleIds2;
@@ -1061,8 +1062,7 @@ struct Dilepton {
         std::copy(t1.ambiguousElectronsIds().begin(), t1.ambiguousElectronsIds().end(), std::back_inserter(possibleIds1));
         std::copy(t2.ambiguousElectronsIds().begin(), t2.ambiguousElectronsIds().end(), std::back_inserter(possibleIds2));
 
-        if (std::find(used_trackIds.begin(), used_trackIds.end(), pair_tmp_id1) == used_trackIds.end()) {
-          used_trackIds.emplace_back(pair_tmp_id1);
+        if (used_trackIds.insert(pair_tmp_id1).second) {
           if (cfgDoMix) {
             if (t1.sign() > 0) {
               emh_pos->AddTrackToEventPool(key_df_collision, EMTrackWithCov(ndf, t1.globalIndex(), collision.globalIndex(), t1.trackId(), t1.pt(), t1.eta(), t1.phi(), leptonM1, t1.sign(), t1.dcaXY(), t1.dcaZ(), possibleIds1,
@@ -1075,8 +1075,7 @@ struct Dilepton {
             }
           }
         }
-        if (std::find(used_trackIds.begin(), used_trackIds.end(), pair_tmp_id2) == used_trackIds.end()) {
-          used_trackIds.emplace_back(pair_tmp_id2);
+        if (used_trackIds.insert(pair_tmp_id2).second) {
           if (cfgDoMix) {
             if (t2.sign() > 0) {
               emh_pos->AddTrackToEventPool(key_df_collision, EMTrackWithCov(ndf, t2.globalIndex(), collision.globalIndex(), t2.trackId(), t2.pt(), t2.eta(), t2.phi(), leptonM2, t2.sign(), t2.dcaXY(), t2.dcaZ(), possibleIds2,
@@ -1093,8 +1092,7 @@ struct Dilepton {
         std::copy(t1.ambiguousMuonsIds().begin(), t1.ambiguousMuonsIds().end(), std::back_inserter(possibleIds1));
         std::copy(t2.ambiguousMuonsIds().begin(), t2.ambiguousMuonsIds().end(), std::back_inserter(possibleIds2));
 
-        if (std::find(used_trackIds.begin(), used_trackIds.end(), pair_tmp_id1) == used_trackIds.end()) {
-          used_trackIds.emplace_back(pair_tmp_id1);
+        if (used_trackIds.insert(pair_tmp_id1).second) {
           if (cfgDoMix) {
             if (t1.sign() > 0) {
               emh_pos->AddTrackToEventPool(key_df_collision, EMFwdTrack(ndf, t1.globalIndex(), collision.globalIndex(), t1.fwdtrackId(), t1.pt(), t1.eta(), t1.phi(), o2::constants::physics::MassMuon, t1.sign(), t1.fwdDcaX(), t1.fwdDcaY(), possibleIds1,
@@ -1105,8 +1103,7 @@ struct Dilepton {
             }
           }
         }
-        if (std::find(used_trackIds.begin(), used_trackIds.end(), pair_tmp_id2) == used_trackIds.end()) {
-          used_trackIds.emplace_back(pair_tmp_id2);
+        if (used_trackIds.insert(pair_tmp_id2).second) {
           if (cfgDoMix) {
             if (t2.sign() > 0) {
               emh_pos->AddTrackToEventPool(key_df_collision, EMFwdTrack(ndf, t2.globalIndex(), collision.globalIndex(), t2.fwdtrackId(), t2.pt(), t2.eta(), t2.phi(), o2::constants::physics::MassMuon, t2.sign(), t2.fwdDcaX(), t2.fwdDcaY(), possibleIds2,
@@ -1160,7 +1157,7 @@ struct Dilepton {
   TEMH* emh_neg = nullptr;
   std::map<std::pair<int, int>, uint64_t> map_mixed_eventId_to_globalBC;
 
-  std::vector<std::pair<int, int>> used_trackIds;
+  std::unordered_set<uint64_t> used_trackIds; // getPairKey(ndf, trackId) of the tracks stored for event mixing
   int ndf = 0;
 
   template <bool isTriggerAnalysis, typename TCollisions, typename TLeptons, typename TPresilce, typename TCut, typename TAllTracks>
@@ -1407,7 +1404,7 @@ struct Dilepton {
     return true;
   }
 
-  std::map<std::pair<int, int>, float> map_weight; // <posId, negId> -> float
+  std::unordered_map<uint64_t, float> map_weight; // getPairKey(posId, negId) -> float
   template <bool isTriggerAnalysis, typename TCollisions, typename TLeptons, typename TPresilce, typename TCut, typename TAllTracks>
   void fillPairWeightMap(TCollisions const& collisions, TLeptons const& posTracks, TLeptons const& negTracks, TPresilce const& perCollision, TCut const& cut, TAllTracks const& tracks)
   {
@@ -1478,6 +1475,13 @@ struct Dilepton {
       }
     } // end of collision loop
 
+    std::unordered_set<uint64_t> passed_pairKeys; // hashed passed_pairIds, for the look-up of the ambiguous pairs
+    passed_pairKeys.reserve(passed_pairIds.size());
+    map_weight.reserve(passed_pairIds.size());
+    for (const auto& pairId : passed_pairIds) {
+      passed_pairKeys.insert(getPairKey(std::get<0>(pairId), std::get<1>(pairId)));
+    }
+
     if constexpr (pairtype == o2::aod::pwgem::dilepton::utils::pairutil::DileptonPairType::kDielectron) {
       for (const auto& pairId : passed_pairIds) {
         auto t1 = tracks.rawIteratorAt(std::get<0>(pairId));
@@ -1487,12 +1491,12 @@ struct Dilepton {
         float n = 1.f; // include myself.
         for (const auto& ambId1 : t1.ambiguousElectronsIds()) {
           for (const auto& ambId2 : t2.ambiguousElectronsIds()) {
-            if (std::find(passed_pairIds.begin(), passed_pairIds.end(), std::make_pair(ambId1, ambId2)) != passed_pairIds.end()) {
+            if (passed_pairKeys.find(getPairKey(ambId1, ambId2)) != passed_pairKeys.end()) {
               n += 1.f;
             }
           }
         }
-        map_weight[pairId] = 1.f / n;
+        map_weight[getPairKey(std::get<0>(pairId), std::get<1>(pairId))] = 1.f / n;
       } // end of passed_pairIds loop
     } else if constexpr (pairtype == o2::aod::pwgem::dilepton::utils::pairutil::DileptonPairType::kDimuon) {
       for (const auto& pairId : passed_pairIds) {
@@ -1502,12 +1506,12 @@ struct Dilepton {
         float n = 1.f; // include myself.
         for (const auto& ambId1 : t1.ambiguousMuonsIds()) {
           for (const auto& ambId2 : t2.ambiguousMuonsIds()) {
-            if (std::find(passed_pairIds.begin(), passed_pairIds.end(), std::make_pair(ambId1, ambId2)) != passed_pairIds.end()) {
+            if (passed_pairKeys.find(getPairKey(ambId1, ambId2)) != passed_pairKeys.end()) {
               n += 1.f;
             }
           }
         }
-        map_weight[pairId] = 1.f / n;
+        map_weight[getPairKey(std::get<0>(pairId), std::get<1>(pairId))] = 1.f / n;
       } // end of passed_pairIds loop
     }
     passed_pairIds.clear();
@@ -1530,6 +1534,7 @@ struct Dilepton {
       runPairing<false>(collisions, positive_muons, negative_muons, o2::aod::emprimarymuon::emeventId, fDimuonCut, muons);
     }
     map_weight.clear();
+    used_trackIds.clear();
     ndf++;
   }
   PROCESS_SWITCH(Dilepton, processAnalysis, "run dilepton analysis", true);
@@ -1551,6 +1556,7 @@ struct Dilepton {
       runPairing<true>(collisions, positive_muons, negative_muons, o2::aod::emprimarymuon::emeventId, fDimuonCut, muons);
     }
     map_weight.clear();
+    used_trackIds.clear();
     ndf++;
   }
   PROCESS_SWITCH(Dilepton, processTriggerAnalysis, "run dilepton analysis on triggered data", false);
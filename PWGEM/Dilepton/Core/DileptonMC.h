@@ -49,6 +49,8 @@
 
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -888,7 +890,7 @@ struct DileptonMC {
 
     float weight = 1.f;
     if (cfgApplyWeightTTCA) {
-      weight = map_weight[std::make_pair(t1.globalIndex(), t2.globalIndex())];
+      weight = map_weight[getPairKey(t1.globalIndex(), t2.globalIndex())];
     }
     // LOGF(info, "t1.sign() = %d, t2.sign() = %d, map_weight[std::make_pair(%d, %d)] = %f", t1.sign(), t2.sign(), t1.globalIndex(), t2.globalIndex(), weight);
 
@@ -1869,7 +1871,7 @@ struct DileptonMC {
     return true;
   }
 
-  std::map<std::pair<int, int>, float> map_weight; // <posId, negId> -> float
+  std::unordered_map<uint64_t, float> map_weight; // getPairKey(posId, negId) -> float
   template <typename TCollisions, typename TTracks1, typename TTracks2, typename TPresilce, typename TCut, typename TAllTracks, typename TMCCollisions, typename TMCParticles>
   void fillPairWeightMap(TCollisions const& collisions, TTracks1 const& posTracks, TTracks2 const& negTracks, TPresilce const& perCollision, TCut const& cut, TAllTracks const& tracks, TMCCollisions const&, TMCParticles const& mcparticles)
   {
@@ -1947,6 +1949,13 @@ struct DileptonMC {
       }
     } // end of collision loop
 
+    std::unordered_set<uint64_t> passed_pairKeys; // hashed passed_pairIds, for the look-up of the ambiguous pairs
+    passed_pairKeys.reserve(passed_pairIds.size());
+    map_weight.reserve(passed_pairIds.size());
+    for (const auto& pairId : passed_pairIds) {
+      passed_pairKeys.insert(getPairKey(std::get<0>(pairId), std::get<1>(pairId)));
+    }
+
     if constexpr (pairtype == o2::aod::pwgem::dilepton::utils::pairutil::DileptonPairType::kDielectron) {
       for (const auto& pairId : passed_pairIds) {
         auto t1 = tracks.rawIteratorAt(std::get<0>(pairId));
@@ -1956,12 +1965,12 @@ struct DileptonMC {
         float n = 1.f; // include myself.
         for (const auto& ambId1 : t1.ambiguousElectronsIds()) {
           for (const auto& ambId2 : t2.ambiguousElectronsIds()) {
-            if (std::find(passed_pairIds.begin(), passed_pairIds.end(), std::make_pair(ambId1, ambId2)) != passed_pairIds.end()) {
+            if (passed_pairKeys.find(getPairKey(ambId1, ambId2)) != passed_pairKeys.end()) {
               n += 1.f;
             }
           }
         }
-        map_weight[pairId] = 1.f / n;
+        map_weight[getPairKey(std::get<0>(pairId), std::get<1>(pairId))] = 1.f / n;
       } // end of passed_pairIds loop
     } else if constexpr (pairtype == o2::aod::pwgem::dilepton::utils::pairutil::DileptonPairType::kDimuon) {
       for (const auto& pairId : passed_pairIds) {
@@ -1971,12 +1980,12 @@ struct DileptonMC {
         float n = 1.f; // include myself.
         for (const auto& ambId1 : t1.ambiguousMuonsIds()) {
           for (const auto& ambId2 : t2.ambiguousMuonsIds()) {
-            if (std::find(passed_pairIds.begin(), passed_pairIds.end(), std::make_pair(ambId1, ambId2)) != passed_pairIds.end()) {
+            if (passed_pairKeys.find(getPairKey(ambId1, ambId2)) != passed_pairKeys.end()) {
               n += 1.f;
             }
           }
         }
-        map_weight[pairId] = 1.f / n;
+        map_weight[getPairKey(std::get<0>(pairId), std::get<1>(pairId))] = 1.f / n;
       } // end of passed_pairIds loop
     }
     passed_pairIds.clear();
@@ -2078,7 +2087,7 @@ struct DileptonMC {
         ROOT::Math::PtEtaPhiMVector v12mc = v1mc + v2mc;
         float weight = 1.f;
         if (cfgApplyWeightTTCA) {
-          weight = map_weight[std::make_pair(pos.globalIndex(), neg.globalIndex())];
+          weight = map_weight[getPairKey(pos.globalIndex(), neg.globalIndex())];
         }
 
         if (mother_id > -1) {
@@ -2216,7 +2225,7 @@ struct DileptonMC {
         ROOT::Math::PtEtaPhiMVector v12mc = v1mc + v2mc;
         float weight = 1.f;
         if (cfgApplyWeightTTCA) {
-          weight = map_weight[std::make_pair(pos1.globalIndex(), pos2.globalIndex())];
+          weight = map_weight[getPairKey(pos1.globalIndex(), pos2.globalIndex())];
         }
 
         if (hfee_type > -1) {
@@ -2290,7 +2299,7 @@ struct DileptonMC {
         ROOT::Math::PtEtaPhiMVector v12mc = v1mc + v2mc;
         float weight = 1.f;
         if (cfgApplyWeightTTCA) {
-          weight = map_weight[std::make_pair(neg1.globalIndex(), neg2.globalIndex())];
+          weight = map_weight[getPairKey(neg1.globalIndex(), neg2.globalIndex())];
         }
 
         if (hfee_type > -1) {
@@ -16,6 +16,7 @@
 #define PWGEM_DILEPTON_UTILS_PAIRUTILITIES_H_
 
 #include <array>
+#include <cstdint>
 #include <vector>
 #include "Math/SMatrix.h"
 #include "Math/Vector3D.h"
@@ -347,6 +348,12 @@ inline float pairDCASignQuadSum(const float dca1, const float dca2, const float
   return charge1 * charge2 * TMath::Sign(1., dca1) * TMath::Sign(1., dca2) * std::sqrt((dca1 * dca1 + dca2 * dca2) / 2.);
 }
 
+//_______________________________________________________________________
+// key of an ordered pair of indices (e.g. global indices of 2 tracks, or <df id, track id>) for hashed containers
+inline uint64_t getPairKey(const int id1, const int id2)
+{
+  return (static_cast<uint64_t>(static_cast<uint32_t>(id1)) << 32) | static_cast<uint32_t>(id2);
+}
 //_______________________________________________________________________
 } // namespace o2::aod::pwgem::dilepton::utils::pairutil
 #endif // PWGEM_DILEPTON_UTILS_PAIRUTILITIES_H_
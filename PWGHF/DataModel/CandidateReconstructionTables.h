@@ -420,6 +420,48 @@ DECLARE_SOA_TABLE(HfPvRefitDstar, "AOD", "HFPVREFITDSTAR", //!
                   hf_pv_refit::PvRefitSigmaZ2,
                   o2::soa::Marker<2>);
 
+namespace hf_skim_vtx
+{
+DECLARE_SOA_COLUMN(FitterConfig, fitterConfig, uint32_t);  //! Fingerprint of the DCAFitterN settings used in the skimming
+DECLARE_SOA_COLUMN(XSv, xSv, float);                       //! Secondary vertex x (cm)
+DECLARE_SOA_COLUMN(YSv, ySv, float);                       //! Secondary vertex y (cm)
+DECLARE_SOA_COLUMN(ZSv, zSv, float);                       //! Secondary vertex z (cm)
+DECLARE_SOA_COLUMN(CovSv, covSv, float[6]);                //! Secondary vertex covariance matrix (XX, XY, YY, XZ, YZ, ZZ)
+DECLARE_SOA_COLUMN(Chi2Pca, chi2Pca, float);               //! Sum of (non-weighted) distances of the secondary vertex to its prongs
+DECLARE_SOA_COLUMN(Prong0ParPca, prong0ParPca, float[7]);  //! First prong at the PCA (x, alpha, y, z, snp, tgl, q/pT)
+DECLARE_SOA_COLUMN(Prong0CovPca, prong0CovPca, float[15]); //! First prong covariance matrix at the PCA
+DECLARE_SOA_COLUMN(Prong1ParPca, prong1ParPca, float[7]);  //! Second prong at the PCA (x, alpha, y, z, snp, tgl, q/pT)
+DECLARE_SOA_COLUMN(Prong1CovPca, prong1CovPca, float[15]); //! Second prong covariance matrix at the PCA
+DECLARE_SOA_COLUMN(Prong2ParPca, prong2ParPca, float[7]);  //! Third prong at the PCA (x, alpha, y, z, snp, tgl, q/pT)
+DECLARE_SOA_COLUMN(Prong2CovPca, prong2CovPca, float[15]); //! Third prong covariance matrix at the PCA
+} // namespace hf_skim_vtx
+
+DECLARE_SOA_TABLE(HfSkimVtx2Prong, "AOD", "HFSKIMVTX2P", //! Secondary-vertex fit of the skimmed HF 2-prongs, joinable with Hf2Prongs
+                  hf_skim_vtx::FitterConfig,
+                  hf_skim_vtx::XSv,
+                  hf_skim_vtx::YSv,
+                  hf_skim_vtx::ZSv,
+                  hf_skim_vtx::CovSv,
+                  hf_skim_vtx::Chi2Pca,
+                  hf_skim_vtx::Prong0ParPca,
+                  hf_skim_vtx::Prong0CovPca,
+                  hf_skim_vtx::Prong1ParPca,
+                  hf_skim_vtx::Prong1CovPca);
+
+DECLARE_SOA_TABLE(HfSkimVtx3Prong, "AOD", "HFSKIMVTX3P", //! Secondary-vertex fit of the skimmed HF 3-prongs, joinable with Hf3Prongs
+                  hf_skim_vtx::FitterConfig,
+                  hf_skim_vtx::XSv,
+                  hf_skim_vtx::YSv,
+                  hf_skim_vtx::ZSv,
+                  hf_skim_vtx::CovSv,
+                  hf_skim_vtx::Chi2Pca,
+                  hf_skim_vtx::Prong0ParPca,
+                  hf_skim_vtx::Prong0CovPca,
+                  hf_skim_vtx::Prong1ParPca,
+                  hf_skim_vtx::Prong1CovPca,
+                  hf_skim_vtx::Prong2ParPca,
+                  hf_skim_vtx::Prong2CovPca);
+
 // general decay properties
 namespace hf_cand
 {
@@ -32,6 +32,7 @@
 #include "PWGHF/Utils/utilsTrkCandHf.h"
 #include "PWGLF/DataModel/mcCentrality.h"
 
+#include "Common/Core/ProcessProfiler.h"
 #include "Common/Core/trackUtilities.h"
 #include "Tools/KFparticle/KFUtilities.h"
 
@@ -93,10 +94,19 @@ struct HfCandidateCreator2Prong {
   Configurable<std::string> ccdbPathGrp{"ccdbPathGrp", "GLO/GRP/GRP", "Path of the grp file (Run 2)"};
   Configurable<std::string> ccdbPathGrpMag{"ccdbPathGrpMag", "GLO/Config/GRPMagField", "CCDB path of the GRPMagField object (Run 3)"};
 
-  HfEventSelection hfEvSel;        // event selection and monitoring
-  o2::vertexing::DCAFitterN<2> df; // 2-prong vertex fitter
+  o2::common::core::ProcessProfilerConfigurables processProfilerConfig;
+
+  HfEventSelection hfEvSel;                          // event selection and monitoring
+  o2::vertexing::DCAFitterN<2> df;                   // 2-prong vertex fitter
+  uint32_t fitterConfigHash{0};                      // fingerprint of the fitter settings, compared with the one of the skim vertices
+  o2::common::core::ProcessProfiler processProfiler; // timing and allocation monitoring of the candidate creation
   Service<o2::ccdb::BasicCCDBManager> ccdb;
 
+  enum ProfiledSection : int {
+    DcaFitter = 0,
+    KfParticle
+  };
+
   using TracksWCovExtraPidPiKa = soa::Join<aod::TracksWCovExtra, aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa>;
 
   int runNumber{0};
@@ -110,11 +120,12 @@ struct HfCandidateCreator2Prong {
   std::shared_ptr<TH1> hCandidates;
   HistogramRegistry registry{"registry"};
 
-  void init(InitContext const&)
+  void init(InitContext& initContext)
   {
-    std::array<bool, 6> doprocessDF{doprocessPvRefitWithDCAFitterN, doprocessNoPvRefitWithDCAFitterN,
+    std::array<bool, 8> doprocessDF{doprocessPvRefitWithDCAFitterN, doprocessNoPvRefitWithDCAFitterN,
                                     doprocessPvRefitWithDCAFitterNCentFT0C, doprocessNoPvRefitWithDCAFitterNCentFT0C,
-                                    doprocessPvRefitWithDCAFitterNCentFT0M, doprocessNoPvRefitWithDCAFitterNCentFT0M};
+                                    doprocessPvRefitWithDCAFitterNCentFT0M, doprocessNoPvRefitWithDCAFitterNCentFT0M,
+                                    doprocessPvRefitWithSkimVertex, doprocessNoPvRefitWithSkimVertex};
     std::array<bool, 6> doprocessKF{doprocessPvRefitWithKFParticle, doprocessNoPvRefitWithKFParticle,
                                     doprocessPvRefitWithKFParticleCentFT0C, doprocessNoPvRefitWithKFParticleCentFT0C,
                                     doprocessPvRefitWithKFParticleCentFT0M, doprocessNoPvRefitWithKFParticleCentFT0M};
@@ -128,7 +139,7 @@ struct HfCandidateCreator2Prong {
       LOGP(fatal, "At most one process function for collision monitoring can be enabled at a time.");
     }
     if (nProcessesCollisions == 1) {
-      if ((doprocessPvRefitWithDCAFitterN || doprocessNoPvRefitWithDCAFitterN || doprocessPvRefitWithKFParticle || doprocessNoPvRefitWithKFParticle) && !doprocessCollisions) {
+      if ((doprocessPvRefitWithDCAFitterN || doprocessNoPvRefitWithDCAFitterN || doprocessPvRefitWithSkimVertex || doprocessNoPvRefitWithSkimVertex || doprocessPvRefitWithKFParticle || doprocessNoPvRefitWithKFParticle) && !doprocessCollisions) {
         LOGP(fatal, "Process function for collision monitoring not correctly enabled. Did you enable \"processCollisions\"?");
       }
       if ((doprocessPvRefitWithDCAFitterNCentFT0C || doprocessNoPvRefitWithDCAFitterNCentFT0C || doprocessPvRefitWithKFParticleCentFT0C || doprocessNoPvRefitWithKFParticleCentFT0C) && !doprocessCollisionsCentFT0C) {
@@ -171,6 +182,7 @@ struct HfCandidateCreator2Prong {
       df.setMinRelChi2Change(minRelChi2Change);
       df.setUseAbsDCA(useAbsDCA);
       df.setWeightedFinalPCA(useWeightedFinalPCA);
+      fitterConfigHash = getDcaFitterConfigHash(propagateToPCA, useAbsDCA, useWeightedFinalPCA, maxR, maxDZIni, minParamChange, minRelChi2Change);
     }
     if (std::accumulate(doprocessKF.begin(), doprocessKF.end(), 0) == 1) {
       registry.fill(HIST("hVertexerType"), aod::hf_cand::VertexerType::KfParticle);
@@ -183,14 +195,17 @@ struct HfCandidateCreator2Prong {
 
     /// candidate monitoring
     setLabelHistoCands(hCandidates);
+
+    processProfiler.init(processProfilerConfig, registry, {"DCAFitterN", "KFParticle"}, initContext);
   }
 
-  template <bool doPvRefit, o2::hf_centrality::CentralityEstimator centEstimator, typename Coll, typename CandType, typename TTracks>
+  template <bool doPvRefit, o2::hf_centrality::CentralityEstimator centEstimator, bool useSkimVertex = false, typename Coll, typename CandType, typename TTracks>
   void runCreator2ProngWithDCAFitterN(Coll const&,
                                       CandType const& rowsTrackIndexProng2,
                                       TTracks const&,
                                       aod::BCsWithTimestamps const& /*bcWithTimeStamps*/)
   {
+    auto profile = processProfiler.measure(ProfiledSection::DcaFitter, rowsTrackIndexProng2.size());
     // loop over pairs of track indices
     for (const auto& rowTrackIndexProng2 : rowsTrackIndexProng2) {
 
@@ -222,28 +237,50 @@ struct HfCandidateCreator2Prong {
       }
       df.setBz(bz);
 
-      // reconstruct the 2-prong secondary vertex
+      // reconstruct the 2-prong secondary vertex,
+      // or take it from the skimming if it was fitted there with the same fitter settings
       hCandidates->Fill(SVFitting::BeforeFit);
-      try {
-        if (df.process(trackParVarPos1, trackParVarNeg1) == 0) {
+      std::array<float, 3> secondaryVertex{};
+      std::array<float, 6> covMatrixPCA{};
+      float chi2PCA{0.f};
+      o2::track::TrackParCov trackParVar0;
+      o2::track::TrackParCov trackParVar1;
+      bool isSkimVertexReused{false};
+      if constexpr (useSkimVertex) {
+        if (rowTrackIndexProng2.fitterConfig() == fitterConfigHash) {
+          secondaryVertex = {rowTrackIndexProng2.xSv(), rowTrackIndexProng2.ySv(), rowTrackIndexProng2.zSv()};
+          for (std::size_t iCov = 0; iCov < covMatrixPCA.size(); iCov++) {
+            covMatrixPCA[iCov] = rowTrackIndexProng2.covSv()[iCov];
+          }
+          chi2PCA = rowTrackIndexProng2.chi2Pca();
+          trackParVar0 = getTrackParCovFromArrays(rowTrackIndexProng2.prong0ParPca(), rowTrackIndexProng2.prong0CovPca());
+          trackParVar1 = getTrackParCovFromArrays(rowTrackIndexProng2.prong1ParPca(), rowTrackIndexProng2.prong1CovPca());
+          isSkimVertexReused = true;
+        }
+      }
+      if (!isSkimVertexReused) {
+        try {
+          if (df.process(trackParVarPos1, trackParVarNeg1) == 0) {
+            continue;
+          }
+        } catch (const std::runtime_error& error) {
+          LOG(info) << "Run time error found: " << error.what() << ". DCAFitterN cannot work, skipping the candidate.";
+          hCandidates->Fill(SVFitting::Fail);
           continue;
         }
-      } catch (const std::runtime_error& error) {
-        LOG(info) << "Run time error found: " << error.what() << ". DCAFitterN cannot work, skipping the candidate.";
-        hCandidates->Fill(SVFitting::Fail);
-        continue;
+        const auto& secondaryVertexFit = df.getPCACandidate();
+        secondaryVertex = {static_cast<float>(secondaryVertexFit[0]), static_cast<float>(secondaryVertexFit[1]), static_cast<float>(secondaryVertexFit[2])};
+        chi2PCA = df.getChi2AtPCACandidate();
+        covMatrixPCA = df.calcPCACovMatrixFlat();
+        trackParVar0 = df.getTrack(0);
+        trackParVar1 = df.getTrack(1);
       }
       hCandidates->Fill(SVFitting::FitOk);
 
-      const auto& secondaryVertex = df.getPCACandidate();
-      auto chi2PCA = df.getChi2AtPCACandidate();
-      auto covMatrixPCA = df.calcPCACovMatrixFlat();
       registry.fill(HIST("hCovSVXX"), covMatrixPCA[0]); // FIXME: Calculation of errorDecayLength(XY) gives wrong values without this line.
       registry.fill(HIST("hCovSVYY"), covMatrixPCA[2]);
       registry.fill(HIST("hCovSVXZ"), covMatrixPCA[3]);
       registry.fill(HIST("hCovSVZZ"), covMatrixPCA[5]);
-      auto trackParVar0 = df.getTrack(0);
-      auto trackParVar1 = df.getTrack(1);
 
       // get track momenta
       std::array<float, 3> pvec0;
@@ -314,6 +351,7 @@ struct HfCandidateCreator2Prong {
                        std::sqrt(impactParameter0.getSigmaZ2()), std::sqrt(impactParameter1.getSigmaZ2()),
                        rowTrackIndexProng2.prong0Id(), rowTrackIndexProng2.prong1Id(), nProngsContributorsPV, bitmapProngsContributorsPV,
                        rowTrackIndexProng2.hfflag());
+      profile.addRowsOut(1);
 
       // fill candidate prong PID rows
       fillProngPid<HfProngSpecies::Pion>(track0, rowProng0PidPi);
@@ -339,6 +377,7 @@ struct HfCandidateCreator2Prong {
                                       TTracks const&,
                                       aod::BCsWithTimestamps const& /*bcWithTimeStamps*/)
   {
+    auto profile = processProfiler.measure(ProfiledSection::KfParticle, rowsTrackIndexProng2.size());
 
     for (const auto& rowTrackIndexProng2 : rowsTrackIndexProng2) {
 
@@ -466,6 +505,7 @@ struct HfCandidateCreator2Prong {
                        0.f, 0.f,
                        rowTrackIndexProng2.prong0Id(), rowTrackIndexProng2.prong1Id(), nProngsContributorsPV, bitmapProngsContributorsPV,
                        rowTrackIndexProng2.hfflag());
+      profile.addRowsOut(1);
 
       // fill candidate prong PID rows
       fillProngPid<HfProngSpecies::Pion>(track0, rowProng0PidPi);
@@ -511,6 +551,26 @@ struct HfCandidateCreator2Prong {
   }
   PROCESS_SWITCH(HfCandidateCreator2Prong, processNoPvRefitWithDCAFitterN, "Run candidate creator using DCA fitter w/o PV refit and w/o centrality selections", true);
 
+  /// @brief process function reusing the DCA fitter vertices of the skimming w/ PV refit and w/o centrality selections
+  void processPvRefitWithSkimVertex(soa::Join<aod::Collisions, aod::EvSels> const& collisions,
+                                    soa::Join<aod::Hf2Prongs, aod::HfPvRefit2Prong, aod::HfSkimVtx2Prong> const& rowsTrackIndexProng2,
+                                    TracksWCovExtraPidPiKa const& tracks,
+                                    aod::BCsWithTimestamps const& bcWithTimeStamps)
+  {
+    runCreator2ProngWithDCAFitterN</*doPvRefit*/ true, CentralityEstimator::None, /*useSkimVertex*/ true>(collisions, rowsTrackIndexProng2, tracks, bcWithTimeStamps);
+  }
+  PROCESS_SWITCH(HfCandidateCreator2Prong, processPvRefitWithSkimVertex, "Run candidate creator reusing skim DCA fitter vertices (refit if settings differ) w/ PV refit and w/o centrality selections", false);
+
+  /// @brief process function reusing the DCA fitter vertices of the skimming w/o PV refit and w/o centrality selections
+  void processNoPvRefitWithSkimVertex(soa::Join<aod::Collisions, aod::EvSels> const& collisions,
+                                      soa::Join<aod::Hf2Prongs, aod::HfSkimVtx2Prong> const& rowsTrackIndexProng2,
+                                      TracksWCovExtraPidPiKa const& tracks,
+                                      aod::BCsWithTimestamps const& bcWithTimeStamps)
+  {
+    runCreator2ProngWithDCAFitterN</*doPvRefit*/ false, CentralityEstimator::None, /*useSkimVertex*/ true>(collisions, rowsTrackIndexProng2, tracks, bcWithTimeStamps);
+  }
+  PROCESS_SWITCH(HfCandidateCreator2Prong, processNoPvRefitWithSkimVertex, "Run candidate creator reusing skim DCA fitter vertices (refit if settings differ) w/o PV refit and w/o centrality selections", false);
+
   /// @brief process function using KFParticle package w/ PV refit and w/o centrality selections
   void processPvRefitWithKFParticle(soa::Join<aod::Collisions, aod::EvSels> const& collisions,
                                     soa::Join<aod::Hf2Prongs, aod::HfPvRefit2Prong> const& rowsTrackIndexProng2,
@@ -695,8 +755,10 @@ struct HfCandidateCreator2ProngExpressions {
   Configurable<bool> matchKinkedDecayTopology{"matchKinkedDecayTopology", false, "Match also candidates with tracks that decay with kinked topology"};
   Configurable<bool> matchInteractionsWithMaterial{"matchInteractionsWithMaterial", false, "Match also candidates with tracks that interact with material"};
   Configurable<bool> matchCorrelatedBackgrounds{"matchCorrelatedBackgrounds", false, "Match correlated background candidates"};
+  Configurable<bool> useMcAncestryIndex{"useMcAncestryIndex", true, "Run mother/daughter searches of the MC matching on a per-DataFrame ancestry index"};
 
-  HfEventSelectionMc hfEvSelMc; // mc event selection and monitoring
+  HfEventSelectionMc hfEvSelMc;    // mc event selection and monitoring
+  McAncestryIndex mcAncestryIndex; // flattened MC decay tree of the current DataFrame
 
   using McCollisionsNoCents = soa::Join<aod::Collisions, aod::EvSels, aod::McCollisionLabels>;
   using McCollisionsFT0Cs = soa::Join<aod::Collisions, aod::EvSels, aod::McCollisionLabels, aod::CentFT0Cs>;
@@ -739,6 +801,12 @@ struct HfCandidateCreator2ProngExpressions {
   {
     rowCandidateProng2->bindExternalIndices(&tracks);
 
+    const McAncestryIndex* mcIndex = nullptr;
+    if (useMcAncestryIndex) {
+      mcAncestryIndex.build(mcParticles);
+      mcIndex = &mcAncestryIndex;
+    }
+
     int indexRec = -1;
     int8_t sign = 0;
     int8_t flag = 0;
@@ -785,13 +853,13 @@ struct HfCandidateCreator2ProngExpressions {
           std::array<int, 2> finalStateParts2Prong = std::array{finalState[0], finalState[1]};
           if (finalState.size() == 3) { // o2-linter: disable=magic-number (Partly Reco 3-prong decays)
             if (matchKinkedDecayTopology && matchInteractionsWithMaterial) {
-              indexRec = RecoDecay::getMatchedMCRec<false, false, true, true, true>(mcParticles, arrayDaughters, Pdg::kD0, finalStateParts2Prong, true, &sign, FinalStateDepth, &nKinkedTracks, &nInteractionsWithMaterial);
+              indexRec = RecoDecay::getMatchedMCRec<false, false, true, true, true>(mcParticles, arrayDaughters, Pdg::kD0, finalStateParts2Prong, true, &sign, FinalStateDepth, &nKinkedTracks, &nInteractionsWithMaterial, nullptr, mcIndex);
             } else if (matchKinkedDecayTopology && !matchInteractionsWithMaterial) {
-              indexRec = RecoDecay::getMatchedMCRec<false, false, true, true, false>(mcParticles, arrayDaughters, Pdg::kD0, finalStateParts2Prong, true, &sign, FinalStateDepth, &nKinkedTracks);
+              indexRec = RecoDecay::getMatchedMCRec<false, false, true, true, false>(mcParticles, arrayDaughters, Pdg::kD0, finalStateParts2Prong, true, &sign, FinalStateDepth, &nKinkedTracks, nullptr, nullptr, mcIndex);
             } else if (!matchKinkedDecayTopology && matchInteractionsWithMaterial) {
-              indexRec = RecoDecay::getMatchedMCRec<false, false, true, false, true>(mcParticles, arrayDaughters, Pdg::kD0, finalStateParts2Prong, true, &sign, FinalStateDepth, nullptr, &nInteractionsWithMaterial);
+              indexRec = RecoDecay::getMatchedMCRec<false, false, true, false, true>(mcParticles, arrayDaughters, Pdg::kD0, finalStateParts2Prong, true, &sign, FinalStateDepth, nullptr, &nInteractionsWithMaterial, nullptr, mcIndex);
             } else {
-              indexRec = RecoDecay::getMatchedMCRec<false, false, true, false, false>(mcParticles, arrayDaughters, Pdg::kD0, finalStateParts2Prong, true, &sign, FinalStateDepth);
+              indexRec = RecoDecay::getMatchedMCRec<false, false, true, false, false>(mcParticles, arrayDaughters, Pdg::kD0, finalStateParts2Prong, true, &sign, FinalStateDepth, nullptr, nullptr, nullptr, mcIndex);
             }
 
             if (indexRec > -1) {
@@ -804,13 +872,13 @@ struct HfCandidateCreator2ProngExpressions {
             }
           } else if (finalState.size() == 2) { // o2-linter: disable=magic-number (Fully Reco 2-prong decays)
             if (matchKinkedDecayTopology && matchInteractionsWithMaterial) {
-              indexRec = RecoDecay::getMatchedMCRec<false, false, false, true, true>(mcParticles, arrayDaughters, Pdg::kD0, finalStateParts2Prong, true, &sign, FinalStateDepth, &nKinkedTracks, &nInteractionsWithMaterial);
+              indexRec = RecoDecay::getMatchedMCRec<false, false, false, true, true>(mcParticles, arrayDaughters, Pdg::kD0, finalStateParts2Prong, true, &sign, FinalStateDepth, &nKinkedTracks, &nInteractionsWithMaterial, nullptr, mcIndex);
             } else if (matchKinkedDecayTopology && !matchInteractionsWithMaterial) {
-              indexRec = RecoDecay::getMatchedMCRec<false, false, false, true, false>(mcParticles, arrayDaughters, Pdg::kD0, finalStateParts2Prong, true, &sign, FinalStateDepth, &nKinkedTracks);
+              indexRec = RecoDecay::getMatchedMCRec<false, false, false, true, false>(mcParticles, arrayDaughters, Pdg::kD0, finalStateParts2Prong, true, &sign, FinalStateDepth, &nKinkedTracks, nullptr, nullptr, mcIndex);
             } else if (!matchKinkedDecayTopology && matchInteractionsWithMaterial) {
-              indexRec = RecoDecay::getMatchedMCRec<false, false, false, false, true>(mcParticles, arrayDaughters, Pdg::kD0, finalStateParts2Prong, true, &sign, FinalStateDepth, nullptr, &nInteractionsWithMaterial);
+              indexRec = RecoDecay::getMatchedMCRec<false, false, false, false, true>(mcParticles, arrayDaughters, Pdg::kD0, finalStateParts2Prong, true, &sign, FinalStateDepth, nullptr, &nInteractionsWithMaterial, nullptr, mcIndex);
             } else {
-              indexRec = RecoDecay::getMatchedMCRec<false, false, false, false, false>(mcParticles, arrayDaughters, Pdg::kD0, finalStateParts2Prong, true, &sign, FinalStateDepth);
+              indexRec = RecoDecay::getMatchedMCRec<false, false, false, false, false>(mcParticles, arrayDaughters, Pdg::kD0, finalStateParts2Prong, true, &sign, FinalStateDepth, nullptr, nullptr, nullptr, mcIndex);
             }
           } else {
             LOG(fatal) << "Final state size not supported: " << finalState.size();
@@ -836,13 +904,13 @@ struct HfCandidateCreator2ProngExpressions {
       } else {
         // D0(bar) → π± K∓
         if (matchKinkedDecayTopology && matchInteractionsWithMaterial) {
-          indexRec = RecoDecay::getMatchedMCRec<false, false, false, true, true>(mcParticles, arrayDaughters, Pdg::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign, 1, &nKinkedTracks, &nInteractionsWithMaterial);
+          indexRec = RecoDecay::getMatchedMCRec<false, false, false, true, true>(mcParticles, arrayDaughters, Pdg::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign, 1, &nKinkedTracks, &nInteractionsWithMaterial, nullptr, mcIndex);
         } else if (matchKinkedDecayTopology && !matchInteractionsWithMaterial) {
-          indexRec = RecoDecay::getMatchedMCRec<false, false, false, true, false>(mcParticles, arrayDaughters, Pdg::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign, 1, &nKinkedTracks);
+          indexRec = RecoDecay::getMatchedMCRec<false, false, false, true, false>(mcParticles, arrayDaughters, Pdg::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign, 1, &nKinkedTracks, nullptr, nullptr, mcIndex);
         } else if (!matchKinkedDecayTopology && matchInteractionsWithMaterial) {
-          indexRec = RecoDecay::getMatchedMCRec<false, false, false, false, true>(mcParticles, arrayDaughters, Pdg::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign, 1, nullptr, &nInteractionsWithMaterial);
+          indexRec = RecoDecay::getMatchedMCRec<false, false, false, false, true>(mcParticles, arrayDaughters, Pdg::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign, 1, nullptr, &nInteractionsWithMaterial, nullptr, mcIndex);
         } else {
-          indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign);
+          indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign, 1, nullptr, nullptr, nullptr, mcIndex);
         }
         if (indexRec > -1) {
           flag = sign * (1 << DecayType::D0ToPiK);
@@ -851,9 +919,9 @@ struct HfCandidateCreator2ProngExpressions {
         // J/ψ → e+ e−
         if (flag == 0) {
           if (matchInteractionsWithMaterial) {
-            indexRec = RecoDecay::getMatchedMCRec<false, false, false, false, true>(mcParticles, arrayDaughters, Pdg::kJPsi, std::array{+kElectron, -kElectron}, true, &sign, 1, nullptr, &nInteractionsWithMaterial);
+            indexRec = RecoDecay::getMatchedMCRec<false, false, false, false, true>(mcParticles, arrayDaughters, Pdg::kJPsi, std::array{+kElectron, -kElectron}, true, &sign, 1, nullptr, &nInteractionsWithMaterial, nullptr, mcIndex);
           } else {
-            indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kJPsi, std::array{+kElectron, -kElectron}, true);
+            indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kJPsi, std::array{+kElectron, -kElectron}, true, nullptr, 1, nullptr, nullptr, nullptr, mcIndex);
           }
           if (indexRec > -1) {
             flag = 1 << DecayType::JpsiToEE;
@@ -863,9 +931,9 @@ struct HfCandidateCreator2ProngExpressions {
         // J/ψ → μ+ μ−
         if (flag == 0) {
           if (matchInteractionsWithMaterial) {
-            indexRec = RecoDecay::getMatchedMCRec<false, false, false, false, true>(mcParticles, arrayDaughters, Pdg::kJPsi, std::array{+kMuonPlus, -kMuonPlus}, true, &sign, 1, nullptr, &nInteractionsWithMaterial);
+            indexRec = RecoDecay::getMatchedMCRec<false, false, false, false, true>(mcParticles, arrayDaughters, Pdg::kJPsi, std::array{+kMuonPlus, -kMuonPlus}, true, &sign, 1, nullptr, &nInteractionsWithMaterial, nullptr, mcIndex);
           } else {
-            indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kJPsi, std::array{+kMuonPlus, -kMuonPlus}, true);
+            indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kJPsi, std::array{+kMuonPlus, -kMuonPlus}, true, nullptr, 1, nullptr, nullptr, nullptr, mcIndex);
           }
           if (indexRec > -1) {
             flag = 1 << DecayType::JpsiToMuMu;
@@ -876,7 +944,7 @@ struct HfCandidateCreator2ProngExpressions {
       // Check whether the particle is non-prompt (from a b quark).
       if (flag != 0) {
         auto particle = mcParticles.rawIteratorAt(indexRec);
-        origin = RecoDecay::getCharmHadronOrigin(mcParticles, particle, false, &idxBhadMothers);
+        origin = RecoDecay::getCharmHadronOrigin(mcParticles, particle, false, &idxBhadMothers, mcIndex);
       }
       if (origin == RecoDecay::OriginType::NonPrompt) {
         auto bHadMother = mcParticles.rawIteratorAt(idxBhadMothers[0]);
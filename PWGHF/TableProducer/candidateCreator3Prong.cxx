@@ -106,6 +106,7 @@ struct HfCandidateCreator3Prong {
 
   HfEventSelection hfEvSel;        // event selection and monitoring
   o2::vertexing::DCAFitterN<3> df; // 3-prong vertex fitter
+  uint32_t fitterConfigHash{0};    // fingerprint of the fitter settings, compared with the one of the skim vertices
   Service<o2::ccdb::BasicCCDBManager> ccdb;
 
   int runNumber{0};
@@ -126,6 +127,8 @@ struct HfCandidateCreator3Prong {
 
   using FilteredHf3Prongs = soa::Filtered<aod::Hf3Prongs>;
   using FilteredPvRefitHf3Prongs = soa::Filtered<soa::Join<aod::Hf3Prongs, aod::HfPvRefit3Prong>>;
+  using FilteredSkimVtxHf3Prongs = soa::Filtered<soa::Join<aod::Hf3Prongs, aod::HfSkimVtx3Prong>>;
+  using FilteredPvRefitSkimVtxHf3Prongs = soa::Filtered<soa::Join<aod::Hf3Prongs, aod::HfPvRefit3Prong, aod::HfSkimVtx3Prong>>;
   using TracksWCovExtraPidPiKaPr = soa::Join<aod::TracksWCovExtra, aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa, aod::TracksPidPr, aod::PidTpcTofFullPr>;
 
   // filter candidates
@@ -136,9 +139,10 @@ struct HfCandidateCreator3Prong {
 
   void init(InitContext const&)
   {
-    std::array<bool, 6> doprocessDF{doprocessPvRefitWithDCAFitterN, doprocessNoPvRefitWithDCAFitterN,
+    std::array<bool, 8> doprocessDF{doprocessPvRefitWithDCAFitterN, doprocessNoPvRefitWithDCAFitterN,
                                     doprocessPvRefitWithDCAFitterNCentFT0C, doprocessNoPvRefitWithDCAFitterNCentFT0C,
-                                    doprocessPvRefitWithDCAFitterNCentFT0M, doprocessNoPvRefitWithDCAFitterNCentFT0M};
+                                    doprocessPvRefitWithDCAFitterNCentFT0M, doprocessNoPvRefitWithDCAFitterNCentFT0M,
+                                    doprocessPvRefitWithSkimVertex, doprocessNoPvRefitWithSkimVertex};
     std::array<bool, 6> doprocessKF{doprocessPvRefitWithKFParticle, doprocessNoPvRefitWithKFParticle,
                                     doprocessPvRefitWithKFParticleCentFT0C, doprocessNoPvRefitWithKFParticleCentFT0C,
                                     doprocessPvRefitWithKFParticleCentFT0M, doprocessNoPvRefitWithKFParticleCentFT0M};
@@ -152,7 +156,7 @@ struct HfCandidateCreator3Prong {
       LOGP(fatal, "At most one process function for collision monitoring can be enabled at a time.");
     }
     if (nProcessesCollisions == 1) {
-      if ((doprocessPvRefitWithDCAFitterN || doprocessNoPvRefitWithDCAFitterN || doprocessPvRefitWithKFParticle || doprocessNoPvRefitWithKFParticle) && !doprocessCollisions) {
+      if ((doprocessPvRefitWithDCAFitterN || doprocessNoPvRefitWithDCAFitterN || doprocessPvRefitWithSkimVertex || doprocessNoPvRefitWithSkimVertex || doprocessPvRefitWithKFParticle || doprocessNoPvRefitWithKFParticle) && !doprocessCollisions) {
         LOGP(fatal, "Process function for collision monitoring not correctly enabled. Did you enable \"processCollisions\"?");
       }
       if ((doprocessPvRefitWithDCAFitterNCentFT0C || doprocessNoPvRefitWithDCAFitterNCentFT0C || doprocessPvRefitWithKFParticleCentFT0C || doprocessNoPvRefitWithKFParticleCentFT0C) && !doprocessCollisionsCentFT0C) {
@@ -208,6 +212,7 @@ struct HfCandidateCreator3Prong {
     df.setMinRelChi2Change(minRelChi2Change);
     df.setUseAbsDCA(useAbsDCA);
     df.setWeightedFinalPCA(useWeightedFinalPCA);
+    fitterConfigHash = getDcaFitterConfigHash(propagateToPCA, useAbsDCA, useWeightedFinalPCA, maxR, maxDZIni, minParamChange, minRelChi2Change);
 
     ccdb->setURL(ccdbUrl);
     ccdb->setCaching(true);
@@ -236,7 +241,7 @@ struct HfCandidateCreator3Prong {
     }
   }
 
-  template <bool doPvRefit = false, o2::hf_centrality::CentralityEstimator centEstimator, typename Coll, typename Cand>
+  template <bool doPvRefit = false, o2::hf_centrality::CentralityEstimator centEstimator, bool useSkimVertex = false, typename Coll, typename Cand>
   void runCreator3ProngWithDCAFitterN(Coll const&,
                                       Cand const& rowsTrackIndexProng3,
                                       TracksWCovExtraPidPiKaPr const&,
@@ -275,29 +280,50 @@ struct HfCandidateCreator3Prong {
       }
       df.setBz(bz);
 
-      // reconstruct the 3-prong secondary vertex
+      // reconstruct the 3-prong secondary vertex,
+      // or take it from the skimming if it was fitted there with the same fitter settings
       hCandidates->Fill(SVFitting::BeforeFit);
-      try {
-        if (df.process(trackParVar0, trackParVar1, trackParVar2) == 0) {
+      std::array<float, 3> secondaryVertex{};
+      std::array<float, 6> covMatrixPCA{};
+      float chi2PCA{0.f};
+      bool isSkimVertexReused{false};
+      if constexpr (useSkimVertex) {
+        if (rowTrackIndexProng3.fitterConfig() == fitterConfigHash) {
+          secondaryVertex = {rowTrackIndexProng3.xSv(), rowTrackIndexProng3.ySv(), rowTrackIndexProng3.zSv()};
+          for (std::size_t iCov = 0; iCov < covMatrixPCA.size(); iCov++) {
+            covMatrixPCA[iCov] = rowTrackIndexProng3.covSv()[iCov];
+          }
+          chi2PCA = rowTrackIndexProng3.chi2Pca();
+          trackParVar0 = getTrackParCovFromArrays(rowTrackIndexProng3.prong0ParPca(), rowTrackIndexProng3.prong0CovPca());
+          trackParVar1 = getTrackParCovFromArrays(rowTrackIndexProng3.prong1ParPca(), rowTrackIndexProng3.prong1CovPca());
+          trackParVar2 = getTrackParCovFromArrays(rowTrackIndexProng3.prong2ParPca(), rowTrackIndexProng3.prong2CovPca());
+          isSkimVertexReused = true;
+        }
+      }
+      if (!isSkimVertexReused) {
+        try {
+          if (df.process(trackParVar0, trackParVar1, trackParVar2) == 0) {
+            continue;
+          }
+        } catch (const std::runtime_error& error) {
+          LOG(info) << "Run time error found: " << error.what() << ". DCAFitterN cannot work, skipping the candidate.";
+          hCandidates->Fill(SVFitting::Fail);
           continue;
         }
-      } catch (const std::runtime_error& error) {
-        LOG(info) << "Run time error found: " << error.what() << ". DCAFitterN cannot work, skipping the candidate.";
-        hCandidates->Fill(SVFitting::Fail);
-        continue;
+        const auto& secondaryVertexFit = df.getPCACandidate();
+        secondaryVertex = {static_cast<float>(secondaryVertexFit[0]), static_cast<float>(secondaryVertexFit[1]), static_cast<float>(secondaryVertexFit[2])};
+        chi2PCA = df.getChi2AtPCACandidate();
+        covMatrixPCA = df.calcPCACovMatrixFlat();
+        trackParVar0 = df.getTrack(0);
+        trackParVar1 = df.getTrack(1);
+        trackParVar2 = df.getTrack(2);
       }
       hCandidates->Fill(SVFitting::FitOk);
 
-      const auto& secondaryVertex = df.getPCACandidate();
-      auto chi2PCA = df.getChi2AtPCACandidate();
-      auto covMatrixPCA = df.calcPCACovMatrixFlat();
       registry.fill(HIST("hCovSVXX"), covMatrixPCA[0]); // FIXME: Calculation of errorDecayLength(XY) gives wrong values without this line.
       registry.fill(HIST("hCovSVYY"), covMatrixPCA[2]);
       registry.fill(HIST("hCovSVXZ"), covMatrixPCA[3]);
       registry.fill(HIST("hCovSVZZ"), covMatrixPCA[5]);
-      trackParVar0 = df.getTrack(0);
-      trackParVar1 = df.getTrack(1);
-      trackParVar2 = df.getTrack(2);
 
       // get track momenta
       std::array<float, 3> pvec0;
@@ -668,6 +694,26 @@ struct HfCandidateCreator3Prong {
   }
   PROCESS_SWITCH(HfCandidateCreator3Prong, processNoPvRefitWithDCAFitterN, "Run candidate creator using DCA fitter without PV refit and w/o centrality selections", true);
 
+  /// @brief process function reusing the DCA fitter vertices of the skimming w/ PV refit and w/o centrality selections
+  void processPvRefitWithSkimVertex(soa::Join<aod::Collisions, aod::EvSels> const& collisions,
+                                    FilteredPvRefitSkimVtxHf3Prongs const& rowsTrackIndexProng3,
+                                    TracksWCovExtraPidPiKaPr const& tracks,
+                                    aod::BCsWithTimestamps const& bcWithTimeStamps)
+  {
+    runCreator3ProngWithDCAFitterN</*doPvRefit*/ true, CentralityEstimator::None, /*useSkimVertex*/ true>(collisions, rowsTrackIndexProng3, tracks, bcWithTimeStamps);
+  }
+  PROCESS_SWITCH(HfCandidateCreator3Prong, processPvRefitWithSkimVertex, "Run candidate creator reusing skim DCA fitter vertices (refit if settings differ) with PV refit and w/o centrality selections", false);
+
+  /// @brief process function reusing the DCA fitter vertices of the skimming w/o PV refit and w/o centrality selections
+  void processNoPvRefitWithSkimVertex(soa::Join<aod::Collisions, aod::EvSels> const& collisions,
+                                      FilteredSkimVtxHf3Prongs const& rowsTrackIndexProng3,
+                                      TracksWCovExtraPidPiKaPr const& tracks,
+                                      aod::BCsWithTimestamps const& bcWithTimeStamps)
+  {
+    runCreator3ProngWithDCAFitterN</*doPvRefit*/ false, CentralityEstimator::None, /*useSkimVertex*/ true>(collisions, rowsTrackIndexProng3, tracks, bcWithTimeStamps);
+  }
+  PROCESS_SWITCH(HfCandidateCreator3Prong, processNoPvRefitWithSkimVertex, "Run candidate creator reusing skim DCA fitter vertices (refit if settings differ) without PV refit and w/o centrality selections", false);
+
   /// @brief process function using KFParticle package  w/ PV refit and w/o centrality selections
   void processPvRefitWithKFParticle(soa::Join<aod::Collisions, aod::EvSels> const& collisions,
                                     FilteredPvRefitHf3Prongs const& rowsTrackIndexProng3,
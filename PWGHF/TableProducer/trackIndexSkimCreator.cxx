@@ -55,6 +55,7 @@
 #include "PWGHF/Utils/utilsAnalysis.h"
 #include "PWGHF/Utils/utilsBfieldCCDB.h"
 #include "PWGHF/Utils/utilsEvSelHf.h"
+#include "PWGHF/Utils/utilsTrkCandHf.h"
 
 using namespace o2;
 using namespace o2::analysis;
@@ -1123,6 +1124,8 @@ struct HfTrackIndexSkimCreator {
   Produces<aod::Hf3Prongs> rowTrackIndexProng3;
   Produces<aod::HfCutStatus3Prong> rowProng3CutStatus;
   Produces<aod::HfPvRefit3Prong> rowProng3PVrefit;
+  Produces<aod::HfSkimVtx2Prong> rowProng2SkimVtx;
+  Produces<aod::HfSkimVtx3Prong> rowProng3SkimVtx;
   Produces<aod::HfDstars> rowTrackIndexDstar;
   Produces<aod::HfCutStatusDstar> rowDstarCutStatus;
   Produces<aod::HfPvRefitDstar> rowDstarPVrefit;
@@ -1152,6 +1155,7 @@ struct HfTrackIndexSkimCreator {
     Configurable<double> maxDZIni{"maxDZIni", 4., "reject (if>0) PCA candidate if tracks DZ exceeds threshold"};
     Configurable<double> minParamChange{"minParamChange", 1.e-3, "stop iterations if largest change of any X is smaller than this"};
     Configurable<double> minRelChi2Change{"minRelChi2Change", 0.9, "stop iterations if chi2/chi2old > this"};
+    Configurable<bool> fillSkimVertices{"fillSkimVertices", false, "store the 2-prong and 3-prong secondary-vertex fits for reuse in the candidate creators"};
     // CCDB
     Configurable<std::string> ccdbUrl{"ccdbUrl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
     Configurable<std::string> ccdbPathLut{"ccdbPathLut", "GLO/Param/MatLUT", "Path for LUT parametrization"};
@@ -1206,6 +1210,7 @@ struct HfTrackIndexSkimCreator {
   SliceCache cache;
   o2::vertexing::DCAFitterN<2> df2; // 2-prong vertex fitter
   o2::vertexing::DCAFitterN<3> df3; // 3-prong vertex fitter
+  uint32_t fitterConfigHash{0};      // fingerprint of the fitter settings stored with the skim vertices
   // Needed for PV refitting
   Service<o2::ccdb::BasicCCDBManager> ccdb;
   o2::base::MatLayerCylSet* lut;
@@ -1324,6 +1329,8 @@ struct HfTrackIndexSkimCreator {
     df3.setMinRelChi2Change(config.minRelChi2Change);
     df3.setUseAbsDCA(config.useAbsDCA);
     df3.setWeightedFinalPCA(config.useWeightedFinalPCA);
+    fitterConfigHash = hf_trkcandsel::getDcaFitterConfigHash(config.propagateToPCA, config.useAbsDCA, config.useWeightedFinalPCA,
+                                                             config.maxR, config.maxDZIni, config.minParamChange, config.minRelChi2Change);
 
     ccdb->setURL(config.ccdbUrl);
     ccdb->setCaching(true);
@@ -1697,6 +1704,30 @@ struct HfTrackIndexSkimCreator {
     }
   }
 
+  /// Method to store the secondary-vertex fit of the last processed candidate for reuse in the candidate creators
+  /// \param dcaFitter is the DCAFitter used for the vertex
+  /// \param cursor is the table cursor matching the number of prongs
+  template <int nProngs, typename TCursor>
+  void fillSkimVertex(o2::vertexing::DCAFitterN<nProngs>& dcaFitter, TCursor& cursor)
+  {
+    const auto& secVtx = dcaFitter.getPCACandidate();
+    const auto covSecVtxFlat = dcaFitter.calcPCACovMatrixFlat();
+    float covSecVtx[6];
+    std::copy(covSecVtxFlat.begin(), covSecVtxFlat.end(), covSecVtx);
+    float parProngs[nProngs][7];
+    float covProngs[nProngs][15];
+    for (int iProng = 0; iProng < nProngs; iProng++) {
+      hf_trkcandsel::getTrackParCovArrays(dcaFitter.getTrack(iProng), parProngs[iProng], covProngs[iProng]);
+    }
+    if constexpr (nProngs == 2) {
+      cursor(fitterConfigHash, secVtx[0], secVtx[1], secVtx[2], covSecVtx, dcaFitter.getChi2AtPCACandidate(),
+             parProngs[0], covProngs[0], parProngs[1], covProngs[1]);
+    } else {
+      cursor(fitterConfigHash, secVtx[0], secVtx[1], secVtx[2], covSecVtx, dcaFitter.getChi2AtPCACandidate(),
+             parProngs[0], covProngs[0], parProngs[1], covProngs[1], parProngs[2], covProngs[2]);
+    }
+  }
+
   /// Method to perform selections for 2-prong candidates after vertex reconstruction
   /// \param secVtx is the secondary vertex
   /// \param primVtx is the primary vertex
@@ -2270,6 +2301,9 @@ struct HfTrackIndexSkimCreator {
                 if (isSelected2ProngCand > 0) {
                   // fill table row
                   rowTrackIndexProng2(thisCollId, trackPos1.globalIndex(), trackNeg1.globalIndex(), isSelected2ProngCand);
+                  if (config.fillSkimVertices) {
+                    fillSkimVertex(df2, rowProng2SkimVtx);
+                  }
                   if (config.applyMlForHfFilters) {
                     rowTrackIndexMlScoreProng2(mlScoresD0);
                   }
@@ -2538,6 +2572,9 @@ struct HfTrackIndexSkimCreator {
 
               // fill table row
               rowTrackIndexProng3(thisCollId, trackPos1.globalIndex(), trackNeg1.globalIndex(), trackPos2.globalIndex(), isSelected3ProngCand);
+              if (config.fillSkimVertices) {
+                fillSkimVertex(df3, rowProng3SkimVtx);
+              }
               if (config.applyMlForHfFilters) {
                 rowTrackIndexMlScoreProng3(mlScores3Prongs[0], mlScores3Prongs[1], mlScores3Prongs[2], mlScores3Prongs[3]);
               }
@@ -2791,6 +2828,9 @@ struct HfTrackIndexSkimCreator {
 
               // fill table row
               rowTrackIndexProng3(thisCollId, trackNeg1.globalIndex(), trackPos1.globalIndex(), trackNeg2.globalIndex(), isSelected3ProngCand);
+              if (config.fillSkimVertices) {
+                fillSkimVertex(df3, rowProng3SkimVtx);
+              }
               if (config.applyMlForHfFilters) {
                 rowTrackIndexMlScoreProng3(mlScores3Prongs[0], mlScores3Prongs[1], mlScores3Prongs[2], mlScores3Prongs[3]);
               }
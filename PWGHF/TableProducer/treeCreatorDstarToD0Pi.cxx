@@ -20,6 +20,8 @@
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
 
+#include "Common/Core/ColumnarTableWriter.h"
+
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
 
@@ -569,7 +571,11 @@ struct HfTreeCreatorDstarToD0Pi {
   PROCESS_SWITCH(HfTreeCreatorDstarToD0Pi, processMc, "Process MC", false);
 };
 
+/// Default name of the columnar export file of the full candidate table
+static constexpr char ColumnarExportFileName[] = "HfCandDstFull.arrow";
+
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
 {
-  return WorkflowSpec{adaptAnalysisTask<HfTreeCreatorDstarToD0Pi>(cfgc)};
+  return WorkflowSpec{adaptAnalysisTask<HfTreeCreatorDstarToD0Pi>(cfgc),
+                      adaptAnalysisTask<o2::common::core::ColumnarTableExportTask<o2::aod::HfCandDstFulls, ColumnarExportFileName>>(cfgc, TaskName{"hf-tree-creator-dstar-to-d0-pi-columnar-export"})};
 }
@@ -25,6 +25,7 @@
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
 
+#include "Common/Core/ColumnarTableWriter.h"
 #include "Common/DataModel/Centrality.h"
 #include "Common/DataModel/Multiplicity.h"
 
@@ -1186,9 +1187,13 @@ struct HfTreeCreatorLcToPKPi {
   PROCESS_SWITCH(HfTreeCreatorLcToPKPi, processDataWithCentralityWithKFParticle, "Process data tree writer with centrality with KFParticle", false);
 };
 
+/// Default name of the columnar export file of the full candidate table
+static constexpr char ColumnarExportFileName[] = "HfCandLcFull.arrow";
+
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
 {
   WorkflowSpec workflow;
   workflow.push_back(adaptAnalysisTask<HfTreeCreatorLcToPKPi>(cfgc));
+  workflow.push_back(adaptAnalysisTask<o2::common::core::ColumnarTableExportTask<o2::aod::HfCandLcFulls, ColumnarExportFileName>>(cfgc, TaskName{"hf-tree-creator-lc-to-p-k-pi-columnar-export"}));
   return workflow;
 }
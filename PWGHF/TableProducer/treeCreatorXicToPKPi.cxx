@@ -20,6 +20,8 @@
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
 
+#include "Common/Core/ColumnarTableWriter.h"
+
 #include "PWGHF/Core/HfHelper.h"
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
@@ -521,9 +523,13 @@ struct HfTreeCreatorXicToPKPi {
   PROCESS_SWITCH(HfTreeCreatorXicToPKPi, processMc, "Process MC tree writer", false);
 };
 
+/// Default name of the columnar export file of the full candidate table
+static constexpr char ColumnarExportFileName[] = "HfCandXicFull.arrow";
+
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
 {
   WorkflowSpec workflow;
   workflow.push_back(adaptAnalysisTask<HfTreeCreatorXicToPKPi>(cfgc));
+  workflow.push_back(adaptAnalysisTask<o2::common::core::ColumnarTableExportTask<o2::aod::HfCandXicFulls, ColumnarExportFileName>>(cfgc, TaskName{"hf-tree-creator-xic-to-p-k-pi-columnar-export"}));
   return workflow;
 }
@@ -19,9 +19,12 @@
 #include "PWGHF/Utils/utilsAnalysis.h"
 
 #include <Framework/HistogramSpec.h>
+#include <ReconstructionDataFormats/Track.h>
 
 #include <Rtypes.h>
 
+#include <array>
+#include <bit>
 #include <cstdint>
 
 namespace o2::hf_trkcandsel
@@ -83,6 +86,62 @@ bool isSelectedTrackDCA(const T1& trackPar, const T2& dca, const C1& binsPtTrack
   return true;
 }
 
+/// @brief Function to compute a fingerprint of the DCAFitterN settings that affect the secondary-vertex fit
+/// \note Used to decide whether a vertex fitted in the skimming can be reused in the candidate creators.
+/// Floating-point settings are compared at single precision, so that configuration round-trips do not spoil the match.
+/// \return 32-bit FNV-1a hash of the settings
+uint32_t getDcaFitterConfigHash(bool propagateToPCA, bool useAbsDCA, bool useWeightedFinalPCA,
+                                double maxR, double maxDZIni, double minParamChange, double minRelChi2Change)
+{
+  uint32_t hash = 2166136261u;
+  auto mix = [&hash](uint32_t word) {
+    for (int iByte = 0; iByte < 4; iByte++) {
+      hash ^= (word >> (8 * iByte)) & 0xFFu;
+      hash *= 16777619u;
+    }
+  };
+  mix(static_cast<uint32_t>(propagateToPCA) | (static_cast<uint32_t>(useAbsDCA) << 1) | (static_cast<uint32_t>(useWeightedFinalPCA) << 2));
+  for (const double value : {maxR, maxDZIni, minParamChange, minRelChi2Change}) {
+    mix(std::bit_cast<uint32_t>(static_cast<float>(value)));
+  }
+  return hash;
+}
+
+/// @brief Function to flatten a track parametrisation with covariance into arrays suitable for table columns
+/// \param trackParCov is the track parametrisation
+/// \param par is filled with x, alpha and the 5 track parameters
+/// \param cov is filled with the 15 covariance-matrix elements
+template <typename T>
+void getTrackParCovArrays(T const& trackParCov, float (&par)[7], float (&cov)[15])
+{
+  par[0] = trackParCov.getX();
+  par[1] = trackParCov.getAlpha();
+  for (int iPar = 0; iPar < o2::track::kNParams; iPar++) {
+    par[2 + iPar] = trackParCov.getParam(iPar);
+  }
+  for (int iCov = 0; iCov < o2::track::kCovMatSize; iCov++) {
+    cov[iCov] = trackParCov.getCov()[iCov];
+  }
+}
+
+/// @brief Function to rebuild a track parametrisation with covariance from the arrays filled by getTrackParCovArrays
+/// \param par is the array with x, alpha and the 5 track parameters
+/// \param cov is the array with the 15 covariance-matrix elements
+/// \return track parametrisation with covariance
+template <typename TPar, typename TCov>
+o2::track::TrackParCov getTrackParCovFromArrays(TPar const& par, TCov const& cov)
+{
+  std::array<float, o2::track::kNParams> arrayPar{};
+  std::array<float, o2::track::kCovMatSize> arrayCov{};
+  for (int iPar = 0; iPar < o2::track::kNParams; iPar++) {
+    arrayPar[iPar] = par[2 + iPar];
+  }
+  for (int iCov = 0; iCov < o2::track::kCovMatSize; iCov++) {
+    arrayCov[iCov] = cov[iCov];
+  }
+  return o2::track::TrackParCov(par[0], par[1], arrayPar, arrayCov);
+}
+
 } // namespace o2::hf_trkcandsel
 
 #endif // PWGHF_UTILS_UTILSTRKCANDHF_H_
@@ -32,10 +32,12 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <numeric>
 #include <ostream>
 #include <stdexcept>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include <math.h>
@@ -411,149 +413,221 @@ auto constexpr getConstituentId(T const& track)
   }
 }
 
-template <bool isEMCAL, bool isCandidate, bool jetsBaseIsMc, bool jetsTagIsMc, typename T, typename U, typename V, typename O, typename P, typename Q, typename R, typename S>
-float getPtSum(T const& tracksBase, U const& candidatesBase, V const& clustersBase, O const& tracksTag, P const& candidatesTag, Q const& clustersTag, R const& fullTracksBase, S const& fullTracksTag)
+template <typename T, typename U>
+auto getConstituents(T const& jet, U const& /*constituents*/)
+{
+  if constexpr (jetfindingutilities::isEMCALClusterTable<U>()) {
+    return jet.template clusters_as<U>();
+  } else if constexpr (jetcandidateutilities::isCandidateTable<U>() || jetcandidateutilities::isCandidateMcTable<U>()) {
+    return jet.template candidates_as<U>();
+  } else if constexpr (jetfindingutilities::isDummyTable<U>() || std::is_same_v<U, o2::aod::JCollisions> || std::is_same_v<U, o2::aod::JMcCollisions>) { // this is for the case where EMCal clusters or candidates are tested but no clusters or candidates exist and dummy tables are used, like in the case of charged jet analyses
+    return nullptr;
+  } else {
+    return jet.template tracks_as<U>();
+  }
+}
+
+/**
+ * Hash index from a constituent id (track, cluster MC particle or candidate id) to the positions of the jets
+ * containing it. The entries of each id are chained in flat arrays, so that filling the index for all jets of a
+ * collision only allocates when it grows.
+ */
+class ConstituentJetIndex
+{
+ public:
+  void clear()
+  {
+    mHeads.clear();
+    mJets.clear();
+    mNext.clear();
+  }
+
+  void add(int64_t id, int jetPosition)
+  {
+    auto [head, inserted] = mHeads.try_emplace(id, -1);
+    mJets.push_back(jetPosition);
+    mNext.push_back(head->second);
+    head->second = static_cast<int>(mJets.size()) - 1;
+  }
+
+  /// calls func(jetPosition) for every jet entry of this id
+  template <typename F>
+  void forEach(int64_t id, F&& func) const
+  {
+    auto head = mHeads.find(id);
+    if (head == mHeads.end()) {
+      return;
+    }
+    for (int entry = head->second; entry >= 0; entry = mNext[entry]) {
+      func(mJets[entry]);
+    }
+  }
+
+ private:
+  std::unordered_map<int64_t, int> mHeads; ///< id -> last entry of the id
+  std::vector<int> mJets;                  ///< jet position of each entry
+  std::vector<int> mNext;                  ///< previous entry of the same id, -1 at the end of the chain
+};
+
+/**
+ * One direction of the pt matching: for each base jet, sums the pt of its constituents shared with each tag jet of
+ * the same R and stores the tag jets with a shared pt above minPtFraction of the base jet pt.
+ *
+ * The tag constituents are indexed once per collision, and each base constituent is looked up once, so the cost is
+ * linear in the number of constituents instead of quadratic in the number of jets and constituents. The shared pt
+ * (tracks, EMCal clusters and leading candidate) is accumulated in the same order as the pairwise comparison, so the
+ * matching is unchanged; only tag jets sharing at least one constituent are considered, i.e. minPtFraction is
+ * assumed to be non-negative.
+ */
+template <bool isEMCAL, bool isCandidate, bool jetsBaseIsMc, bool jetsTagIsMc, typename T, typename U, typename V, typename M, typename N, typename O, typename P, typename Q>
+void MatchPtOneDirection(T const& jetsBasePerCollision, U const& jetsTagPerCollision, std::vector<std::vector<int>>& baseToTagMatchingPt, V const& tracksBase, M const& candidatesBase, N const& clustersBase, O const& tracksTag, P const& candidatesTag, Q const& clustersTag, float minPtFraction)
 {
-  std::vector<int> particleTracker;
-  float ptSum = 0.;
-  for (const auto& trackBase : tracksBase) {
-    auto trackBaseId = getConstituentId<jetsTagIsMc>(trackBase);
-    for (const auto& trackTag : tracksTag) {
+  // tag side: indices from the constituent ids to the tag jets
+  // the base constituent ids (getConstituentId<jetsTagIsMc>) are compared with the tag ones (getConstituentId<jetsBaseIsMc>)
+  // for EMCal, the cluster MC particles of one side are compared with the global indices of the particles of the other side,
+  // which are the tag ids of the tracks when the tag side is MC
+  std::vector<int> tagJetIds;
+  std::vector<double> tagJetR;
+  std::vector<float> tagCandidatePt;
+  ConstituentJetIndex tagTrackIndex;
+  ConstituentJetIndex tagClusterIndex;
+  ConstituentJetIndex tagCandidateIndex;
+  int tagPosition = 0;
+  for (const auto& jetTag : jetsTagPerCollision) {
+    tagJetIds.push_back(jetTag.globalIndex());
+    tagJetR.push_back(std::round(jetTag.r()));
+    tagCandidatePt.push_back(0.);
+    for (const auto& trackTag : getConstituents(jetTag, tracksTag)) {
       auto trackTagId = getConstituentId<jetsBaseIsMc>(trackTag);
-      if (trackBaseId != -1 && trackBaseId == trackTagId) {
-        ptSum += trackBase.pt();
-        if constexpr (jetsBaseIsMc) {
-          particleTracker.push_back(trackBaseId);
-        }
-        break;
+      if (trackTagId != -1) {
+        tagTrackIndex.add(trackTagId, tagPosition);
       }
     }
-  }
-  if constexpr (isEMCAL) {
-    if constexpr (jetsTagIsMc) {
-      for (const auto& clusterBase : clustersBase) {
-        for (const auto& clusterBaseParticleId : clusterBase.mcParticlesIds()) {
-          bool isClusterMatched = false;
-          for (const auto& trackTag : tracksTag) {
-            if (clusterBaseParticleId != -1 && clusterBaseParticleId == trackTag.globalIndex()) {
-              ptSum += clusterBase.energy() / std::cosh(clusterBase.eta());
-              isClusterMatched = true;
-              break;
-            }
-          }
-          if (isClusterMatched) {
-            break;
+    if constexpr (isEMCAL && jetsBaseIsMc) {
+      for (const auto& clusterTag : getConstituents(jetTag, clustersTag)) {
+        for (const auto& clusterTagParticleId : clusterTag.mcParticlesIds()) {
+          if (clusterTagParticleId != -1) {
+            tagClusterIndex.add(clusterTagParticleId, tagPosition);
           }
         }
       }
     }
-    if constexpr (jetsBaseIsMc) {
-      for (const auto& trackBase : tracksBase) {
-        if (std::find(particleTracker.begin(), particleTracker.end(), trackBase.globalIndex()) != particleTracker.end()) {
-          continue;
-        }
-        auto trackBaseId = trackBase.globalIndex();
-        for (const auto& clusterTag : clustersTag) {
-          bool isClusterMatched = false;
-          for (const auto& clusterTagParticleId : clusterTag.mcParticlesIds()) {
-            if (trackBaseId != -1 && trackBaseId == clusterTagParticleId) {
-              ptSum += trackBase.pt();
-              isClusterMatched = true;
-              break;
-            }
-          }
-          if (isClusterMatched) {
-            break;
+    if constexpr (isCandidate) {
+      for (const auto& candidateTag : getConstituents(jetTag, candidatesTag)) { // only the first candidate is compared
+        if constexpr (jetsTagIsMc) {
+          tagCandidateIndex.add(candidateTag.mcParticleId(), tagPosition);
+        } else if constexpr (jetsBaseIsMc) {
+          if (jetcandidateutilities::isMatchedCandidate(candidateTag)) {
+            tagCandidateIndex.add(jetcandidateutilities::matchedParticleId(candidateTag, tracksTag, tracksBase), tagPosition);
+            tagCandidatePt.back() = candidateTag.pt();
           }
+        } else {
+          tagCandidateIndex.add(candidateTag.globalIndex(), tagPosition);
         }
+        break;
       }
     }
+    tagPosition++;
   }
-  if constexpr (isCandidate) {
-    if constexpr (jetsTagIsMc) {
-      for (auto const& candidateBase : candidatesBase) {
-        if (jetcandidateutilities::isMatchedCandidate(candidateBase)) {
-          const auto candidateBaseMcId = jetcandidateutilities::matchedParticleId(candidateBase, fullTracksBase, fullTracksTag);
-          for (auto const& candidateTag : candidatesTag) {
-            const auto candidateTagId = candidateTag.mcParticleId();
-            if (candidateBaseMcId == candidateTagId) {
-              ptSum += candidateBase.pt();
+
+  // base side: one lookup per constituent, accumulating the shared pt of every tag jet touched by the base jet
+  const auto nTagJets = tagJetIds.size();
+  std::vector<float> ptSum(nTagJets, 0.);
+  std::vector<int> touchedByJet(nTagJets, -1);         // last base jet that touched the tag jet
+  std::vector<int> touchedByConstituent(nTagJets, -1); // last base constituent that touched the tag jet
+  std::vector<int> touchedTagJets;
+  int basePosition = 0;
+  int constituentCounter = 0;
+  for (const auto& jetBase : jetsBasePerCollision) {
+    const double jetBaseR = std::round(jetBase.r());
+    touchedTagJets.clear();
+    auto addPt = [&](int tagJet, float pt) {
+      if (tagJetR[tagJet] != jetBaseR) {
+        return;
+      }
+      if (touchedByJet[tagJet] != basePosition) {
+        touchedByJet[tagJet] = basePosition;
+        ptSum[tagJet] = 0.;
+        touchedTagJets.push_back(tagJet);
+      }
+      ptSum[tagJet] += pt;
+    };
+    // each base constituent contributes at most once to each tag jet
+    auto addPtOnce = [&](int tagJet, float pt) {
+      if (touchedByConstituent[tagJet] == constituentCounter) {
+        return;
+      }
+      touchedByConstituent[tagJet] = constituentCounter;
+      addPt(tagJet, pt);
+    };
+
+    auto jetBaseTracks = getConstituents(jetBase, tracksBase);
+    for (const auto& trackBase : jetBaseTracks) {
+      constituentCounter++;
+      auto trackBaseId = getConstituentId<jetsTagIsMc>(trackBase);
+      if (trackBaseId == -1) {
+        continue;
+      }
+      const float trackBasePt = trackBase.pt();
+      tagTrackIndex.forEach(trackBaseId, [&](int tagJet) { addPtOnce(tagJet, trackBasePt); });
+    }
+    if constexpr (isEMCAL) {
+      if constexpr (jetsTagIsMc) {
+        for (const auto& clusterBase : getConstituents(jetBase, clustersBase)) {
+          constituentCounter++;
+          const float clusterBasePt = clusterBase.energy() / std::cosh(clusterBase.eta());
+          for (const auto& clusterBaseParticleId : clusterBase.mcParticlesIds()) {
+            if (clusterBaseParticleId != -1) {
+              tagTrackIndex.forEach(clusterBaseParticleId, [&](int tagJet) { addPtOnce(tagJet, clusterBasePt); });
             }
-            break; // should only be one
           }
         }
-        break;
       }
-    } else if constexpr (jetsBaseIsMc) {
-      for (auto const& candidateTag : candidatesTag) {
-        if (jetcandidateutilities::isMatchedCandidate(candidateTag)) {
-          const auto candidateTagMcId = jetcandidateutilities::matchedParticleId(candidateTag, fullTracksTag, fullTracksBase);
-          for (auto const& candidateBase : candidatesBase) {
-            const auto candidateBaseId = candidateBase.mcParticleId();
-            if (candidateTagMcId == candidateBaseId) {
-              ptSum += candidateTag.pt();
-            }
-            break; // should only be one
-          }
+      if constexpr (jetsBaseIsMc) {
+        for (const auto& trackBase : jetBaseTracks) {
+          constituentCounter++;
+          auto trackBaseId = trackBase.globalIndex();
+          const float trackBasePt = trackBase.pt();
+          // particles already counted through a tag track are not counted again through a tag cluster
+          tagTrackIndex.forEach(trackBaseId, [&](int tagJet) { touchedByConstituent[tagJet] = constituentCounter; });
+          tagClusterIndex.forEach(trackBaseId, [&](int tagJet) { addPtOnce(tagJet, trackBasePt); });
         }
-        break;
       }
-    } else {
-      for (auto const& candidateBase : candidatesBase) {
-        for (auto const& candidateTag : candidatesTag) {
-          if (candidateBase.globalIndex() == candidateTag.globalIndex()) {
-            ptSum += candidateBase.pt();
+    }
+    if constexpr (isCandidate) {
+      for (const auto& candidateBase : getConstituents(jetBase, candidatesBase)) { // only the first candidate is compared
+        if constexpr (jetsTagIsMc) {
+          if (jetcandidateutilities::isMatchedCandidate(candidateBase)) {
+            const float candidateBasePt = candidateBase.pt();
+            tagCandidateIndex.forEach(jetcandidateutilities::matchedParticleId(candidateBase, tracksBase, tracksTag), [&](int tagJet) { addPt(tagJet, candidateBasePt); });
           }
-          break; // should only be one
+        } else if constexpr (jetsBaseIsMc) {
+          tagCandidateIndex.forEach(candidateBase.mcParticleId(), [&](int tagJet) { addPt(tagJet, tagCandidatePt[tagJet]); });
+        } else {
+          const float candidateBasePt = candidateBase.pt();
+          tagCandidateIndex.forEach(candidateBase.globalIndex(), [&](int tagJet) { addPt(tagJet, candidateBasePt); });
         }
         break;
       }
     }
-  }
-  return ptSum;
-}
 
-template <typename T, typename U>
-auto getConstituents(T const& jet, U const& /*constituents*/)
-{
-  if constexpr (jetfindingutilities::isEMCALClusterTable<U>()) {
-    return jet.template clusters_as<U>();
-  } else if constexpr (jetcandidateutilities::isCandidateTable<U>() || jetcandidateutilities::isCandidateMcTable<U>()) {
-    return jet.template candidates_as<U>();
-  } else if constexpr (jetfindingutilities::isDummyTable<U>() || std::is_same_v<U, o2::aod::JCollisions> || std::is_same_v<U, o2::aod::JMcCollisions>) { // this is for the case where EMCal clusters or candidates are tested but no clusters or candidates exist and dummy tables are used, like in the case of charged jet analyses
-    return nullptr;
-  } else {
-    return jet.template tracks_as<U>();
+    std::sort(touchedTagJets.begin(), touchedTagJets.end()); // keep the matches in the order of the tag jets
+    for (const auto& tagJet : touchedTagJets) {
+      if (ptSum[tagJet] > jetBase.pt() * minPtFraction) {
+        baseToTagMatchingPt[jetBase.globalIndex()].push_back(tagJetIds[tagJet]);
+      }
+    }
+    basePosition++;
   }
 }
 
 template <bool jetsBaseIsMc, bool jetsTagIsMc, typename T, typename U, typename V, typename M, typename N, typename O, typename P, typename Q>
 void MatchPt(T const& jetsBasePerCollision, U const& jetsTagPerCollision, std::vector<std::vector<int>>& baseToTagMatchingPt, std::vector<std::vector<int>>& tagToBaseMatchingPt, V const& tracksBase, M const& candidatesBase, N const& clustersBase, O const& tracksTag, P const& candidatesTag, Q const& clustersTag, float minPtFraction)
 {
-  float ptSumBase;
-  float ptSumTag;
-  for (const auto& jetBase : jetsBasePerCollision) {
-    auto jetBaseTracks = getConstituents(jetBase, tracksBase);
-    auto jetBaseClusters = getConstituents(jetBase, clustersBase);
-    auto jetBaseCandidates = getConstituents(jetBase, candidatesBase);
-    for (const auto& jetTag : jetsTagPerCollision) {
-      if (std::round(jetBase.r()) != std::round(jetTag.r())) {
-        continue;
-      }
-      auto jetTagTracks = getConstituents(jetTag, tracksTag);
-      auto jetTagClusters = getConstituents(jetTag, clustersTag);
-      auto jetTagCandidates = getConstituents(jetTag, candidatesTag);
-
-      ptSumBase = getPtSum < jetfindingutilities::isEMCALClusterTable<N>() || jetfindingutilities::isEMCALClusterTable<Q>(), (jetcandidateutilities::isCandidateTable<M>() || jetcandidateutilities::isCandidateMcTable<M>()) && (jetcandidateutilities::isCandidateTable<P>() || jetcandidateutilities::isCandidateMcTable<P>()), jetsBaseIsMc, jetsTagIsMc > (jetBaseTracks, jetBaseCandidates, jetBaseClusters, jetTagTracks, jetTagCandidates, jetTagClusters, tracksBase, tracksTag);
-      ptSumTag = getPtSum < jetfindingutilities::isEMCALClusterTable<N>() || jetfindingutilities::isEMCALClusterTable<Q>(), (jetcandidateutilities::isCandidateTable<M>() || jetcandidateutilities::isCandidateMcTable<M>()) && (jetcandidateutilities::isCandidateTable<P>() || jetcandidateutilities::isCandidateMcTable<P>()), jetsTagIsMc, jetsBaseIsMc > (jetTagTracks, jetTagCandidates, jetTagClusters, jetBaseTracks, jetBaseCandidates, jetBaseClusters, tracksTag, tracksBase);
-      if (ptSumBase > jetBase.pt() * minPtFraction) {
-        baseToTagMatchingPt[jetBase.globalIndex()].push_back(jetTag.globalIndex());
-      }
-      if (ptSumTag > jetTag.pt() * minPtFraction) {
-        tagToBaseMatchingPt[jetTag.globalIndex()].push_back(jetBase.globalIndex());
-      }
-    }
-  }
+  constexpr bool isEMCAL = jetfindingutilities::isEMCALClusterTable<N>() || jetfindingutilities::isEMCALClusterTable<Q>();
+  constexpr bool isCandidate = (jetcandidateutilities::isCandidateTable<M>() || jetcandidateutilities::isCandidateMcTable<M>()) && (jetcandidateutilities::isCandidateTable<P>() || jetcandidateutilities::isCandidateMcTable<P>());
+  MatchPtOneDirection<isEMCAL, isCandidate, jetsBaseIsMc, jetsTagIsMc>(jetsBasePerCollision, jetsTagPerCollision, baseToTagMatchingPt, tracksBase, candidatesBase, clustersBase, tracksTag, candidatesTag, clustersTag, minPtFraction);
+  MatchPtOneDirection<isEMCAL, isCandidate, jetsTagIsMc, jetsBaseIsMc>(jetsTagPerCollision, jetsBasePerCollision, tagToBaseMatchingPt, tracksTag, candidatesTag, clustersTag, tracksBase, candidatesBase, clustersBase, minPtFraction);
 }
 
 // function that calls all the Match functions
@@ -30,13 +30,293 @@
 #include <fastjet/contrib/Nsubjettiness.hh>
 #include <fastjet/contrib/SoftDrop.hh>
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <limits>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace jetsubstructureutilities
 {
 
+/// Splitting of the Cambridge/Aachen declustering of a jet
+struct LundSplitting {
+  double z = -1.;              ///< momentum fraction of the softer branch
+  double theta = -1.;          ///< distance in rapidity-azimuth between the branches
+  double kt = -1.;             ///< transverse momentum of the softer branch relative to the harder one
+  double ptLeading = -1.;      ///< transverse momentum of the harder branch
+  double ptSubLeading = -1.;   ///< transverse momentum of the softer branch
+  double energyMother = -1.;   ///< energy of the declustered subjet
+  double massMother = -1.;     ///< mass of the declustered subjet
+  double massLeading = -1.;    ///< mass of the harder branch
+  double massSubLeading = -1.; ///< mass of the softer branch
+  int leading = -1;            ///< node of the harder branch
+  int subLeading = -1;         ///< node of the softer branch
+  int primary = -1;            ///< -1 for primary splittings, index of the primary splitting of the declustered softer branch otherwise
+};
+
+/// Lightweight Cambridge/Aachen reclusterer for the constituents of a single jet
+///
+/// The constituents are reclustered with the E-scheme in a flat array of nodes, without area, ghosts or cluster sequence
+/// bookkeeping, and the Lund declustering sequence is written into a caller-provided buffer. The distance, rapidity and
+/// azimuth conventions follow fastjet, so the declustering history is the one of the fastjet C/A reclustering.
+/// All buffers are kept between jets.
+class CADeclusterer
+{
+ public:
+  /// Reclustering radius, same as the one of JetFinder in reclustering mode (5 x 0.4), large enough to merge all constituents of a jet
+  static constexpr double DefaultR = 2.0;
+
+  /// Reclusters the constituents, returns false if there are none
+  /// \param constituents jet constituents, the fastjet_user_info of each constituent is kept in the leaves
+  /// \param R reclustering radius
+  bool recluster(const std::vector<fastjet::PseudoJet>& constituents, double R = DefaultR)
+  {
+    mNodes.clear();
+    mActive.clear();
+    mJet = -1;
+    for (const auto& constituent : constituents) {
+      int status = -9, index = -9;
+      if (constituent.has_user_info<fastjetutilities::fastjet_user_info>()) {
+        status = constituent.user_info<fastjetutilities::fastjet_user_info>().getStatus();
+        index = constituent.user_info<fastjetutilities::fastjet_user_info>().getIndex();
+      }
+      mActive.push_back(addNode(constituent.px(), constituent.py(), constituent.pz(), constituent.E(), -1, -1, status, index));
+    }
+    if (mActive.empty()) {
+      return false;
+    }
+    const double r2 = R * R;
+    const int nActive = mActive.size();
+    mNN.assign(nActive, -1);
+    mNNDist.assign(nActive, std::numeric_limits<double>::max());
+    for (int i = 0; i < nActive; i++) {
+      updateNN(i);
+    }
+    while (mActive.size() > 1) {
+      int iMin = 0;
+      for (int i = 1; i < static_cast<int>(mActive.size()); i++) {
+        if (mNNDist[i] < mNNDist[iMin]) {
+          iMin = i;
+        }
+      }
+      if (!(mNNDist[iMin] < r2)) {
+        break; // all remaining subjets are inclusive jets
+      }
+      const int nodeA = mActive[iMin];
+      const int nodeB = mNN[iMin];
+      const Node& a = mNodes[nodeA];
+      const Node& b = mNodes[nodeB];
+      const int merged = addNode(a.px + b.px, a.py + b.py, a.pz + b.pz, a.e + b.e, nodeA, nodeB, -9, -9);
+      // the merged node takes the position of A, the position of B is removed
+      mActive[iMin] = merged;
+      for (int i = 0; i < static_cast<int>(mActive.size()); i++) {
+        if (mActive[i] == nodeB) {
+          mActive[i] = mActive.back();
+          mNN[i] = mNN.back();
+          mNNDist[i] = mNNDist.back();
+          mActive.pop_back();
+          mNN.pop_back();
+          mNNDist.pop_back();
+          break;
+        }
+      }
+      for (int i = 0; i < static_cast<int>(mActive.size()); i++) {
+        if (mActive[i] == merged || mNN[i] == nodeA || mNN[i] == nodeB) {
+          updateNN(i);
+        } else {
+          const double dist = distance2(mActive[i], merged);
+          if (dist < mNNDist[i]) {
+            mNNDist[i] = dist;
+            mNN[i] = merged;
+          }
+        }
+      }
+    }
+    mJet = mActive[0];
+    for (const auto& node : mActive) {
+      if (mNodes[node].pt2 > mNodes[mJet].pt2) {
+        mJet = node;
+      }
+    }
+    return true;
+  }
+
+  /// Declusters the hardest reclustered jet, following the harder branch at each step
+  /// \param splittings buffer filled with the primary splittings, followed by the secondary ones if requested
+  /// \param doSecondary also decluster the softer branch of each primary splitting (following its harder branch)
+  void decluster(std::vector<LundSplitting>& splittings, bool doSecondary = false) const
+  {
+    splittings.clear();
+    if (mJet < 0) {
+      return;
+    }
+    declusterBranch(mJet, -1, splittings);
+    if (doSecondary) {
+      const int nPrimary = splittings.size();
+      for (int iPrimary = 0; iPrimary < nPrimary; iPrimary++) {
+        declusterBranch(splittings[iPrimary].subLeading, iPrimary, splittings);
+      }
+    }
+  }
+
+  /// Node of the hardest reclustered jet, -1 if no constituents
+  int jet() const { return mJet; }
+  double pt(int node) const { return std::sqrt(mNodes[node].pt2); }
+  double e(int node) const { return mNodes[node].e; }
+  double rap(int node) const { return mNodes[node].rap; }
+  double phi(int node) const { return mNodes[node].phi; }
+  double m(int node) const
+  {
+    const double mass2 = m2(mNodes[node]);
+    return mass2 < 0.0 ? -std::sqrt(-mass2) : std::sqrt(mass2);
+  }
+  double eta(int node) const
+  {
+    const Node& n = mNodes[node];
+    if (n.px == 0.0 && n.py == 0.0) {
+      return MaxRap;
+    }
+    if (n.pz == 0.0) {
+      return 0.0;
+    }
+    double theta = std::atan(std::sqrt(n.pt2) / n.pz);
+    if (theta < 0) {
+      theta += M_PI;
+    }
+    return -std::log(std::tan(theta / 2));
+  }
+
+  /// Fills the indices of the constituents of a node with a given status, sorted by decreasing pt
+  void constituentIndices(int node, int status, std::vector<int32_t>& indices) const
+  {
+    indices.clear();
+    mLeaves.clear();
+    mStack.clear();
+    mStack.push_back(node);
+    while (!mStack.empty()) {
+      const Node& n = mNodes[mStack.back()];
+      mStack.pop_back();
+      if (n.child1 < 0) {
+        if (n.status == status) {
+          mLeaves.emplace_back(n.pt2, n.index);
+        }
+        continue;
+      }
+      mStack.push_back(n.child1);
+      mStack.push_back(n.child2);
+    }
+    std::sort(mLeaves.begin(), mLeaves.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (const auto& leaf : mLeaves) {
+      indices.push_back(leaf.second);
+    }
+  }
+
+ private:
+  static constexpr double MaxRap = 1e5; // same as fastjet::MaxRap
+
+  struct Node {
+    double px, py, pz, e;
+    double pt2, rap, phi;
+    int child1, child2; // merged subjets, -1 for constituents
+    int status, index;  // fastjet_user_info of constituents
+  };
+
+  static double m2(const Node& n) { return (n.e + n.pz) * (n.e - n.pz) - n.pt2; }
+
+  /// adds a node, computing rapidity and azimuth as fastjet::PseudoJet
+  int addNode(double px, double py, double pz, double e, int child1, int child2, int status, int index)
+  {
+    Node n{px, py, pz, e, px * px + py * py, 0., 0., child1, child2, status, index};
+    n.phi = n.pt2 == 0.0 ? 0.0 : std::atan2(py, px);
+    if (n.phi < 0.0) {
+      n.phi += 2 * M_PI;
+    }
+    if (n.phi >= 2 * M_PI) {
+      n.phi -= 2 * M_PI;
+    }
+    if (e == std::abs(pz) && n.pt2 == 0) {
+      const double maxRapHere = MaxRap + std::abs(pz);
+      n.rap = pz >= 0.0 ? maxRapHere : -maxRapHere;
+    } else {
+      const double effectiveM2 = std::max(0.0, m2(n));
+      const double ePlusPz = e + std::abs(pz);
+      n.rap = 0.5 * std::log((n.pt2 + effectiveM2) / (ePlusPz * ePlusPz));
+      if (pz > 0) {
+        n.rap = -n.rap;
+      }
+    }
+    mNodes.push_back(n);
+    return mNodes.size() - 1;
+  }
+
+  /// squared distance in rapidity-azimuth
+  double distance2(int nodeA, int nodeB) const
+  {
+    const Node& a = mNodes[nodeA];
+    const Node& b = mNodes[nodeB];
+    double dphi = std::abs(a.phi - b.phi);
+    if (dphi > M_PI) {
+      dphi = 2 * M_PI - dphi;
+    }
+    const double drap = a.rap - b.rap;
+    return dphi * dphi + drap * drap;
+  }
+
+  /// recomputes the nearest neighbour of the subjet at a position of the active list
+  void updateNN(int i)
+  {
+    mNN[i] = -1;
+    mNNDist[i] = std::numeric_limits<double>::max();
+    for (int j = 0; j < static_cast<int>(mActive.size()); j++) {
+      if (j == i) {
+        continue;
+      }
+      const double dist = distance2(mActive[i], mActive[j]);
+      if (dist < mNNDist[i]) {
+        mNNDist[i] = dist;
+        mNN[i] = mActive[j];
+      }
+    }
+  }
+
+  void declusterBranch(int node, int primary, std::vector<LundSplitting>& splittings) const
+  {
+    while (mNodes[node].child1 >= 0) {
+      int leading = mNodes[node].child1;
+      int subLeading = mNodes[node].child2;
+      if (mNodes[leading].pt2 < mNodes[subLeading].pt2) {
+        std::swap(leading, subLeading);
+      }
+      LundSplitting splitting;
+      splitting.ptLeading = pt(leading);
+      splitting.ptSubLeading = pt(subLeading);
+      splitting.z = splitting.ptSubLeading / (splitting.ptLeading + splitting.ptSubLeading);
+      splitting.theta = std::sqrt(distance2(leading, subLeading));
+      splitting.kt = splitting.ptSubLeading * splitting.theta;
+      splitting.energyMother = e(node);
+      splitting.massMother = m(node);
+      splitting.massLeading = m(leading);
+      splitting.massSubLeading = m(subLeading);
+      splitting.leading = leading;
+      splitting.subLeading = subLeading;
+      splitting.primary = primary;
+      splittings.push_back(splitting);
+      node = leading;
+    }
+  }
+
+  std::vector<Node> mNodes;    // constituents followed by the merged subjets
+  std::vector<int> mActive;    // subjets not merged yet
+  std::vector<int> mNN;        // nearest neighbour node of each active subjet
+  std::vector<double> mNNDist; // squared distance to the nearest neighbour
+  int mJet = -1;               // hardest reclustered jet
+  mutable std::vector<int> mStack;
+  mutable std::vector<std::pair<double, int32_t>> mLeaves;
+};
+
 /**
  * convert an O2Physics jet to a fastjet pseudojet object, returning its clusterSequence
  *
@@ -25,9 +25,12 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <limits>
+#include <numeric>
 #include <stdexcept>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include <math.h>
@@ -158,6 +161,267 @@ float deltaR(T const& eta1, U const& phi1, V const& eta2, W const& phi2)
 
   return std::sqrt(dEta * dEta + dPhi * dPhi);
 }
+/**
+ * Per-event (eta, phi) grid of particles (tracks, clusters, MC particles).
+ *
+ * The particles are binned once per event; cone queries around any axis then only visit the cells overlapping
+ * the cone instead of the full particle list. Phi is periodic and particles outside the eta range are kept in
+ * the edge cells, so no particle is lost. Each particle carries a payload, typically its table index.
+ *
+ * Usage: setup() once and reset() at the start of each process call, then per event clear(), add() the particles,
+ * build(), and query any number of axes. Memory is kept between events.
+ */
+class EtaPhiGrid
+{
+ public:
+  /// \param etaMin minimum eta of the grid
+  /// \param etaMax maximum eta of the grid
+  /// \param cellSize target size of the cells in eta and phi, typically of the order of the cone radius
+  void setup(float etaMin, float etaMax, float cellSize)
+  {
+    mEtaMin = etaMin;
+    mNEtaCells = std::max(1, static_cast<int>(std::ceil((etaMax - etaMin) / cellSize)));
+    mEtaCellSize = (etaMax - etaMin) / mNEtaCells;
+    mNPhiCells = std::max(1, static_cast<int>(2. * M_PI / cellSize));
+    mPhiCellSize = 2. * M_PI / mNPhiCells;
+    reset();
+  }
+
+  /// Removes all particles and forgets the last event, such that the next needsRebuild() returns true.
+  /// To be called when the tables change, as a new table can reuse the address of the previous one.
+  void reset()
+  {
+    clear();
+    mKey = {nullptr, -1, 0, -1};
+  }
+
+  /// Removes all particles, keeping the allocated memory
+  void clear()
+  {
+    mEta.clear();
+    mPhi.clear();
+    mPt.clear();
+    mPayload.clear();
+    mCell.clear();
+  }
+
+  /// Whether the grid has to be rebuilt for this event, identified by its table, slice index, number of entries and first entry index.
+  /// Records the event, such that following calls for the same event return false.
+  bool needsRebuild(const void* table, int64_t sliceId, std::size_t nEntries, int64_t firstEntry)
+  {
+    EventKey key{table, sliceId, nEntries, firstEntry};
+    if (key == mKey) {
+      return false;
+    }
+    mKey = key;
+    return true;
+  }
+
+  void add(float eta, float phi, float pt, int64_t payload)
+  {
+    mEta.push_back(eta);
+    mPhi.push_back(phi);
+    mPt.push_back(pt);
+    mPayload.push_back(payload);
+  }
+
+  /// Sorts the particles into the cells. Must be called after the last add() and before any query.
+  void build()
+  {
+    const auto nParticles = mEta.size();
+    mCell.resize(nParticles);
+    mCellStart.assign(mNEtaCells * mNPhiCells + 1, 0);
+    for (std::size_t i = 0; i < nParticles; i++) {
+      mCell[i] = etaCell(mEta[i]) * mNPhiCells + phiCell(mPhi[i]);
+      mCellStart[mCell[i] + 1]++;
+    }
+    std::partial_sum(mCellStart.begin(), mCellStart.end(), mCellStart.begin());
+    mCellEntries.resize(nParticles);
+    mFill.assign(mCellStart.begin(), mCellStart.end() - 1);
+    for (std::size_t i = 0; i < nParticles; i++) { // keeps the particles of each cell in insertion order
+      mCellEntries[mFill[mCell[i]]++] = i;
+    }
+  }
+
+  std::size_t size() const { return mEta.size(); }
+  float eta(int position) const { return mEta[position]; }
+  float phi(int position) const { return mPhi[position]; }
+  float pt(int position) const { return mPt[position]; }
+  int64_t payload(int position) const { return mPayload[position]; }
+
+  /// Fills the positions (in insertion order) of the particles of all cells overlapping a cone.
+  /// The result is a superset of the particles in the cone, to which the caller applies its exact cone selection.
+  void coneCandidates(float axisEta, float axisPhi, float coneR, std::vector<int>& candidates) const
+  {
+    candidates.clear();
+    const float reach = coneR + CellMargin;
+    const int etaCellFirst = etaCell(axisEta - reach);
+    const int etaCellLast = etaCell(axisEta + reach);
+    const double phiAxis = RecoDecay::constrainAngle<double, double>(axisPhi);
+    int phiCellFirst = static_cast<int>(std::floor((phiAxis - reach) / mPhiCellSize));
+    int phiCellLast = static_cast<int>(std::floor((phiAxis + reach) / mPhiCellSize));
+    if (phiCellLast - phiCellFirst + 1 >= mNPhiCells) {
+      phiCellFirst = 0;
+      phiCellLast = mNPhiCells - 1;
+    }
+    for (int iEta = etaCellFirst; iEta <= etaCellLast; iEta++) {
+      for (int iPhiUnwrapped = phiCellFirst; iPhiUnwrapped <= phiCellLast; iPhiUnwrapped++) {
+        const int iCell = iEta * mNPhiCells + ((iPhiUnwrapped % mNPhiCells) + mNPhiCells) % mNPhiCells;
+        candidates.insert(candidates.end(), mCellEntries.begin() + mCellStart[iCell], mCellEntries.begin() + mCellStart[iCell + 1]);
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+  }
+
+ private:
+  static constexpr float CellMargin = 1.e-4; ///< widening of the cone for the cell search, covering rounding at the cone edge
+
+  struct EventKey {
+    const void* table;
+    int64_t sliceId;
+    std::size_t nEntries;
+    int64_t firstEntry;
+    bool operator==(const EventKey& other) const { return table == other.table && sliceId == other.sliceId && nEntries == other.nEntries && firstEntry == other.firstEntry; }
+  };
+
+  int etaCell(float eta) const
+  {
+    return std::clamp(static_cast<int>(std::floor((eta - mEtaMin) / mEtaCellSize)), 0, mNEtaCells - 1);
+  }
+
+  int phiCell(float phi) const
+  {
+    return std::min(static_cast<int>(RecoDecay::constrainAngle<double, double>(phi) / mPhiCellSize), mNPhiCells - 1);
+  }
+
+  float mEtaMin = -1.;
+  float mEtaCellSize = 2.;
+  double mPhiCellSize = 2. * M_PI;
+  int mNEtaCells = 1;
+  int mNPhiCells = 1;
+  EventKey mKey{nullptr, -1, 0, -1};
+
+  std::vector<float> mEta;
+  std::vector<float> mPhi;
+  std::vector<float> mPt;
+  std::vector<int64_t> mPayload;
+  std::vector<int> mCell;        ///< cell of each particle
+  std::vector<int> mCellStart;   ///< first entry of each cell in mCellEntries, with a final end marker
+  std::vector<int> mCellEntries; ///< particle positions sorted by cell
+  std::vector<int> mFill;        ///< scratch fill pointers for build()
+};
+
+/**
+ * Reusable (eta, phi) index for the matching of clusters and tracks.
+ *
+ * Gives the same index maps as MatchClustersAndTracks: for each cluster (track), the indices of the
+ * maxNumberMatches closest tracks (clusters) with a distance below maxMatchingDistance, ordered by distance
+ * and padded with -1, where the distance is computed in the (eta, phi) plane without phi periodicity.
+ * Instead of building two KD-trees per call, the clusters and tracks are sorted into EtaPhiGrid cells of the
+ * size of the matching distance, and the memory of the grids and of the index maps is kept between calls.
+ *
+ * Usage: setup() once, then match() for each collision and cluster definition.
+ */
+template <typename T>
+class ClusterTrackMatcher
+{
+ public:
+  /// \param etaMin minimum eta of the grids, typically the detector acceptance (objects outside are kept in the edge cells)
+  /// \param etaMax maximum eta of the grids
+  /// \param maxMatchingDistance maximum matching distance
+  /// \param maxNumberMatches maximum number of matches (e.g. 5 closest)
+  void setup(float etaMin, float etaMax, double maxMatchingDistance, int maxNumberMatches)
+  {
+    mMaxMatchingDistance = maxMatchingDistance;
+    mMaxNumberMatches = maxNumberMatches;
+    const float cellSize = std::max(static_cast<float>(maxMatchingDistance), MinCellSize);
+    mClusterGrid.setup(etaMin, etaMax, cellSize);
+    mTrackGrid.setup(etaMin, etaMax, cellSize);
+  }
+
+  /// Matches the clusters to the tracks and the tracks to the clusters.
+  /// The index maps (cluster to track index map, track to cluster index map) are overwritten, reusing their memory.
+  void match(std::vector<T> const& clusterPhi,
+             std::vector<T> const& clusterEta,
+             std::vector<T> const& trackPhi,
+             std::vector<T> const& trackEta,
+             std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>>& indexMapPair)
+  {
+    auto& matchIndexTrack = std::get<0>(indexMapPair);
+    auto& matchIndexCluster = std::get<1>(indexMapPair);
+    const std::size_t nClusters = clusterEta.size();
+    const std::size_t nTracks = trackEta.size();
+    if (!(nClusters && nTracks)) {
+      resetMatches(matchIndexTrack, nClusters);
+      resetMatches(matchIndexCluster, nTracks);
+      return;
+    }
+    // Input sizes must match
+    if (clusterPhi.size() != clusterEta.size()) {
+      throw std::invalid_argument("cluster collection eta and phi sizes don't match. Check the inputs.");
+    }
+    if (trackPhi.size() != trackEta.size()) {
+      throw std::invalid_argument("track collection eta and phi sizes don't match. Check the inputs.");
+    }
+
+    fillGrid(mClusterGrid, clusterEta, clusterPhi);
+    fillGrid(mTrackGrid, trackEta, trackPhi);
+    findMatches(clusterEta, clusterPhi, mTrackGrid, trackEta, trackPhi, matchIndexTrack);
+    findMatches(trackEta, trackPhi, mClusterGrid, clusterEta, clusterPhi, matchIndexCluster);
+  }
+
+ private:
+  static constexpr float MinCellSize = 0.05; ///< lower limit of the cell size, bounding the number of cells for small matching distances
+
+  void resetMatches(std::vector<std::vector<int>>& matches, std::size_t n) const
+  {
+    matches.resize(n);
+    for (auto& match : matches) {
+      match.assign(mMaxNumberMatches, -1);
+    }
+  }
+
+  static void fillGrid(EtaPhiGrid& grid, std::vector<T> const& eta, std::vector<T> const& phi)
+  {
+    grid.clear();
+    for (std::size_t i = 0; i < eta.size(); i++) {
+      grid.add(eta[i], phi[i], 0.f, i);
+    }
+    grid.build();
+  }
+
+  /// For each query object, the indices of the closest objects of the grid, as TKDTree::FindNearestNeighbors
+  /// followed by the cut on the matching distance
+  void findMatches(std::vector<T> const& queryEta, std::vector<T> const& queryPhi, EtaPhiGrid const& grid,
+                   std::vector<T> const& eta, std::vector<T> const& phi, std::vector<std::vector<int>>& matches)
+  {
+    resetMatches(matches, queryEta.size());
+    for (std::size_t iQuery = 0; iQuery < queryEta.size(); iQuery++) {
+      grid.coneCandidates(queryEta[iQuery], queryPhi[iQuery], mMaxMatchingDistance, mPositions);
+      mNeighbours.clear();
+      for (const auto& position : mPositions) {
+        const T dEta = queryEta[iQuery] - eta[position];
+        const T dPhi = queryPhi[iQuery] - phi[position];
+        const T distance = std::sqrt(static_cast<double>(dEta * dEta) + static_cast<double>(dPhi * dPhi));
+        if (distance < mMaxMatchingDistance) {
+          mNeighbours.emplace_back(distance, position);
+        }
+      }
+      const auto nMatches = std::min(mNeighbours.size(), static_cast<std::size_t>(mMaxNumberMatches));
+      std::partial_sort(mNeighbours.begin(), mNeighbours.begin() + nMatches, mNeighbours.end());
+      for (std::size_t m = 0; m < nMatches; m++) {
+        matches[iQuery][m] = mNeighbours[m].second;
+      }
+    }
+  }
+
+  double mMaxMatchingDistance = 0.;
+  int mMaxNumberMatches = 1;
+  EtaPhiGrid mClusterGrid;
+  EtaPhiGrid mTrackGrid;
+  std::vector<int> mPositions;                ///< scratch candidate positions of a query
+  std::vector<std::pair<T, int>> mNeighbours; ///< scratch (distance, index) of the candidates within the matching distance
+};
 }; // namespace jetutilities
 
 #endif // PWGJE_CORE_JETUTILITIES_H_
@@ -126,8 +126,20 @@ struct EmcalCorrectionTask {
   o2::emcal::ClusterFactory<o2::emcal::Cell> mClusterFactories;
   o2::emcal::NonlinearityHandler mNonlinearityHandler;
   // Cells and clusters
+  // The cells of a BC are calibrated once into these buffers, which are then used by all cluster definitions
+  std::vector<o2::emcal::Cell> mCellsBC;
+  std::vector<int64_t> mCellIndicesBC;
+  std::vector<o2::emcal::CellLabel> mCellLabelsBC;
   std::vector<o2::emcal::AnalysisCluster> mAnalysisClusters;
   std::vector<o2::emcal::ClusterLabel> mClusterLabels;
+  // Tracks of a collision at the EMCal surface, selected once per collision and used by all cluster definitions
+  int64_t mTrackInfoCollisionId = -1;
+  std::vector<double> mTrackPhi;
+  std::vector<double> mTrackEta;
+  std::vector<int64_t> mTrackGlobalIndex;
+  // Cluster-track matching, with the (cluster to track, track to cluster) index maps of the last cluster definition
+  jetutilities::ClusterTrackMatcher<double> mClusterTrackMatcher;
+  std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> mIndexMapPair;
 
   std::vector<o2::aod::EMCALClusterDefinition> mClusterDefinitions;
   // QA
@@ -202,6 +214,8 @@ struct EmcalCorrectionTask {
     if (mClusterizers.size() == 0) {
       LOG(error) << "No cluster definitions specified!";
     }
+    // grids covering the EMCal and DCal eta acceptance, up to 20 closest matches
+    mClusterTrackMatcher.setup(-0.7, 0.7, maxMatchingDistance, 20);
 
     mNonlinearityHandler = o2::emcal::NonlinearityFactory::getInstance().getNonlinearity(static_cast<std::string>(nonlinearityFunction));
     LOG(info) << "Using nonlinearity parameterisation: " << nonlinearityFunction.value;
@@ -306,6 +320,7 @@ struct EmcalCorrectionTask {
     int nCellsProcessed = 0;
     std::unordered_map<uint64_t, int> numberCollsInBC; // Number of collisions mapped to the global BC index of all BCs
     std::unordered_map<uint64_t, int> numberCellsInBC; // Number of cells mapped to the global BC index of all BCs to check whether EMCal was readout
+    mTrackInfoCollisionId = -1;                        // collision indices restart with each DataFrame
     for (const auto& bc : bcs) {
       LOG(debug) << "Next BC";
 
@@ -329,8 +344,12 @@ struct EmcalCorrectionTask {
       }
       // Counters for BCs with matched collisions
       countBC(collisionsInFoundBC.size(), true);
-      std::vector<o2::emcal::Cell> cellsBC;
-      std::vector<int64_t> cellIndicesBC;
+      auto& cellsBC = mCellsBC;
+      auto& cellIndicesBC = mCellIndicesBC;
+      cellsBC.clear();
+      cellIndicesBC.clear();
+      cellsBC.reserve(cellsInBC.size());
+      cellIndicesBC.reserve(cellsInBC.size());
       for (const auto& cell : cellsInBC) {
         auto amplitude = cell.amplitude();
         if (static_cast<bool>(hasShaperCorrection) && emcal::intToChannelType(cell.cellType()) == emcal::ChannelType_t::LOW_GAIN) { // Apply shaper correction to LG cells
@@ -378,15 +397,11 @@ struct EmcalCorrectionTask {
               mHistManager.fill(HIST("hCollisionType"), 1);
               math_utils::Point3D<float> vertexPos = {col.posX(), col.posY(), col.posZ()};
 
-              std::vector<std::vector<int>> clusterToTrackIndexMap;
-              std::vector<std::vector<int>> trackToClusterIndexMap;
-              std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> indexMapPair{clusterToTrackIndexMap, trackToClusterIndexMap};
-              std::vector<int64_t> trackGlobalIndex;
-              doTrackMatching<CollEventSels::filtered_iterator>(col, tracks, indexMapPair, vertexPos, trackGlobalIndex);
+              doTrackMatching<CollEventSels::filtered_iterator>(col, tracks, mIndexMapPair, vertexPos);
 
               // Store the clusters in the table where a matching collision could
               // be identified.
-              fillClusterTable<CollEventSels::filtered_iterator>(col, vertexPos, iClusterizer, cellIndicesBC, &indexMapPair, &trackGlobalIndex);
+              fillClusterTable<CollEventSels::filtered_iterator>(col, vertexPos, iClusterizer, cellIndicesBC, &mIndexMapPair, &mTrackGlobalIndex);
             } else {
               mHistManager.fill(HIST("hBCMatchErrors"), 2);
             }
@@ -435,6 +450,7 @@ struct EmcalCorrectionTask {
     int nCellsProcessed = 0;
     std::unordered_map<uint64_t, int> numberCollsInBC; // Number of collisions mapped to the global BC index of all BCs
     std::unordered_map<uint64_t, int> numberCellsInBC; // Number of cells mapped to the global BC index of all BCs to check whether EMCal was readout
+    mTrackInfoCollisionId = -1;                        // collision indices restart with each DataFrame
     for (const auto& bc : bcs) {
       LOG(debug) << "Next BC";
       // Convert aod::Calo to o2::emcal::Cell which can be used with the clusterizer.
@@ -457,9 +473,15 @@ struct EmcalCorrectionTask {
       }
       // Counters for BCs with matched collisions
       countBC(collisionsInFoundBC.size(), true);
-      std::vector<o2::emcal::Cell> cellsBC;
-      std::vector<int64_t> cellIndicesBC;
-      std::vector<o2::emcal::CellLabel> cellLabels;
+      auto& cellsBC = mCellsBC;
+      auto& cellIndicesBC = mCellIndicesBC;
+      cellsBC.clear();
+      cellIndicesBC.clear();
+      cellsBC.reserve(cellsInBC.size());
+      cellIndicesBC.reserve(cellsInBC.size());
+      auto& cellLabels = mCellLabelsBC;
+      cellLabels.clear();
+      cellLabels.reserve(cellsInBC.size());
       for (const auto& cell : cellsInBC) {
         mHistManager.fill(HIST("hContributors"), cell.mcParticle_as<aod::StoredMcParticles_001>().size());
         auto cellParticles = cell.mcParticle_as<aod::StoredMcParticles_001>();
@@ -509,15 +531,11 @@ struct EmcalCorrectionTask {
               mHistManager.fill(HIST("hCollisionType"), 1);
               math_utils::Point3D<float> vertexPos = {col.posX(), col.posY(), col.posZ()};
 
-              std::vector<std::vector<int>> clusterToTrackIndexMap;
-              std::vector<std::vector<int>> trackToClusterIndexMap;
-              std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> indexMapPair{clusterToTrackIndexMap, trackToClusterIndexMap};
-              std::vector<int64_t> trackGlobalIndex;
-              doTrackMatching<CollEventSels::filtered_iterator>(col, tracks, indexMapPair, vertexPos, trackGlobalIndex);
+              doTrackMatching<CollEventSels::filtered_iterator>(col, tracks, mIndexMapPair, vertexPos);
 
               // Store the clusters in the table where a matching collision could
               // be identified.
-              fillClusterTable<CollEventSels::filtered_iterator>(col, vertexPos, iClusterizer, cellIndicesBC, &indexMapPair, &trackGlobalIndex);
+              fillClusterTable<CollEventSels::filtered_iterator>(col, vertexPos, iClusterizer, cellIndicesBC, &mIndexMapPair, &mTrackGlobalIndex);
             } else {
               mHistManager.fill(HIST("hBCMatchErrors"), 2);
             }
@@ -583,8 +601,12 @@ struct EmcalCorrectionTask {
       }
       // Counters for BCs with matched collisions
       countBC(collisionsInBC.size(), true);
-      std::vector<o2::emcal::Cell> cellsBC;
-      std::vector<int64_t> cellIndicesBC;
+      auto& cellsBC = mCellsBC;
+      auto& cellIndicesBC = mCellIndicesBC;
+      cellsBC.clear();
+      cellIndicesBC.clear();
+      cellsBC.reserve(cellsInBC.size());
+      cellIndicesBC.reserve(cellsInBC.size());
       for (const auto& cell : cellsInBC) {
         cellsBC.emplace_back(cell.cellNumber(),
                              cell.amplitude(),
@@ -819,17 +841,23 @@ struct EmcalCorrectionTask {
   }
 
   template <typename Collision>
-  void doTrackMatching(Collision const& col, MyGlobTracks const& tracks, std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>>& indexMapPair, math_utils::Point3D<float>& vertexPos, std::vector<int64_t>& trackGlobalIndex)
+  void doTrackMatching(Collision const& col, MyGlobTracks const& tracks, std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>>& indexMapPair, math_utils::Point3D<float>& vertexPos)
   {
-    auto groupedTracks = tracks.sliceBy(perCollision, col.globalIndex());
-    int nTracksInCol = groupedTracks.size();
-    std::vector<double> trackPhi;
-    std::vector<double> trackEta;
-    // reserve memory to reduce on the fly memory allocation
-    trackPhi.reserve(nTracksInCol);
-    trackEta.reserve(nTracksInCol);
-    trackGlobalIndex.reserve(nTracksInCol);
-    fillTrackInfo<decltype(groupedTracks)>(groupedTracks, trackPhi, trackEta, trackGlobalIndex);
+    // The track selection and extrapolation do not depend on the cluster definition,
+    // so they are done only for the first cluster definition of a collision
+    if (col.globalIndex() != mTrackInfoCollisionId) {
+      auto groupedTracks = tracks.sliceBy(perCollision, col.globalIndex());
+      int nTracksInCol = groupedTracks.size();
+      mTrackPhi.clear();
+      mTrackEta.clear();
+      mTrackGlobalIndex.clear();
+      // reserve memory to reduce on the fly memory allocation
+      mTrackPhi.reserve(nTracksInCol);
+      mTrackEta.reserve(nTracksInCol);
+      mTrackGlobalIndex.reserve(nTracksInCol);
+      fillTrackInfo<decltype(groupedTracks)>(groupedTracks, mTrackPhi, mTrackEta, mTrackGlobalIndex);
+      mTrackInfoCollisionId = col.globalIndex();
+    }
 
     int nClusterInCol = mAnalysisClusters.size();
     std::vector<double> clusterPhi;
@@ -849,10 +877,7 @@ struct EmcalCorrectionTask {
       clusterPhi.emplace_back(TVector2::Phi_0_2pi(pos.Phi()));
       clusterEta.emplace_back(pos.Eta());
     }
-    indexMapPair =
-      jetutilities::MatchClustersAndTracks(clusterPhi, clusterEta,
-                                           trackPhi, trackEta,
-                                           maxMatchingDistance, 20);
+    mClusterTrackMatcher.match(clusterPhi, clusterEta, mTrackPhi, mTrackEta, indexMapPair);
   }
 
   template <typename Tracks>
@@ -14,12 +14,12 @@
 // \since September 2023
 
 //
-// Task performing jet reclustering and producing primary Lund Plane histograms
+// Task performing jet reclustering and producing primary (and optionally secondary) Lund Plane histograms
 //
 
 #include "PWGJE/Core/FastJetUtilities.h"
 #include "PWGJE/Core/JetDerivedDataUtilities.h"
-#include "PWGJE/Core/JetFinder.h"
+#include "PWGJE/Core/JetSubstructureUtilities.h"
 #include "PWGJE/DataModel/Jet.h"
 #include "PWGJE/DataModel/JetReducedData.h"
 
@@ -31,9 +31,7 @@
 #include <Framework/InitContext.h>
 #include <Framework/runDataProcessing.h>
 
-#include "fastjet/ClusterSequenceArea.hh"
 #include "fastjet/PseudoJet.hh"
-#include <fastjet/JetDefinition.hh>
 
 #include <cmath>
 #include <string>
@@ -53,8 +51,8 @@ struct JetLundReclustering {
   HistogramRegistry registry;
 
   std::vector<fastjet::PseudoJet> jetConstituents;
-  std::vector<fastjet::PseudoJet> jetReclustered;
-  JetFinder jetReclusterer;
+  jetsubstructureutilities::CADeclusterer declusterer;
+  std::vector<jetsubstructureutilities::LundSplitting> splittings;
 
   Configurable<std::string> eventSelections{"eventSelections", "sel8", "choose event selection"};
   Configurable<float> jetPtMin{"jetPtMin", 5.0, "minimum jet pT cut"};
@@ -62,6 +60,7 @@ struct JetLundReclustering {
   Configurable<float> jet_min_eta{"jet_min_eta", -0.5, "minimum jet eta"};
   Configurable<float> jet_max_eta{"jet_max_eta", 0.5, "maximum jet eta"};
   Configurable<float> vertexZCut{"vertexZCut", 10.0f, "Accepted z-vertex range"};
+  Configurable<bool> doSecondaryLundPlane{"doSecondaryLundPlane", false, "also fill the secondary Lund plane from the declustering of the softer branches"};
 
   std::vector<int> eventSelectionBits;
 
@@ -71,10 +70,11 @@ struct JetLundReclustering {
 
     registry.add("PrimaryLundPlane_kT", "Primary Lund 3D plane;ln(R/Delta);ln(k_{t}/GeV);{p}_{t}", {HistType::kTH3F, {{100, 0, 10}, {100, -10, 10}, {20, 0, 200}}});
     registry.add("PrimaryLundPlane_z", "Primary Lund 3D plane;ln(R/Delta);ln(1/z);{p}_{t}", {HistType::kTH3F, {{100, 0, 10}, {100, 0, 10}, {20, 0, 200}}});
+    if (doSecondaryLundPlane) {
+      registry.add("SecondaryLundPlane_kT", "Secondary Lund 3D plane;ln(R/Delta);ln(k_{t}/GeV);{p}_{t}", {HistType::kTH3F, {{100, 0, 10}, {100, -10, 10}, {20, 0, 200}}});
+      registry.add("SecondaryLundPlane_z", "Secondary Lund 3D plane;ln(R/Delta);ln(1/z);{p}_{t}", {HistType::kTH3F, {{100, 0, 10}, {100, 0, 10}, {20, 0, 200}}});
+    }
     registry.add("jet_PtEtaPhi", "Correlation of jet #it{p}_{T}, #eta and #phi;#it{p}_{T,jet} (GeV/#it{c});#eta_{jet};#phi_{jet} [rad]", {HistType::kTH3F, {{100, 0, 200}, {180, -0.9, 0.9}, {180, 0., 2 * M_PI}}});
-
-    jetReclusterer.isReclustering = true;
-    jetReclusterer.algorithm = fastjet::JetAlgorithm::cambridge_algorithm;
   }
 
   Filter jetFilter = aod::jet::pt > jetPtMin&& aod::jet::r == nround(jetR.node() * 100.0f) && aod::jet::eta > jet_min_eta&& aod::jet::eta < jet_max_eta;
@@ -84,26 +84,23 @@ struct JetLundReclustering {
   template <typename T>
   void jetReclustering(T const& jet)
   {
-    jetReclustered.clear();
-    fastjet::ClusterSequenceArea clusterSeq(jetReclusterer.findJets(jetConstituents, jetReclustered));
-    jetReclustered = sorted_by_pt(jetReclustered);
-    fastjet::PseudoJet pair = jetReclustered[0];
-    fastjet::PseudoJet j1;
-    fastjet::PseudoJet j2;
-    while (pair.has_parents(j1, j2)) {
-      if (j1.pt() < j2.pt()) {
-        std::swap(j1, j2);
-      }
-      double deltaR = j1.delta_R(j2);
-      double kt = j2.pt() * deltaR;
-      double z = j2.pt() / (j1.pt() + j2.pt());
+    declusterer.recluster(jetConstituents);
+    declusterer.decluster(splittings, doSecondaryLundPlane);
+    for (const auto& splitting : splittings) {
+      double deltaR = splitting.theta;
+      double kt = splitting.kt;
+      double z = splitting.z;
       double jetRadius = static_cast<double>(jet.r()) / 100.0;
       double coord1 = std::log(jetRadius / deltaR);
       double coord2 = std::log(kt);
       double coord3 = std::log(1 / z);
-      registry.fill(HIST("PrimaryLundPlane_kT"), coord1, coord2, jet.pt());
-      registry.fill(HIST("PrimaryLundPlane_z"), coord1, coord3, jet.pt());
-      pair = j1;
+      if (splitting.primary < 0) {
+        registry.fill(HIST("PrimaryLundPlane_kT"), coord1, coord2, jet.pt());
+        registry.fill(HIST("PrimaryLundPlane_z"), coord1, coord3, jet.pt());
+      } else {
+        registry.fill(HIST("SecondaryLundPlane_kT"), coord1, coord2, jet.pt());
+        registry.fill(HIST("SecondaryLundPlane_z"), coord1, coord3, jet.pt());
+      }
     }
   }
 
@@ -19,7 +19,6 @@
 #include "RecoDecay.h"
 
 #include "PWGJE/Core/FastJetUtilities.h"
-#include "PWGJE/Core/JetFinder.h"
 #include "PWGJE/Core/JetSubstructureUtilities.h"
 #include "PWGJE/Core/JetUtilities.h"
 #include "PWGJE/DataModel/Jet.h"
@@ -38,9 +37,7 @@
 
 #include <TMath.h>
 
-#include "fastjet/ClusterSequenceArea.hh"
 #include "fastjet/PseudoJet.hh"
-#include <fastjet/JetDefinition.hh>
 
 #include <cmath>
 #include <cstdint>
@@ -74,11 +71,13 @@ struct JetSubstructureTask {
   Configurable<float> alpha{"alpha", 1.0, "angularity alpha"};
   Configurable<bool> doPairBkg{"doPairBkg", true, "save bkg pairs"};
   Configurable<float> pairConstituentPtMin{"pairConstituentPtMin", 1.0, "pt cut off for constituents going into pairs"};
+  Configurable<float> perpConeGridCellSize{"perpConeGridCellSize", 0.2, "size in eta and phi of the cells of the track grid used for the perpendicular cones"};
 
   Service<o2::framework::O2DatabasePDG> pdg;
   std::vector<fastjet::PseudoJet> jetConstituents;
-  std::vector<fastjet::PseudoJet> jetReclustered;
-  JetFinder jetReclusterer;
+  jetsubstructureutilities::CADeclusterer declusterer;
+  std::vector<jetsubstructureutilities::LundSplitting> splittings;
+  std::vector<int32_t> splittingTracks;
 
   std::vector<float> energyMotherVec;
   std::vector<float> ptLeadingVec;
@@ -100,6 +99,8 @@ struct JetSubstructureTask {
   float angularity;
   float leadingConstituentPt;
   float perpConeRho;
+  jetutilities::EtaPhiGrid perpConeGrid;
+  std::vector<int> perpConeCandidates;
 
   HistogramRegistry registry;
 
@@ -117,8 +118,7 @@ struct JetSubstructureTask {
     registry.add("h2_jet_pt_jet_rg_eventwiseconstituentsubtracted", ";#it{p}_{T,jet} (GeV/#it{c});#it{R}_{g}", {HistType::kTH2F, {{200, 0., 200.}, {22, 0.0, 1.1}}});
     registry.add("h2_jet_pt_jet_nsd_eventwiseconstituentsubtracted", ";#it{p}_{T,jet} (GeV/#it{c});#it{n}_{SD}", {HistType::kTH2F, {{200, 0., 200.}, {15, -0.5, 14.5}}});
 
-    jetReclusterer.isReclustering = true;
-    jetReclusterer.algorithm = fastjet::JetAlgorithm::cambridge_algorithm;
+    perpConeGrid.setup(-0.9, 0.9, perpConeGridCellSize);
   }
 
   Preslice<aod::JetTracks> TracksPerCollision = aod::jtrack::collisionId;
@@ -132,35 +132,23 @@ struct JetSubstructureTask {
     ptLeadingVec.clear();
     ptSubLeadingVec.clear();
     thetaVec.clear();
-    jetReclustered.clear();
-    fastjet::ClusterSequenceArea clusterSeq(jetReclusterer.findJets(jetConstituents, jetReclustered));
-    jetReclustered = sorted_by_pt(jetReclustered);
-    fastjet::PseudoJet daughterSubJet = jetReclustered[0];
-    fastjet::PseudoJet parentSubJet1;
-    fastjet::PseudoJet parentSubJet2;
+    declusterer.recluster(jetConstituents);
+    declusterer.decluster(splittings);
     bool softDropped = false;
     auto nsd = 0.0;
     auto zg = -1.0;
     auto rg = -1.0;
 
-    while (daughterSubJet.has_parents(parentSubJet1, parentSubJet2)) {
-      if (parentSubJet1.perp() < parentSubJet2.perp()) {
-        std::swap(parentSubJet1, parentSubJet2);
-      }
-      std::vector<int32_t> tracks;
+    for (const auto& splitting : splittings) {
       std::vector<int32_t> candidates;
       std::vector<int32_t> clusters;
-      for (const auto& constituent : sorted_by_pt(parentSubJet2.constituents())) {
-        if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == static_cast<int>(JetConstituentStatus::track)) {
-          tracks.push_back(constituent.template user_info<fastjetutilities::fastjet_user_info>().getIndex());
-        }
-      }
-      splittingTable(jet.globalIndex(), tracks, clusters, candidates, parentSubJet2.perp(), parentSubJet2.eta(), parentSubJet2.phi(), 0);
-      auto z = parentSubJet2.perp() / (parentSubJet1.perp() + parentSubJet2.perp());
-      auto theta = parentSubJet1.delta_R(parentSubJet2);
-      energyMotherVec.push_back(daughterSubJet.e());
-      ptLeadingVec.push_back(parentSubJet1.pt());
-      ptSubLeadingVec.push_back(parentSubJet2.pt());
+      declusterer.constituentIndices(splitting.subLeading, static_cast<int>(JetConstituentStatus::track), splittingTracks);
+      splittingTable(jet.globalIndex(), splittingTracks, clusters, candidates, splitting.ptSubLeading, declusterer.eta(splitting.subLeading), declusterer.phi(splitting.subLeading), 0);
+      auto z = splitting.z;
+      auto theta = splitting.theta;
+      energyMotherVec.push_back(splitting.energyMother);
+      ptLeadingVec.push_back(splitting.ptLeading);
+      ptSubLeadingVec.push_back(splitting.ptSubLeading);
       thetaVec.push_back(theta);
 
       if (z >= zCut * TMath::Power(theta / (jet.r() / 100.f), beta)) {
@@ -183,7 +171,6 @@ struct JetSubstructureTask {
         }
         nsd++;
       }
-      daughterSubJet = parentSubJet1;
     }
     if constexpr (!isSubtracted && !isMCP) {
       registry.fill(HIST("h2_jet_pt_jet_nsd"), jet.pt(), nsd);
@@ -245,19 +232,33 @@ struct JetSubstructureTask {
     float perpCone2Pt = 0.0;
     std::vector<typename U::iterator> tracksPerpCone1Vec;
     std::vector<typename U::iterator> tracksPerpCone2Vec;
-    for (auto const& track : tracksPerCollision) {
+    // the tracks of the event are binned once in eta and phi and shared by all its jets; only the cells overlapping the cones are tested
+    if (perpConeGrid.needsRebuild(tracks.asArrowTable().get(), collisionId, tracksPerCollision.size(), tracksPerCollision.size() > 0 ? tracksPerCollision.begin().globalIndex() : -1)) {
+      perpConeGrid.clear();
+      for (auto const& track : tracksPerCollision) {
+        perpConeGrid.add(track.eta(), track.phi(), track.pt(), track.globalIndex());
+      }
+      perpConeGrid.build();
+    }
+    perpConeGrid.coneCandidates(jet.eta(), perpCone1Phi, jet.r() / 100.0, perpConeCandidates);
+    for (auto const& position : perpConeCandidates) {
+      auto track = tracks.iteratorAt(perpConeGrid.payload(position));
       float deltaPhi1 = track.phi() - perpCone1Phi;
       deltaPhi1 = RecoDecay::constrainAngle<float, float>(deltaPhi1, -M_PI);
-      float deltaPhi2 = track.phi() - perpCone2Phi;
-      deltaPhi2 = RecoDecay::constrainAngle<float, float>(deltaPhi2, -M_PI);
       float deltaEta = jet.eta() - track.eta();
-
       if (TMath::Sqrt((deltaPhi1 * deltaPhi1) + (deltaEta * deltaEta)) <= jet.r() / 100.0) {
         if (track.pt() >= pairConstituentPtMin) {
           tracksPerpCone1Vec.push_back(track);
         }
         perpCone1Pt += track.pt();
       }
+    }
+    perpConeGrid.coneCandidates(jet.eta(), perpCone2Phi, jet.r() / 100.0, perpConeCandidates);
+    for (auto const& position : perpConeCandidates) {
+      auto track = tracks.iteratorAt(perpConeGrid.payload(position));
+      float deltaPhi2 = track.phi() - perpCone2Phi;
+      deltaPhi2 = RecoDecay::constrainAngle<float, float>(deltaPhi2, -M_PI);
+      float deltaEta = jet.eta() - track.eta();
       if (TMath::Sqrt((deltaPhi2 * deltaPhi2) + (deltaEta * deltaEta)) <= jet.r() / 100.0) {
         if (track.pt() >= pairConstituentPtMin) {
           tracksPerpCone2Vec.push_back(track);
@@ -336,39 +337,51 @@ struct JetSubstructureTask {
   }
   PROCESS_SWITCH(JetSubstructureTask, processDummy, "Dummy process function turned on by default", true);
 
-  void processChargedJetsData(soa::Join<aod::ChargedJets, aod::ChargedJetConstituents>::iterator const& jet,
+  void processChargedJetsData(soa::Join<aod::ChargedJets, aod::ChargedJetConstituents> const& jets,
                               aod::JetTracks const& tracks)
   {
-    analyseCharged<false>(jet, tracks, TracksPerCollision, jetSubstructureDataTable, jetSplittingsDataTable, jetPairsDataTable);
+    perpConeGrid.reset();
+    for (auto const& jet : jets) {
+      analyseCharged<false>(jet, tracks, TracksPerCollision, jetSubstructureDataTable, jetSplittingsDataTable, jetPairsDataTable);
+    }
   }
   PROCESS_SWITCH(JetSubstructureTask, processChargedJetsData, "charged jet substructure", false);
 
-  void processChargedJetsEventWiseSubData(soa::Join<aod::ChargedEventWiseSubtractedJets, aod::ChargedEventWiseSubtractedJetConstituents>::iterator const& jet,
+  void processChargedJetsEventWiseSubData(soa::Join<aod::ChargedEventWiseSubtractedJets, aod::ChargedEventWiseSubtractedJetConstituents> const& jets,
                                           aod::JetTracksSub const& tracks)
   {
-    analyseCharged<true>(jet, tracks, TracksPerCollisionDataSub, jetSubstructureDataSubTable, jetSplittingsDataSubTable, jetPairsDataSubTable);
+    perpConeGrid.reset();
+    for (auto const& jet : jets) {
+      analyseCharged<true>(jet, tracks, TracksPerCollisionDataSub, jetSubstructureDataSubTable, jetSplittingsDataSubTable, jetPairsDataSubTable);
+    }
   }
   PROCESS_SWITCH(JetSubstructureTask, processChargedJetsEventWiseSubData, "eventwise-constituent subtracted charged jet substructure", false);
 
-  void processChargedJetsMCD(typename soa::Join<aod::ChargedMCDetectorLevelJets, aod::ChargedMCDetectorLevelJetConstituents>::iterator const& jet,
+  void processChargedJetsMCD(soa::Join<aod::ChargedMCDetectorLevelJets, aod::ChargedMCDetectorLevelJetConstituents> const& jets,
                              aod::JetTracks const& tracks)
   {
-    analyseCharged<false>(jet, tracks, TracksPerCollision, jetSubstructureMCDTable, jetSplittingsMCDTable, jetPairsMCDTable);
+    perpConeGrid.reset();
+    for (auto const& jet : jets) {
+      analyseCharged<false>(jet, tracks, TracksPerCollision, jetSubstructureMCDTable, jetSplittingsMCDTable, jetPairsMCDTable);
+    }
   }
   PROCESS_SWITCH(JetSubstructureTask, processChargedJetsMCD, "charged jet substructure", false);
 
-  void processChargedJetsMCP(typename soa::Join<aod::ChargedMCParticleLevelJets, aod::ChargedMCParticleLevelJetConstituents>::iterator const& jet,
+  void processChargedJetsMCP(soa::Join<aod::ChargedMCParticleLevelJets, aod::ChargedMCParticleLevelJetConstituents> const& jets,
                              aod::JetParticles const& particles)
   {
-    jetConstituents.clear();
-    for (auto& jetConstituent : jet.template tracks_as<aod::JetParticles>()) {
-      fastjetutilities::fillTracks(jetConstituent, jetConstituents, jetConstituent.globalIndex(), static_cast<int>(JetConstituentStatus::track), pdg->Mass(jetConstituent.pdgCode()));
+    perpConeGrid.reset();
+    for (auto const& jet : jets) {
+      jetConstituents.clear();
+      for (auto& jetConstituent : jet.template tracks_as<aod::JetParticles>()) {
+        fastjetutilities::fillTracks(jetConstituent, jetConstituents, jetConstituent.globalIndex(), static_cast<int>(JetConstituentStatus::track), pdg->Mass(jetConstituent.pdgCode()));
+      }
+      nSub = jetsubstructureutilities::getNSubjettiness(jet, particles, particles, particles, 2, fastjet::contrib::CA_Axes(), true, zCut, beta);
+      jetReclustering<true, false>(jet, jetSplittingsMCPTable);
+      jetPairing<true>(jet, particles, ParticlesPerMcCollision, jetPairsMCPTable);
+      jetSubstructureSimple(jet, particles);
+      jetSubstructureMCPTable(energyMotherVec, ptLeadingVec, ptSubLeadingVec, thetaVec, nSub[0], nSub[1], nSub[2], pairJetPtVec, pairJetEnergyVec, pairJetThetaVec, pairJetPerpCone1PtVec, pairJetPerpCone1EnergyVec, pairJetPerpCone1ThetaVec, pairPerpCone1PerpCone1PtVec, pairPerpCone1PerpCone1EnergyVec, pairPerpCone1PerpCone1ThetaVec, pairPerpCone1PerpCone2PtVec, pairPerpCone1PerpCone2EnergyVec, pairPerpCone1PerpCone2ThetaVec, angularity, leadingConstituentPt, perpConeRho);
     }
-    nSub = jetsubstructureutilities::getNSubjettiness(jet, particles, particles, particles, 2, fastjet::contrib::CA_Axes(), true, zCut, beta);
-    jetReclustering<true, false>(jet, jetSplittingsMCPTable);
-    jetPairing<true>(jet, particles, ParticlesPerMcCollision, jetPairsMCPTable);
-    jetSubstructureSimple(jet, particles);
-    jetSubstructureMCPTable(energyMotherVec, ptLeadingVec, ptSubLeadingVec, thetaVec, nSub[0], nSub[1], nSub[2], pairJetPtVec, pairJetEnergyVec, pairJetThetaVec, pairJetPerpCone1PtVec, pairJetPerpCone1EnergyVec, pairJetPerpCone1ThetaVec, pairPerpCone1PerpCone1PtVec, pairPerpCone1PerpCone1EnergyVec, pairPerpCone1PerpCone1ThetaVec, pairPerpCone1PerpCone2PtVec, pairPerpCone1PerpCone2EnergyVec, pairPerpCone1PerpCone2ThetaVec, angularity, leadingConstituentPt, perpConeRho);
   }
   PROCESS_SWITCH(JetSubstructureTask, processChargedJetsMCP, "charged jet substructure on MC particle level", false);
 };
@@ -77,6 +77,7 @@ struct JetSubstructureHFTask {
   Configurable<float> alpha{"alpha", 1.0, "angularity alpha"};
   Configurable<bool> doPairBkg{"doPairBkg", true, "save bkg pairs"};
   Configurable<float> pairConstituentPtMin{"pairConstituentPtMin", 1.0, "pt cut off for constituents going into pairs"};
+  Configurable<float> perpConeGridCellSize{"perpConeGridCellSize", 0.2, "size in eta and phi of the cells of the track grid used for the perpendicular cones"};
 
   Service<o2::framework::O2DatabasePDG> pdg;
   float candMass;
@@ -105,6 +106,8 @@ struct JetSubstructureHFTask {
   float angularity;
   float leadingConstituentPt;
   float perpConeRho;
+  jetutilities::EtaPhiGrid perpConeGrid;
+  std::vector<int> perpConeCandidates;
 
   HistogramRegistry registry;
   void init(InitContext const&)
@@ -121,6 +124,8 @@ struct JetSubstructureHFTask {
     registry.add("h2_jet_pt_jet_rg_eventwiseconstituentsubtracted", ";#it{p}_{T,jet} (GeV/#it{c});#it{R}_{g}", {HistType::kTH2F, {{200, 0., 200.}, {22, 0.0, 1.1}}});
     registry.add("h2_jet_pt_jet_nsd_eventwiseconstituentsubtracted", ";#it{p}_{T,jet} (GeV/#it{c});#it{n}_{SD}", {HistType::kTH2F, {{200, 0., 200.}, {15, -0.5, 14.5}}});
 
+    perpConeGrid.setup(-0.9, 0.9, perpConeGridCellSize);
+
     jetReclusterer.isReclustering = true;
     jetReclusterer.algorithm = fastjet::JetAlgorithm::cambridge_algorithm;
 
@@ -315,19 +320,33 @@ struct JetSubstructureHFTask {
     float perpCone2Pt = 0.0;
     std::vector<typename U::iterator> tracksPerpCone1Vec;
     std::vector<typename U::iterator> tracksPerpCone2Vec;
-    for (auto const& track : tracksPerCollision) {
+    // the tracks of the event are binned once in eta and phi and shared by all its jets; only the cells overlapping the cones are tested
+    if (perpConeGrid.needsRebuild(tracks.asArrowTable().get(), slicerId, tracksPerCollision.size(), tracksPerCollision.size() > 0 ? tracksPerCollision.begin().globalIndex() : -1)) {
+      perpConeGrid.clear();
+      for (auto const& track : tracksPerCollision) {
+        perpConeGrid.add(track.eta(), track.phi(), track.pt(), track.globalIndex());
+      }
+      perpConeGrid.build();
+    }
+    perpConeGrid.coneCandidates(jet.eta(), perpCone1Phi, jet.r() / 100.0, perpConeCandidates);
+    for (auto const& position : perpConeCandidates) {
+      auto track = tracks.iteratorAt(perpConeGrid.payload(position));
       float deltaPhi1 = track.phi() - perpCone1Phi;
       deltaPhi1 = RecoDecay::constrainAngle<float, float>(deltaPhi1, -M_PI);
-      float deltaPhi2 = track.phi() - perpCone2Phi;
-      deltaPhi2 = RecoDecay::constrainAngle<float, float>(deltaPhi2, -M_PI);
       float deltaEta = jet.eta() - track.eta();
-
       if (TMath::Sqrt((deltaPhi1 * deltaPhi1) + (deltaEta * deltaEta)) <= jet.r() / 100.0) {
         if (track.pt() >= pairConstituentPtMin) {
           tracksPerpCone1Vec.push_back(track);
         }
         perpCone1Pt += track.pt();
       }
+    }
+    perpConeGrid.coneCandidates(jet.eta(), perpCone2Phi, jet.r() / 100.0, perpConeCandidates);
+    for (auto const& position : perpConeCandidates) {
+      auto track = tracks.iteratorAt(perpConeGrid.payload(position));
+      float deltaPhi2 = track.phi() - perpCone2Phi;
+      deltaPhi2 = RecoDecay::constrainAngle<float, float>(deltaPhi2, -M_PI);
+      float deltaEta = jet.eta() - track.eta();
       if (TMath::Sqrt((deltaPhi2 * deltaPhi2) + (deltaEta * deltaEta)) <= jet.r() / 100.0) {
         if (track.pt() >= pairConstituentPtMin) {
           tracksPerpCone2Vec.push_back(track);
@@ -423,46 +442,58 @@ struct JetSubstructureHFTask {
     outputTable(energyMotherVec, ptLeadingVec, ptSubLeadingVec, thetaVec, nSub[0], nSub[1], nSub[2], pairJetPtVec, pairJetEnergyVec, pairJetThetaVec, pairJetPerpCone1PtVec, pairJetPerpCone1EnergyVec, pairJetPerpCone1ThetaVec, pairPerpCone1PerpCone1PtVec, pairPerpCone1PerpCone1EnergyVec, pairPerpCone1PerpCone1ThetaVec, pairPerpCone1PerpCone2PtVec, pairPerpCone1PerpCone2EnergyVec, pairPerpCone1PerpCone2ThetaVec, angularity, leadingConstituentPt, perpConeRho);
   }
 
-  void processChargedJetsData(typename JetTableData::iterator const& jet,
+  void processChargedJetsData(JetTableData const& jets,
                               CandidateTable const& candidates,
                               aod::JetTracks const& tracks)
   {
-    analyseCharged<false>(jet, tracks, candidates, TracksPerCollision, jetSubstructureDataTable, jetSplittingsDataTable, jetPairsDataTable);
+    perpConeGrid.reset();
+    for (auto const& jet : jets) {
+      analyseCharged<false>(jet, tracks, candidates, TracksPerCollision, jetSubstructureDataTable, jetSplittingsDataTable, jetPairsDataTable);
+    }
   }
   PROCESS_SWITCH(JetSubstructureHFTask, processChargedJetsData, "HF jet substructure on data", false);
 
-  void processChargedJetsDataSub(typename JetTableDataSub::iterator const& jet,
+  void processChargedJetsDataSub(JetTableDataSub const& jets,
                                  CandidateTable const& candidates,
                                  TracksSub const& tracks)
   {
-    analyseCharged<true>(jet, tracks, candidates, selectSlicer(TracksPerD0DataSub, TracksPerDplusDataSub, TracksPerLcDataSub, TracksPerBplusDataSub, TracksPerDielectronDataSub), jetSubstructureDataSubTable, jetSplittingsDataSubTable, jetPairsDataSubTable);
+    perpConeGrid.reset();
+    for (auto const& jet : jets) {
+      analyseCharged<true>(jet, tracks, candidates, selectSlicer(TracksPerD0DataSub, TracksPerDplusDataSub, TracksPerLcDataSub, TracksPerBplusDataSub, TracksPerDielectronDataSub), jetSubstructureDataSubTable, jetSplittingsDataSubTable, jetPairsDataSubTable);
+    }
   }
   PROCESS_SWITCH(JetSubstructureHFTask, processChargedJetsDataSub, "HF jet substructure on data", false);
 
-  void processChargedJetsMCD(typename JetTableMCD::iterator const& jet,
+  void processChargedJetsMCD(JetTableMCD const& jets,
                              CandidateTable const& candidates,
                              aod::JetTracks const& tracks)
   {
-    analyseCharged<false>(jet, tracks, candidates, TracksPerCollision, jetSubstructureMCDTable, jetSplittingsMCDTable, jetPairsMCDTable);
+    perpConeGrid.reset();
+    for (auto const& jet : jets) {
+      analyseCharged<false>(jet, tracks, candidates, TracksPerCollision, jetSubstructureMCDTable, jetSplittingsMCDTable, jetPairsMCDTable);
+    }
   }
   PROCESS_SWITCH(JetSubstructureHFTask, processChargedJetsMCD, "HF jet substructure on data", false);
 
-  void processChargedJetsMCP(typename JetTableMCP::iterator const& jet,
+  void processChargedJetsMCP(JetTableMCP const& jets,
                              aod::JetParticles const& particles,
                              CandidateTableMCP const& candidates)
   {
-    jetConstituents.clear();
-    for (auto& jetConstituent : jet.template tracks_as<aod::JetParticles>()) {
-      fastjetutilities::fillTracks(jetConstituent, jetConstituents, jetConstituent.globalIndex(), static_cast<int>(JetConstituentStatus::track), pdg->Mass(jetConstituent.pdgCode()));
-    }
-    for (auto& jetHFCandidate : jet.template candidates_as<CandidateTableMCP>()) {
-      fastjetutilities::fillTracks(jetHFCandidate, jetConstituents, jetHFCandidate.globalIndex(), static_cast<int>(JetConstituentStatus::candidate), candMass);
+    perpConeGrid.reset();
+    for (auto const& jet : jets) {
+      jetConstituents.clear();
+      for (auto& jetConstituent : jet.template tracks_as<aod::JetParticles>()) {
+        fastjetutilities::fillTracks(jetConstituent, jetConstituents, jetConstituent.globalIndex(), static_cast<int>(JetConstituentStatus::track), pdg->Mass(jetConstituent.pdgCode()));
+      }
+      for (auto& jetHFCandidate : jet.template candidates_as<CandidateTableMCP>()) {
+        fastjetutilities::fillTracks(jetHFCandidate, jetConstituents, jetHFCandidate.globalIndex(), static_cast<int>(JetConstituentStatus::candidate), candMass);
+      }
+      nSub = jetsubstructureutilities::getNSubjettiness(jet, particles, particles, candidates, 2, fastjet::contrib::CA_Axes(), true, zCut, beta);
+      jetReclustering<true, false>(jet, jetSplittingsMCPTable);
+      jetPairing<true, false>(jet, particles, candidates, ParticlesPerMcCollision, jetPairsMCPTable);
+      jetSubstructureSimple(jet, particles, candidates);
+      jetSubstructureMCPTable(energyMotherVec, ptLeadingVec, ptSubLeadingVec, thetaVec, nSub[0], nSub[1], nSub[2], pairJetPtVec, pairJetEnergyVec, pairJetThetaVec, pairJetPerpCone1PtVec, pairJetPerpCone1EnergyVec, pairJetPerpCone1ThetaVec, pairPerpCone1PerpCone1PtVec, pairPerpCone1PerpCone1EnergyVec, pairPerpCone1PerpCone1ThetaVec, pairPerpCone1PerpCone2PtVec, pairPerpCone1PerpCone2EnergyVec, pairPerpCone1PerpCone2ThetaVec, angularity, leadingConstituentPt, perpConeRho);
     }
-    nSub = jetsubstructureutilities::getNSubjettiness(jet, particles, particles, candidates, 2, fastjet::contrib::CA_Axes(), true, zCut, beta);
-    jetReclustering<true, false>(jet, jetSplittingsMCPTable);
-    jetPairing<true, false>(jet, particles, candidates, ParticlesPerMcCollision, jetPairsMCPTable);
-    jetSubstructureSimple(jet, particles, candidates);
-    jetSubstructureMCPTable(energyMotherVec, ptLeadingVec, ptSubLeadingVec, thetaVec, nSub[0], nSub[1], nSub[2], pairJetPtVec, pairJetEnergyVec, pairJetThetaVec, pairJetPerpCone1PtVec, pairJetPerpCone1EnergyVec, pairJetPerpCone1ThetaVec, pairPerpCone1PerpCone1PtVec, pairPerpCone1PerpCone1EnergyVec, pairPerpCone1PerpCone1ThetaVec, pairPerpCone1PerpCone2PtVec, pairPerpCone1PerpCone2EnergyVec, pairPerpCone1PerpCone2ThetaVec, angularity, leadingConstituentPt, perpConeRho);
   }
   PROCESS_SWITCH(JetSubstructureHFTask, processChargedJetsMCP, "HF jet substructure on MC particle level", false);
 };
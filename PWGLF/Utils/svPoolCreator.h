@@ -12,6 +12,7 @@
 #ifndef PWGLF_UTILS_SVPOOLCREATOR_H_
 #define PWGLF_UTILS_SVPOOLCREATOR_H_
 
+#include <algorithm>
 #include <array>
 #include <unordered_map>
 #include <vector>
@@ -30,6 +31,7 @@ using std::array;
 using CollBracket = o2::math_utils::Bracket<int>;
 
 constexpr uint64_t bOffsetMax = 241; // track compatibility can never go beyond 6 mus (ITS)
+constexpr uint64_t BcInvalid = -1;
 
 struct TrackCand {
   int Idxtr;
@@ -65,6 +67,9 @@ class svPoolCreator
     tmap.clear();
     svCandPool.clear();
     bc2Coll.clear();
+    collBCs.clear();
+    ambiTrackBC.clear();
+    ambiTrackBCFilled = false;
   }
 
   void setTimeMargin(float timeMargin) { timeMarginNS = timeMargin; }
@@ -73,43 +78,61 @@ class svPoolCreator
   o2::vertexing::DCAFitterN<2>* getFitter() { return &fitter; }
   std::array<std::vector<TrackCand>, 4> getTrackCandPool() { return trackCandPool; }
 
+  /// Builds the BC-sorted collision index and caches the global BC of each collision, once per DataFrame
   template <typename C, typename BC>
   void fillBC2Coll(const C& collisions, BC const&)
   {
+    collBCs.assign(collisions.size(), BcInvalid);
     for (unsigned i = 0; i < collisions.size(); i++) {
       auto collision = collisions.rawIteratorAt(i);
       if (!collision.has_bc()) {
         continue;
       }
-      bc2Coll[collision.template bc_as<BC>().globalBC()] = i;
+      collBCs[i] = collision.template bc_as<BC>().globalBC();
+      bc2Coll.emplace_back(collBCs[i], i);
     }
+    // sorted by BC; for several collisions in the same BC only the last one is kept, as the window search starts from it
+    std::stable_sort(bc2Coll.begin(), bc2Coll.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    auto last = std::unique(bc2Coll.rbegin(), bc2Coll.rend(), [](const auto& a, const auto& b) { return a.first == b.first; });
+    bc2Coll.erase(bc2Coll.begin(), last.base());
+  }
+
+  /// Builds the map from the ambiguous tracks to the first BC of their compatible range, once per DataFrame
+  template <typename BC>
+  void fillAmbiTrackBC(o2::aod::AmbiguousTracks const& ambiTracks, BC const&)
+  {
+    ambiTrackBC.clear();
+    ambiTrackBC.reserve(ambiTracks.size());
+    for (const auto& ambTrack : ambiTracks) {
+      uint64_t globalBC = BcInvalid;
+      if (ambTrack.has_bc() && ambTrack.bc_as<BC>().size() != 0) {
+        globalBC = ambTrack.bc_as<BC>().begin().globalBC();
+      }
+      ambiTrackBC.try_emplace(ambTrack.trackId(), globalBC); // the first entry of a track is used
+    }
+    ambiTrackBCFilled = true;
   }
 
   template <typename T, typename C, typename BC>
-  void appendTrackCand(const T& trackCand, const C& collisions, int pdgHypo, o2::aod::AmbiguousTracks const& ambiTracks, BC const&)
+  void appendTrackCand(const T& trackCand, const C& collisions, int pdgHypo, o2::aod::AmbiguousTracks const& ambiTracks, BC const& bcs)
   {
     if (pdgHypo != track0Pdg && pdgHypo != track1Pdg) {
       LOG(debug) << "Wrong pdg hypothesis";
       return;
     }
     bool isDau0 = pdgHypo == track0Pdg;
-    constexpr uint64_t BcInvalid = -1;
     uint64_t globalBC = BcInvalid;
     if (trackCand.has_collision()) {
       if (trackCand.template collision_as<C>().has_bc()) {
         globalBC = trackCand.template collision_as<C>().template bc_as<BC>().globalBC();
       }
     } else if (!skipAmbiTracks) {
-      for (const auto& ambTrack : ambiTracks) {
-        if (ambTrack.trackId() != trackCand.globalIndex()) {
-          continue;
-        }
-        if (!ambTrack.has_bc() || ambTrack.bc_as<BC>().size() == 0) {
-          globalBC = BcInvalid;
-          break;
-        }
-        globalBC = ambTrack.bc_as<BC>().begin().globalBC();
-        break;
+      if (!ambiTrackBCFilled) {
+        fillAmbiTrackBC(ambiTracks, bcs);
+      }
+      const auto ambiBC = ambiTrackBC.find(trackCand.globalIndex());
+      if (ambiBC != ambiTrackBC.end()) {
+        globalBC = ambiBC->second;
       }
     } else {
       globalBC = BcInvalid;
@@ -119,26 +142,21 @@ class svPoolCreator
       return;
     }
 
+    // first collision with a BC in [globalBC - bOffsetMax, globalBC + bOffsetMax)
     uint64_t firstBC = globalBC < bOffsetMax ? 0 : globalBC - bOffsetMax;
     uint64_t lastBC = globalBC + bOffsetMax;
-    int firstCollIdx = -1;
-    while (firstBC < lastBC) {
-      if (bc2Coll.find(firstBC) != bc2Coll.end()) {
-        firstCollIdx = bc2Coll[firstBC];
-        break;
-      }
-      firstBC++;
-    }
-    if (firstCollIdx == -1) {
+    const auto firstColl = std::lower_bound(bc2Coll.begin(), bc2Coll.end(), firstBC, [](const auto& entry, uint64_t bc) { return entry.first < bc; });
+    if (firstColl == bc2Coll.end() || firstColl->first >= lastBC) {
       return;
     }
+    int firstCollIdx = firstColl->second;
 
     // now loop over all the collisions to make the pool
     for (int i = firstCollIdx; i < collisions.size(); i++) {
       const auto& collision = collisions.rawIteratorAt(i);
       float collTime = collision.collisionTime();
       float collTimeRes2 = collision.collisionTimeRes() * collision.collisionTimeRes();
-      uint64_t collBC = collision.template bc_as<BC>().globalBC();
+      uint64_t collBC = collBCs[i];
       int collIdx = collision.globalIndex();
       int64_t bcOffset = globalBC - static_cast<int64_t>(collBC);
       if (static_cast<uint64_t>(std::abs(bcOffset)) > bOffsetMax) {
@@ -265,7 +283,10 @@ class svPoolCreator
   float timeMarginNS = 600.;
   bool skipAmbiTracks = false;
   std::unordered_map<int, std::pair<int, int>> tmap;
-  std::unordered_map<uint64_t, int> bc2Coll;
+  std::vector<std::pair<uint64_t, int>> bc2Coll; // (global BC, collision index) sorted by BC, one collision per BC
+  std::vector<uint64_t> collBCs;                 // global BC of each collision, BcInvalid if none
+  std::unordered_map<int, uint64_t> ambiTrackBC; // first compatible BC of each ambiguous track, BcInvalid if none
+  bool ambiTrackBCFilled = false;
 
   std::array<std::vector<TrackCand>, 4> trackCandPool; // Sorting: dau0 pos, dau0 neg, dau1 pos, dau1 neg
   std::vector<SVCand> svCandPool;                      // index of the two tracks in the track table
@@ -24,6 +24,7 @@
 #include "DataFormatsFT0/Digit.h"
 #include "DataFormatsFIT/Triggers.h"
 #include "CommonConstants/LHCConstants.h"
+#include "Common/Core/BcTimeline.h"
 #include "Common/DataModel/EventSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/DataModel/PIDResponse.h"
@@ -203,6 +204,31 @@ T compatibleBCs(uint64_t const& meanBC, int const& deltaBC, T const& bcs)
   return compatibleBCs(bcIter, meanBC, deltaBC, bcs);
 }
 
+// In this variant of compatibleBCs the slice is found with binary searches in a BcTimeline
+// whose Any slot was filled with the same BCs table (BcTimeline::addBCs(bcs)). The timeline is
+// built once per DataFrame and replaces the BC by BC walk of the variants above.
+template <typename T>
+T compatibleBCs(uint64_t const& meanBC, int const& deltaBC, T const& bcs, BcTimeline const& timeline)
+{
+  // range of BCs to consider
+  uint64_t minBC = static_cast<uint64_t>(deltaBC) < meanBC ? meanBC - static_cast<uint64_t>(deltaBC) : 0;
+  uint64_t maxBC = meanBC + static_cast<uint64_t>(deltaBC);
+
+  auto [first, last] = timeline.window(BcTimeline::Any, minBC, maxBC);
+  if (first >= last) {
+    LOGF(debug, "<compatibleBCs> No BCs in [%d, %d]", minBC, maxBC);
+    return T{{bcs.asArrowTable()->Slice(0, 0)}, static_cast<uint64_t>(0)};
+  }
+  int64_t minBCId = timeline.index(BcTimeline::Any, first);
+  int64_t maxBCId = timeline.index(BcTimeline::Any, last - 1);
+
+  // create bc slice
+  T bcslice{{bcs.asArrowTable()->Slice(minBCId, maxBCId - minBCId + 1)}, static_cast<uint64_t>(minBCId)};
+  bcs.copyIndexBindings(bcslice);
+  LOGF(debug, "  size of slice %d", bcslice.size());
+  return bcslice;
+}
+
 // -----------------------------------------------------------------------------
 // Same as above but for collisions with MC information
 template <typename F, typename T>
@@ -258,6 +258,9 @@ struct DGBCCandProducer {
   // DG selector
   DGSelector dgSelector;
 
+  // global BCs of the DataFrame, for the search of compatible BCs
+  BcTimeline bcTimeline;
+
   HistogramRegistry registry{
     "registry",
     {}};
@@ -538,6 +541,9 @@ struct DGBCCandProducer {
     if (bcs.size() <= 0) {
       return;
     }
+    bcTimeline.clear();
+    bcTimeline.addBCs(bcs);
+    bcTimeline.build();
 
     // run over all BC in bcs and tibcs
     // int64_t lastCollision = 0;
@@ -603,7 +609,7 @@ struct DGBCCandProducer {
           // lastCollision = col.globalIndex();
 
           ntr1 = col.numContrib();
-          auto bcRange = udhelpers::compatibleBCs(bc, bcnum, diffCuts.minNBCs(), bcs);
+          auto bcRange = udhelpers::compatibleBCs(bcnum, diffCuts.minNBCs(), bcs, bcTimeline);
           auto colTracks = tracks.sliceByCached(aod::track::collisionId, col.globalIndex(), cache);
           auto colFwdTracks = fwdtracks.sliceByCached(aod::fwdtrack::collisionId, col.globalIndex(), cache);
           isDG1 = dgSelector.IsSelected(diffCuts, col, bcRange, colTracks, colFwdTracks);
@@ -641,7 +647,7 @@ struct DGBCCandProducer {
         if (tibc.bcnum() == bcnum) {
           SETBIT(bcFlag, 4);
 
-          auto bcRange = udhelpers::compatibleBCs(bc, bcnum, diffCuts.minNBCs(), bcs);
+          auto bcRange = udhelpers::compatibleBCs(bcnum, diffCuts.minNBCs(), bcs, bcTimeline);
           auto tracksArray = tibc.track_as<TCs>();
           ntr2 = tracksArray.size();
 
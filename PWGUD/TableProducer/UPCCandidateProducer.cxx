@@ -23,6 +23,7 @@
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Common/CCDB/EventSelectionParams.h"
+#include "Common/Core/BcTimeline.h"
 #include "Common/DataModel/EventSelection.h"
 #include "CommonConstants/LHCConstants.h"
 #include "DataFormatsFIT/Triggers.h"
@@ -40,6 +41,16 @@ struct UpcCandProducer {
   std::map<int32_t, int32_t> fNewPartIDs;
   uint64_t fMaxBC{0}; // max BC for ITS-TPC search
 
+  // global BCs with FIT/ZDC signals of the current DataFrame
+  BcTimeline fBcTimeline;
+  enum BcSlots : int { kBcTOR = BcTimeline::NPredefinedSlots, // FT0 with A and C times in +-2 ns
+                       kBcTSC,                                // TVX & (TSC | TCE)
+                       kBcTVX,                                // FT0 vertex trigger
+                       kBcFT0,                                // FT0 signal
+                       kBcFV0,                                // FV0 signal
+                       kBcFDD,                                // FDD signal
+                       kBcZDC };                              // ZDC signal
+
   Produces<o2::aod::UDMcCollisions> udMCCollisions;
   Produces<o2::aod::UDMcParticles> udMCParticles;
 
@@ -234,19 +245,6 @@ struct UpcCandProducer {
     return true;
   }
 
-  auto findClosestBC(uint64_t globalBC, std::map<uint64_t, int32_t>& bcs)
-  {
-    auto it = bcs.lower_bound(globalBC);
-    auto bc1 = it->first;
-    if (it != bcs.begin())
-      --it;
-    auto bc2 = it->first;
-    auto dbc1 = bc1 >= globalBC ? bc1 - globalBC : globalBC - bc1;
-    auto dbc2 = bc2 >= globalBC ? bc2 - globalBC : globalBC - bc2;
-    auto bc = (dbc1 <= dbc2) ? bc1 : bc2;
-    return bc;
-  }
-
   auto findClosestTrackBCiter(uint64_t globalBC, std::vector<BCTracksPair>& bcs)
   {
     auto it = std::lower_bound(bcs.begin(), bcs.end(), globalBC,
@@ -266,12 +264,10 @@ struct UpcCandProducer {
 
   auto findClosestTrackBCiterNotEq(uint64_t globalBC, std::vector<BCTracksPair>& bcs)
   {
-    auto it = std::find_if(
-      bcs.begin(),
-      bcs.end(),
-      [globalBC](const auto& v) {
-        return v.first > globalBC;
-      });
+    auto it = std::upper_bound(bcs.begin(), bcs.end(), globalBC,
+                               [](uint64_t bc, const BCTracksPair& p) {
+                                 return bc < p.first;
+                               });
     auto bc1 = it->first;
     auto it1 = it;
     if (it != bcs.begin())
@@ -814,16 +810,14 @@ struct UpcCandProducer {
     std::sort(bcsMatchedTrIdsITSTPC.begin(), bcsMatchedTrIdsITSTPC.end(),
               [](const auto& left, const auto& right) { return left.first < right.first; });
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithTOR{};
-    std::map<uint64_t, int32_t> mapGlobalBcWithTVX{};
-    std::map<uint64_t, int32_t> mapGlobalBcWithTSC{};
+    fBcTimeline.clear();
     for (const auto& ft0 : ft0s) {
       uint64_t globalBC = ft0.bc_as<TBCs>().globalBC();
       int32_t globalIndex = ft0.globalIndex();
       if (!(std::abs(ft0.timeA()) > 2.f && std::abs(ft0.timeC()) > 2.f))
-        mapGlobalBcWithTOR[globalBC] = globalIndex;
+        fBcTimeline.add(kBcTOR, globalBC, globalIndex);
       if (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitVertex)) { // TVX
-        mapGlobalBcWithTVX[globalBC] = globalIndex;
+        fBcTimeline.add(kBcTVX, globalBC, globalIndex);
       }
       if (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitCen)) { // TVX & TCE
         histRegistry.get<TH1>(HIST("hCountersTrg"))->Fill("TCE", 1);
@@ -831,19 +825,17 @@ struct UpcCandProducer {
       if (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitVertex) &&
           (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitCen) ||
            TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitSCen))) { // TVX & (TSC | TCE)
-        mapGlobalBcWithTSC[globalBC] = globalIndex;
+        fBcTimeline.add(kBcTSC, globalBC, globalIndex);
       }
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithV0A{};
     for (const auto& fv0a : fv0as) {
       if (std::abs(fv0a.time()) > 15.f)
         continue;
       uint64_t globalBC = fv0a.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithV0A[globalBC] = fv0a.globalIndex();
+      fBcTimeline.add(kBcFV0, globalBC, fv0a.globalIndex());
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithZdc{};
     for (const auto& zdc : zdcs) {
       if (std::abs(zdc.timeZNA()) > 2.f && std::abs(zdc.timeZNC()) > 2.f)
         continue;
@@ -852,14 +844,15 @@ struct UpcCandProducer {
       if (!(std::abs(zdc.timeZNC()) > 2.f))
         histRegistry.get<TH1>(HIST("hCountersTrg"))->Fill("ZNC", 1);
       auto globalBC = zdc.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithZdc[globalBC] = zdc.globalIndex();
+      fBcTimeline.add(kBcZDC, globalBC, zdc.globalIndex());
     }
 
-    auto nTORs = mapGlobalBcWithTOR.size();
-    auto nTSCs = mapGlobalBcWithTSC.size();
-    auto nTVXs = mapGlobalBcWithTVX.size();
-    auto nFV0As = mapGlobalBcWithV0A.size();
-    auto nZdcs = mapGlobalBcWithZdc.size();
+    fBcTimeline.build();
+    auto nTORs = fBcTimeline.size(kBcTOR);
+    auto nTSCs = fBcTimeline.size(kBcTSC);
+    auto nTVXs = fBcTimeline.size(kBcTVX);
+    auto nFV0As = fBcTimeline.size(kBcFV0);
+    auto nZdcs = fBcTimeline.size(kBcZDC);
     auto nBcsWithITSTPC = bcsMatchedTrIdsITSTPC.size();
 
     // todo: calculate position of UD collision?
@@ -883,11 +876,12 @@ struct UpcCandProducer {
       fitInfo.distClosestBcTVX = 999;
       fitInfo.distClosestBcV0A = 999;
       if (nTORs > 0) {
-        uint64_t closestBcTOR = findClosestBC(globalBC, mapGlobalBcWithTOR);
+        auto closestPosTOR = fBcTimeline.findClosest(kBcTOR, globalBC);
+        uint64_t closestBcTOR = fBcTimeline.globalBC(kBcTOR, closestPosTOR);
         fitInfo.distClosestBcTOR = globalBC - static_cast<int64_t>(closestBcTOR);
         if (std::abs(fitInfo.distClosestBcTOR) <= fFilterFT0)
           return false;
-        auto ft0Id = mapGlobalBcWithTOR.at(closestBcTOR);
+        auto ft0Id = fBcTimeline.index(kBcTOR, closestPosTOR);
         auto ft0 = ft0s.iteratorAt(ft0Id);
         fitInfo.timeFT0A = ft0.timeA();
         fitInfo.timeFT0C = ft0.timeC();
@@ -899,23 +893,26 @@ struct UpcCandProducer {
           fitInfo.ampFT0C += amp;
       }
       if (nTSCs > 0) {
-        uint64_t closestBcTSC = findClosestBC(globalBC, mapGlobalBcWithTSC);
+        auto closestPosTSC = fBcTimeline.findClosest(kBcTSC, globalBC);
+        uint64_t closestBcTSC = fBcTimeline.globalBC(kBcTSC, closestPosTSC);
         fitInfo.distClosestBcTSC = globalBC - static_cast<int64_t>(closestBcTSC);
         if (std::abs(fitInfo.distClosestBcTSC) <= fFilterTSC)
           return false;
       }
       if (nTVXs > 0) {
-        uint64_t closestBcTVX = findClosestBC(globalBC, mapGlobalBcWithTVX);
+        auto closestPosTVX = fBcTimeline.findClosest(kBcTVX, globalBC);
+        uint64_t closestBcTVX = fBcTimeline.globalBC(kBcTVX, closestPosTVX);
         fitInfo.distClosestBcTVX = globalBC - static_cast<int64_t>(closestBcTVX);
         if (std::abs(fitInfo.distClosestBcTVX) <= fFilterTVX)
           return false;
       }
       if (nFV0As > 0) {
-        uint64_t closestBcV0A = findClosestBC(globalBC, mapGlobalBcWithV0A);
+        auto closestPosV0A = fBcTimeline.findClosest(kBcFV0, globalBC);
+        uint64_t closestBcV0A = fBcTimeline.globalBC(kBcFV0, closestPosV0A);
         fitInfo.distClosestBcV0A = globalBC - static_cast<int64_t>(closestBcV0A);
         if (std::abs(fitInfo.distClosestBcV0A) <= fFilterFV0)
           return false;
-        auto fv0aId = mapGlobalBcWithV0A.at(closestBcV0A);
+        auto fv0aId = fBcTimeline.index(kBcFV0, closestPosV0A);
         auto fv0a = fv0as.iteratorAt(fv0aId);
         fitInfo.timeFV0A = fv0a.time();
         const auto& v0Amps = fv0a.amplitude();
@@ -954,9 +951,9 @@ struct UpcCandProducer {
       if (!updateFitInfo(globalBC, fitInfo))
         continue;
       if (nZdcs > 0) {
-        auto itZDC = mapGlobalBcWithZdc.find(globalBC);
-        if (itZDC != mapGlobalBcWithZdc.end()) {
-          const auto& zdc = zdcs.iteratorAt(itZDC->second);
+        auto posZDC = fBcTimeline.find(kBcZDC, globalBC);
+        if (posZDC != BcTimeline::NotFound) {
+          const auto& zdc = zdcs.iteratorAt(fBcTimeline.index(kBcZDC, posZDC));
           float timeZNA = zdc.timeZNA();
           float timeZNC = zdc.timeZNC();
           float eComZNA = zdc.energyCommonZNA();
@@ -1023,9 +1020,9 @@ struct UpcCandProducer {
       if (!updateFitInfo(globalBC, fitInfo))
         continue;
       if (nZdcs > 0) {
-        auto itZDC = mapGlobalBcWithZdc.find(globalBC);
-        if (itZDC != mapGlobalBcWithZdc.end()) {
-          const auto& zdc = zdcs.iteratorAt(itZDC->second);
+        auto posZDC = fBcTimeline.find(kBcZDC, globalBC);
+        if (posZDC != BcTimeline::NotFound) {
+          const auto& zdc = zdcs.iteratorAt(fBcTimeline.index(kBcZDC, posZDC));
           float timeZNA = zdc.timeZNA();
           float timeZNC = zdc.timeZNC();
           float eComZNA = zdc.energyCommonZNA();
@@ -1251,17 +1248,17 @@ struct UpcCandProducer {
 
   template <typename T>
   void fillAmplitudes(const T& t,
-                      const std::map<uint64_t, int32_t>& mapBCs,
+                      int slot,
                       std::vector<float>& amps,
                       std::vector<int8_t>& relBCs,
                       uint64_t gbc)
   {
     auto s = gbc - fBCWindowFITAmps;
     auto e = gbc + (fBCWindowFITAmps - 1);
-    auto it = mapBCs.lower_bound(s);
-    while (it->first <= e && it != mapBCs.end()) {
-      int i = it->first - s;
-      auto id = it->second;
+    auto [first, last] = fBcTimeline.window(slot, s, e);
+    for (auto pos = first; pos < last; ++pos) {
+      int i = fBcTimeline.globalBC(slot, pos) - s;
+      auto id = fBcTimeline.index(slot, pos);
       const auto& row = t.iteratorAt(id);
       float totalAmp = 0.f;
       if constexpr (std::is_same_v<T, o2::aod::FT0s>) {
@@ -1276,7 +1273,6 @@ struct UpcCandProducer {
         amps.push_back(totalAmp);
         relBCs.push_back(gbc - (i + s));
       }
-      ++it;
     }
   }
 
@@ -1316,7 +1312,7 @@ struct UpcCandProducer {
     std::sort(bcsMatchedTrIdsMCH.begin(), bcsMatchedTrIdsMCH.end(),
               [](const auto& left, const auto& right) { return left.first < right.first; });
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithT0A{};
+    fBcTimeline.clear();
     for (const auto& ft0 : ft0s) {
       if (!TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitVertex))
         continue;
@@ -1326,20 +1322,18 @@ struct UpcCandProducer {
       if (std::abs(ft0.timeA()) > 2.f)
         continue;
       uint64_t globalBC = ft0.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithT0A[globalBC] = ft0.globalIndex();
+      fBcTimeline.add(kBcFT0, globalBC, ft0.globalIndex());
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithV0A{};
     for (const auto& fv0a : fv0as) {
       if (!TESTBIT(fv0a.triggerMask(), o2::fit::Triggers::bitA))
         continue;
       if (std::abs(fv0a.time()) > 15.f)
         continue;
       uint64_t globalBC = fv0a.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithV0A[globalBC] = fv0a.globalIndex();
+      fBcTimeline.add(kBcFV0, globalBC, fv0a.globalIndex());
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithZdc{};
     for (const auto& zdc : zdcs) {
       if (std::abs(zdc.timeZNA()) > 2.f && std::abs(zdc.timeZNC()) > 2.f)
         continue;
@@ -1348,10 +1342,9 @@ struct UpcCandProducer {
       if (!(std::abs(zdc.timeZNC()) > 2.f))
         histRegistry.get<TH1>(HIST("hCountersTrg"))->Fill("ZNC", 1);
       auto globalBC = zdc.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithZdc[globalBC] = zdc.globalIndex();
+      fBcTimeline.add(kBcZDC, globalBC, zdc.globalIndex());
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithFDD{};
     uint8_t twoLayersA = 0;
     uint8_t twoLayersC = 0;
     for (const auto& fdd : fdds) {
@@ -1366,14 +1359,15 @@ struct UpcCandProducer {
       if ((twoLayersA == 0) && (twoLayersC == 0))
         continue;
       uint64_t globalBC = fdd.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithFDD[globalBC] = fdd.globalIndex();
+      fBcTimeline.add(kBcFDD, globalBC, fdd.globalIndex());
     }
 
-    auto nFT0s = mapGlobalBcWithT0A.size();
-    auto nFV0As = mapGlobalBcWithV0A.size();
-    auto nZdcs = mapGlobalBcWithZdc.size();
+    fBcTimeline.build();
+    auto nFT0s = fBcTimeline.size(kBcFT0);
+    auto nFV0As = fBcTimeline.size(kBcFV0);
+    auto nZdcs = fBcTimeline.size(kBcZDC);
     auto nBcsWithMCH = bcsMatchedTrIdsMCH.size();
-    auto nFDDs = mapGlobalBcWithFDD.size();
+    auto nFDDs = fBcTimeline.size(kBcFDD);
 
     // todo: calculate position of UD collision?
     float dummyX = 0.;
@@ -1425,12 +1419,13 @@ struct UpcCandProducer {
       uint8_t chFT0A = 0;
       uint8_t chFT0C = 0;
       if (nFT0s > 0) {
-        uint64_t closestBcT0A = findClosestBC(globalBC, mapGlobalBcWithT0A);
+        auto closestPosT0A = fBcTimeline.findClosest(kBcFT0, globalBC);
+        uint64_t closestBcT0A = fBcTimeline.globalBC(kBcFT0, closestPosT0A);
         int64_t distClosestBcT0A = globalBC - static_cast<int64_t>(closestBcT0A);
         if (std::abs(distClosestBcT0A) <= fFilterFT0)
           continue;
         fitInfo.distClosestBcT0A = distClosestBcT0A;
-        auto ft0Id = mapGlobalBcWithT0A.at(closestBcT0A);
+        auto ft0Id = fBcTimeline.index(kBcFT0, closestPosT0A);
         auto ft0 = ft0s.iteratorAt(ft0Id);
         fitInfo.timeFT0A = ft0.timeA();
         fitInfo.timeFT0C = ft0.timeC();
@@ -1440,28 +1435,29 @@ struct UpcCandProducer {
         fitInfo.ampFT0C = std::accumulate(t0AmpsC.begin(), t0AmpsC.end(), 0.f);
         chFT0A = ft0.amplitudeA().size();
         chFT0C = ft0.amplitudeC().size();
-        fillAmplitudes(ft0s, mapGlobalBcWithT0A, amplitudesT0A, relBCsT0A, globalBC);
+        fillAmplitudes(ft0s, kBcFT0, amplitudesT0A, relBCsT0A, globalBC);
       }
       uint8_t chFV0A = 0;
       if (nFV0As > 0) {
-        uint64_t closestBcV0A = findClosestBC(globalBC, mapGlobalBcWithV0A);
+        auto closestPosV0A = fBcTimeline.findClosest(kBcFV0, globalBC);
+        uint64_t closestBcV0A = fBcTimeline.globalBC(kBcFV0, closestPosV0A);
         int64_t distClosestBcV0A = globalBC - static_cast<int64_t>(closestBcV0A);
         if (std::abs(distClosestBcV0A) <= fFilterFV0)
           continue;
         fitInfo.distClosestBcV0A = distClosestBcV0A;
-        auto fv0aId = mapGlobalBcWithV0A.at(closestBcV0A);
+        auto fv0aId = fBcTimeline.index(kBcFV0, closestPosV0A);
         auto fv0a = fv0as.iteratorAt(fv0aId);
         fitInfo.timeFV0A = fv0a.time();
         const auto& v0Amps = fv0a.amplitude();
         fitInfo.ampFV0A = std::accumulate(v0Amps.begin(), v0Amps.end(), 0.f);
         chFV0A = fv0a.amplitude().size();
-        fillAmplitudes(fv0as, mapGlobalBcWithV0A, amplitudesV0A, relBCsV0A, globalBC);
+        fillAmplitudes(fv0as, kBcFV0, amplitudesV0A, relBCsV0A, globalBC);
       }
       uint8_t chFDDA = 0;
       uint8_t chFDDC = 0;
       if (nFDDs > 0) {
-        uint64_t closestBcFDD = findClosestBC(globalBC, mapGlobalBcWithFDD);
-        auto fddId = mapGlobalBcWithFDD.at(closestBcFDD);
+        auto closestPosFDD = fBcTimeline.findClosest(kBcFDD, globalBC);
+        auto fddId = fBcTimeline.index(kBcFDD, closestPosFDD);
         auto fdd = fdds.iteratorAt(fddId);
         fitInfo.timeFDDA = fdd.timeA();
         fitInfo.timeFDDC = fdd.timeC();
@@ -1481,9 +1477,9 @@ struct UpcCandProducer {
         }
       }
       if (nZdcs > 0) {
-        auto itZDC = mapGlobalBcWithZdc.find(globalBC);
-        if (itZDC != mapGlobalBcWithZdc.end()) {
-          const auto& zdc = zdcs.iteratorAt(itZDC->second);
+        auto posZDC = fBcTimeline.find(kBcZDC, globalBC);
+        if (posZDC != BcTimeline::NotFound) {
+          const auto& zdc = zdcs.iteratorAt(fBcTimeline.index(kBcZDC, posZDC));
           float timeZNA = zdc.timeZNA();
           float timeZNC = zdc.timeZNC();
           float eComZNA = zdc.energyCommonZNA();
@@ -1529,9 +1525,6 @@ struct UpcCandProducer {
     ambFwdTrBCs.clear();
     bcsMatchedTrIdsMID.clear();
     bcsMatchedTrIdsMCH.clear();
-    mapGlobalBcWithT0A.clear();
-    mapGlobalBcWithV0A.clear();
-    mapGlobalBcWithFDD.clear();
   }
 
   template <typename TBCs>
@@ -1579,7 +1572,7 @@ struct UpcCandProducer {
     std::sort(bcsMatchedTrIdsGlobal.begin(), bcsMatchedTrIdsGlobal.end(),
               [](const auto& left, const auto& right) { return left.first < right.first; });
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithT0A{};
+    fBcTimeline.clear();
     for (const auto& ft0 : ft0s) {
       if (!TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitVertex))
         continue;
@@ -1599,20 +1592,18 @@ struct UpcCandProducer {
       if (std::abs(ft0.timeA()) > 2.f)
         continue;
       uint64_t globalBC = ft0.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithT0A[globalBC] = ft0.globalIndex();
+      fBcTimeline.add(kBcFT0, globalBC, ft0.globalIndex());
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithV0A{};
     for (const auto& fv0a : fv0as) {
       if (!TESTBIT(fv0a.triggerMask(), o2::fit::Triggers::bitA))
         continue;
       if (std::abs(fv0a.time()) > 15.f)
         continue;
       uint64_t globalBC = fv0a.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithV0A[globalBC] = fv0a.globalIndex();
+      fBcTimeline.add(kBcFV0, globalBC, fv0a.globalIndex());
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithZdc{};
     for (const auto& zdc : zdcs) {
       if (std::abs(zdc.timeZNA()) > 2.f && std::abs(zdc.timeZNC()) > 2.f)
         continue;
@@ -1621,10 +1612,9 @@ struct UpcCandProducer {
       if (!(std::abs(zdc.timeZNC()) > 2.f))
         histRegistry.get<TH1>(HIST("hCountersTrg"))->Fill("ZNC", 1);
       auto globalBC = zdc.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithZdc[globalBC] = zdc.globalIndex();
+      fBcTimeline.add(kBcZDC, globalBC, zdc.globalIndex());
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithFDD{};
     uint8_t twoLayersA = 0;
     uint8_t twoLayersC = 0;
     for (const auto& fdd : fdds) {
@@ -1639,13 +1629,14 @@ struct UpcCandProducer {
       if ((twoLayersA == 0) && (twoLayersC == 0))
         continue;
       uint64_t globalBC = fdd.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithFDD[globalBC] = fdd.globalIndex();
+      fBcTimeline.add(kBcFDD, globalBC, fdd.globalIndex());
     }
 
-    auto nFT0s = mapGlobalBcWithT0A.size();
-    auto nFV0As = mapGlobalBcWithV0A.size();
-    auto nZdcs = mapGlobalBcWithZdc.size();
-    auto nFDDs = mapGlobalBcWithFDD.size();
+    fBcTimeline.build();
+    auto nFT0s = fBcTimeline.size(kBcFT0);
+    auto nFV0As = fBcTimeline.size(kBcFV0);
+    auto nZdcs = fBcTimeline.size(kBcZDC);
+    auto nFDDs = fBcTimeline.size(kBcFDD);
 
     // todo: calculate position of UD collision?
     float dummyX = 0.;
@@ -1732,12 +1723,13 @@ struct UpcCandProducer {
       int zVtxFT0vPv = 0;
       int vtxITSTPC = 0;
       if (nFT0s > 0) {
-        uint64_t closestBcT0A = findClosestBC(globalBC, mapGlobalBcWithT0A);
+        auto closestPosT0A = fBcTimeline.findClosest(kBcFT0, globalBC);
+        uint64_t closestBcT0A = fBcTimeline.globalBC(kBcFT0, closestPosT0A);
         int64_t distClosestBcT0A = globalBC - static_cast<int64_t>(closestBcT0A);
         if (std::abs(distClosestBcT0A) <= fFilterFT0)
           continue;
         fitInfo.distClosestBcT0A = distClosestBcT0A;
-        auto ft0Id = mapGlobalBcWithT0A.at(closestBcT0A);
+        auto ft0Id = fBcTimeline.index(kBcFT0, closestPosT0A);
         auto ft0 = ft0s.iteratorAt(ft0Id);
         fitInfo.timeFT0A = ft0.timeA();
         fitInfo.timeFT0C = ft0.timeC();
@@ -1756,28 +1748,29 @@ struct UpcCandProducer {
         sbp = ft0.bc_as<TBCs>().selection_bit(o2::aod::evsel::kNoSameBunchPileup) ? 1 : 0;
         zVtxFT0vPv = ft0.bc_as<TBCs>().selection_bit(o2::aod::evsel::kIsGoodZvtxFT0vsPV) ? 1 : 0;
         vtxITSTPC = ft0.bc_as<TBCs>().selection_bit(o2::aod::evsel::kIsVertexITSTPC) ? 1 : 0;
-        fillAmplitudes(ft0s, mapGlobalBcWithT0A, amplitudesT0A, relBCsT0A, globalBC);
+        fillAmplitudes(ft0s, kBcFT0, amplitudesT0A, relBCsT0A, globalBC);
       }
       uint8_t chFV0A = 0;
       if (nFV0As > 0) {
-        uint64_t closestBcV0A = findClosestBC(globalBC, mapGlobalBcWithV0A);
+        auto closestPosV0A = fBcTimeline.findClosest(kBcFV0, globalBC);
+        uint64_t closestBcV0A = fBcTimeline.globalBC(kBcFV0, closestPosV0A);
         int64_t distClosestBcV0A = globalBC - static_cast<int64_t>(closestBcV0A);
         if (std::abs(distClosestBcV0A) <= fFilterFV0)
           continue;
         fitInfo.distClosestBcV0A = distClosestBcV0A;
-        auto fv0aId = mapGlobalBcWithV0A.at(closestBcV0A);
+        auto fv0aId = fBcTimeline.index(kBcFV0, closestPosV0A);
         auto fv0a = fv0as.iteratorAt(fv0aId);
         fitInfo.timeFV0A = fv0a.time();
         const auto& v0Amps = fv0a.amplitude();
         fitInfo.ampFV0A = std::accumulate(v0Amps.begin(), v0Amps.end(), 0.f);
         chFV0A = fv0a.amplitude().size();
-        fillAmplitudes(fv0as, mapGlobalBcWithV0A, amplitudesV0A, relBCsV0A, globalBC);
+        fillAmplitudes(fv0as, kBcFV0, amplitudesV0A, relBCsV0A, globalBC);
       }
       uint8_t chFDDA = 0;
       uint8_t chFDDC = 0;
       if (nFDDs > 0) {
-        uint64_t closestBcFDD = findClosestBC(globalBC, mapGlobalBcWithFDD);
-        auto fddId = mapGlobalBcWithFDD.at(closestBcFDD);
+        auto closestPosFDD = fBcTimeline.findClosest(kBcFDD, globalBC);
+        auto fddId = fBcTimeline.index(kBcFDD, closestPosFDD);
         auto fdd = fdds.iteratorAt(fddId);
         fitInfo.timeFDDA = fdd.timeA();
         fitInfo.timeFDDC = fdd.timeC();
@@ -1797,9 +1790,9 @@ struct UpcCandProducer {
         }
       }
       if (nZdcs > 0) {
-        auto itZDC = mapGlobalBcWithZdc.find(globalBC);
-        if (itZDC != mapGlobalBcWithZdc.end()) {
-          const auto& zdc = zdcs.iteratorAt(itZDC->second);
+        auto posZDC = fBcTimeline.find(kBcZDC, globalBC);
+        if (posZDC != BcTimeline::NotFound) {
+          const auto& zdc = zdcs.iteratorAt(fBcTimeline.index(kBcZDC, posZDC));
           float timeZNA = zdc.timeZNA();
           float timeZNC = zdc.timeZNC();
           float eComZNA = zdc.energyCommonZNA();
@@ -1844,9 +1837,6 @@ struct UpcCandProducer {
     bcsMatchedTrIdsMID.clear();
     bcsMatchedTrIdsMCH.clear();
     bcsMatchedTrIdsGlobal.clear();
-    mapGlobalBcWithT0A.clear();
-    mapGlobalBcWithV0A.clear();
-    mapGlobalBcWithFDD.clear();
   }
 
   // data processors